@@ -1,3 +1,3 @@
-x64\Release\vant vant3-2m.txt 2 0
+x64\Release\vant --batch instancias.lst --results=resultados.csv
 
 pause
\ No newline at end of file
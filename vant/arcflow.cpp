@@ -0,0 +1,311 @@
+#include "arcflow.h"
+#include "modelbuilder.h"
+#include "solver.h"
+#include "heuristics.h"
+#include "portfolio.h"
+#include "runstats.h"
+#include "sysutil.h"
+
+#include <algorithm>
+#include <map>
+#include <math.h>
+#include <stdio.h>
+
+void BuildArcFlowGraph(const std::vector<int>& size,
+	const std::vector<int>& count, int capacity, ArcFlowGraph& graph)
+{
+	int C = capacity;
+	std::vector<char> reach(C + 1, 0);
+	std::vector<int> copies(C + 1);
+
+	graph.capacity = C;
+	graph.arcs.clear();
+	graph.nodes.clear();
+	reach[0] = 1;
+
+	// types in non-increasing size order: arcs of type t only leave loads
+	// reached by larger items or by fewer than count[t] copies of t
+	for (size_t t = 0; t < size.size(); t++)
+	{
+		int w = size[t];
+		for (int e = 0; e <= C; e++)
+		{
+			copies[e] = reach[e] ? 0 : -1;
+			if (e < w)
+				continue;
+			int c = copies[e - w];
+			if (c >= 0 && c < count[t])
+			{
+				ArcFlowGraph::Arc arc;
+				arc.tail = e - w;
+				arc.head = e;
+				arc.type = (int)t;
+				graph.arcs.push_back(arc);
+				if (copies[e] < 0)
+					copies[e] = c + 1;
+			}
+		}
+		for (int e = 0; e <= C; e++)
+			if (copies[e] > 0)
+				reach[e] = 1;
+	}
+	graph.itemArcs = (int)graph.arcs.size();
+
+	reach[C] = 1;
+	for (int e = 0; e <= C; e++)
+		if (reach[e])
+			graph.nodes.push_back(e);
+
+	// loss arcs between consecutive loads
+	for (size_t k = 0; k + 1 < graph.nodes.size(); k++)
+	{
+		ArcFlowGraph::Arc arc;
+		arc.tail = graph.nodes[k];
+		arc.head = graph.nodes[k + 1];
+		arc.type = -1;
+		graph.arcs.push_back(arc);
+	}
+	graph.lossArcs = (int)graph.arcs.size() - graph.itemArcs;
+}
+
+void BuildArcFlowModel(const ArcFlowGraph& graph,
+	const std::vector<int>& count, int m, ModelBuilder& model)
+{
+	int narcs = (int)graph.arcs.size();
+	int nnodes = (int)graph.nodes.size();
+	std::vector<int> nodeIndex(graph.capacity + 1, -1);
+	std::vector<std::vector<int> > in(nnodes), out(nnodes);
+	std::vector<std::vector<int> > ofType(count.size());
+
+	for (int k = 0; k < nnodes; k++)
+		nodeIndex[graph.nodes[k]] = k;
+	for (int a = 0; a < narcs; a++)
+	{
+		const ArcFlowGraph::Arc& arc = graph.arcs[a];
+		out[nodeIndex[arc.tail]].push_back(a);
+		in[nodeIndex[arc.head]].push_back(a);
+		if (arc.type >= 0)
+			ofType[arc.type].push_back(a);
+	}
+
+	model.Reserve(1 + narcs, nnodes + (int)count.size(), (size_t)3 * narcs + 1);
+
+	int z = model.AddVariable("z", 0.0, m, 1.0, UFFLP_Integer);
+	int first = model.AddVariableBlock("f", narcs, 0, 0.0, m, 0.0, UFFLP_Integer);
+	for (int a = 0; a < narcs; a++)
+		if (graph.arcs[a].type >= 0)
+			model.ub[first + a] = std::min(m, count[graph.arcs[a].type]);
+
+	// flow conservation, the sink being implied
+	model.BeginConstraintBlock("flow");
+	for (int k = 0; k + 1 < nnodes; k++)
+	{
+		for (size_t q = 0; q < in[k].size(); q++)
+			model.AddCoefficient(first + in[k][q], 1);
+		for (size_t q = 0; q < out[k].size(); q++)
+			model.AddCoefficient(first + out[k][q], -1);
+		if (k == 0)
+			model.AddCoefficient(z, 1);
+		model.EndRow(0, UFFLP_Equal);
+	}
+
+	model.BeginConstraintBlock("demand");
+	for (size_t t = 0; t < count.size(); t++)
+	{
+		for (size_t q = 0; q < ofType[t].size(); q++)
+			model.AddCoefficient(first + ofType[t][q], 1);
+		model.EndRow(count[t], UFFLP_Greater);
+	}
+}
+
+// Split the integer flow into paths, one per machine, and give each item arc
+// a job of its type.
+static void DecomposeFlow(const ArcFlowGraph& graph, std::vector<int> flow,
+	std::vector<std::vector<int> > jobsOfType, int m,
+	std::vector<int>& machineOf)
+{
+	std::vector<std::vector<int> > out(graph.capacity + 1);
+	for (size_t a = 0; a < graph.arcs.size(); a++)
+		out[graph.arcs[a].tail].push_back((int)a);
+
+	for (int i = 0; i < m; i++)
+	{
+		int node = 0;
+		while (node != graph.capacity)
+		{
+			int next = -1;
+			for (size_t q = 0; q < out[node].size(); q++)
+				if (flow[out[node][q]] > 0)
+				{
+					next = out[node][q];
+					break;
+				}
+			if (next < 0)
+				break;  // fewer than m paths: the machine stays idle
+
+			flow[next]--;
+			int t = graph.arcs[next].type;
+			if (t >= 0 && !jobsOfType[t].empty())
+			{
+				machineOf[jobsOfType[t].back()] = i;
+				jobsOfType[t].pop_back();
+			}
+			node = graph.arcs[next].head;
+		}
+	}
+}
+
+// Probe result: 1 feasible, 0 infeasible, -1 undecided (also when the
+// deadline, in WallClock seconds, passes first)
+static int ProbeCapacity(int C, const std::vector<int>& size,
+	const std::vector<int>& count,
+	const std::vector<std::vector<int> >& jobsOfType, int m,
+	const EngineSettings& settings, double deadline,
+	std::vector<int>& machineOf)
+{
+	PhaseTimer buildTimer(settings.stats, Phase_Build);
+	ArcFlowGraph graph;
+	BuildArcFlowGraph(size, count, C, graph);
+
+	// the same graph without merging sizes or restricting to normal patterns
+	long long rawArcs = C;
+	for (size_t t = 0; t < size.size(); t++)
+		rawArcs += (long long)count[t] * std::max(0, C - size[t] + 1);
+	if (settings.log != NULL)
+		fprintf(settings.log, "Arc-flow graph C=%d: %d nodes, %d item arcs, %d loss arcs"
+			" (uncompressed: %d nodes, %lld arcs)\n", C, (int)graph.nodes.size(),
+			graph.itemArcs, graph.lossArcs, C + 1, rawArcs);
+
+	if (WallClock() >= deadline)
+		return -1;
+
+	ModelBuilder model(UFFLP_Minimize);
+	BuildArcFlowModel(graph, count, m, model);
+
+	SolverBackend* solver = CreateSolver(settings.solver);
+	if (solver == NULL)
+		return -1;
+	solver->LoadModel(model);
+	if (settings.shared != NULL)
+		solver->SetStopFlag(&settings.shared->stop);
+	if (settings.stats != NULL)
+		settings.stats->RecordModel(model);
+	buildTimer.Stop();
+
+	// the solver gets only what the build left of the time limit
+	double remaining = deadline - WallClock();
+	if (remaining <= 0)
+	{
+		delete solver;
+		return -1;
+	}
+	solver->SetParameter(UFFLP_TimeLimit, remaining);
+	// any cover with at most m paths answers the probe
+	solver->SetSolverParameter(SolverParam_RelativeGap, 1.0);
+	solver->SetSolverParameter(SolverParam_Threads, settings.threads);
+
+	int result;
+	PhaseTimer solveTimer(settings.stats, Phase_Solve);
+	UFFLP_StatusType status = solver->Solve();
+	solveTimer.Stop();
+	PhaseTimer extractTimer(settings.stats, Phase_Extract);
+	if (status == UFFLP_Optimal || status == UFFLP_Feasible)
+	{
+		std::vector<double> x(graph.arcs.size());
+		std::vector<int> flow(graph.arcs.size());
+		if (!x.empty())
+			solver->GetSolutions(1, (int)x.size(), &x[0]);
+		for (size_t a = 0; a < flow.size(); a++)
+			flow[a] = (int)floor(x[a] + 0.5);
+		machineOf.assign(machineOf.size(), -1);
+		DecomposeFlow(graph, flow, jobsOfType, m, machineOf);
+		result = 1;
+	}
+	else if (status == UFFLP_Infeasible)
+		result = 0;
+	else
+		result = -1;
+
+	delete solver;
+	return result;
+}
+
+UFFLP_StatusType SolveArcFlow(const std::vector<int>& jobSize, int m,
+	const EngineSettings& settings, long long lowerBound,
+	long long& makespan, std::vector<int>& machineOf)
+{
+	double deadline = WallClock() + settings.timeLimit;
+	int n = (int)jobSize.size();
+
+	// merge identical sizes into item types, largest first
+	std::map<int, std::vector<int>, std::greater<int> > bySize;
+	long long total = 0;
+	for (int j = 0; j < n; j++)
+	{
+		bySize[jobSize[j]].push_back(j);
+		total += jobSize[j];
+	}
+
+	std::vector<int> size, count;
+	std::vector<std::vector<int> > jobsOfType;
+	for (std::map<int, std::vector<int>, std::greater<int> >::iterator it = bySize.begin();
+		it != bySize.end(); ++it)
+	{
+		size.push_back(it->first);
+		count.push_back((int)it->second.size());
+		jobsOfType.push_back(it->second);
+	}
+	if (settings.log != NULL)
+		fprintf(settings.log, "Arc-flow: %d jobs merged into %d item sizes\n",
+			n, (int)size.size());
+
+	long long lo = std::max<long long>(size.empty() ? 0 : size[0], (total + m - 1) / m);
+	lo = std::max(lo, lowerBound);
+	long long hi = makespan;
+
+	std::vector<int> probeSchedule(n);
+	UFFLP_StatusType status = UFFLP_Optimal;
+	while (lo < hi)
+	{
+		if (WallClock() >= deadline)
+		{
+			status = UFFLP_Feasible;
+			break;
+		}
+		if (settings.shared != NULL)
+		{
+			settings.shared->Tighten(lo, makespan, machineOf);
+			hi = std::min(hi, makespan);
+			if (lo >= hi)
+				break;
+		}
+
+		long long C = (lo + hi) / 2;
+		int res = ProbeCapacity((int)C, size, count, jobsOfType, m, settings,
+			deadline, probeSchedule);
+		if (res < 0)
+		{
+			status = UFFLP_Feasible;
+			break;
+		}
+		if (res > 0)
+		{
+			hi = C;
+			machineOf = probeSchedule;
+			if (settings.shared != NULL)
+				settings.shared->Offer(settings.member,
+					ScheduleMakespan(jobSize, m, machineOf), machineOf);
+		}
+		else
+		{
+			lo = C + 1;
+			if (settings.shared != NULL)
+				settings.shared->RaiseBound(settings.member, lo);
+		}
+	}
+
+	// recompute the makespan of the schedule kept, which a feasible probe
+	// may have replaced
+	makespan = ScheduleMakespan(jobSize, m, machineOf);
+	return status;
+}
@@ -0,0 +1,60 @@
+/****************************************************************************
+* Arc-flow formulation of the UAV makespan problem
+*
+* For a capacity C, every machine is a path from 0 to C in a graph whose
+* nodes are machine loads and whose arcs are items (length setup + proctime)
+* or losses. The makespan is found by bisection on C between a lower bound
+* and the makespan of a starting schedule, each probe asking whether m paths
+* cover all jobs.
+* Identical sizes are merged into a single arc type, only normal patterns
+* (loads reachable as sums of sizes) are nodes, and items appear along a
+* path in non-increasing size order.
+*
+*****************************************************************************/
+
+#ifndef __ARC_FLOW_H__
+#define __ARC_FLOW_H__
+
+#include "UFFLP.h"
+#include "solver.h"
+
+#include <vector>
+
+class ModelBuilder;
+
+struct ArcFlowGraph
+{
+	struct Arc
+	{
+		int tail, head;
+		int type;       // item type, or -1 for a loss arc
+	};
+
+	int capacity;
+	std::vector<int> nodes;     // sorted loads, from 0 to capacity
+	std::vector<Arc> arcs;
+	int itemArcs, lossArcs;
+};
+
+// Build the compressed graph for item types of non-increasing sizes.
+void BuildArcFlowGraph(const std::vector<int>& size,
+	const std::vector<int>& count, int capacity, ArcFlowGraph& graph);
+
+// Build the covering model: minimize the number of paths z <= m leaving
+// node 0, with flow conservation and one demand row per item type.
+void BuildArcFlowModel(const ArcFlowGraph& graph,
+	const std::vector<int>& count, int m, ModelBuilder& model);
+
+// Solve the makespan problem by bisection over arc-flow probes.
+// @param jobSize     setup + proctime of every job
+// @param lowerBound  known lower bound on the makespan
+// @param makespan    makespan of the starting schedule; the best one found
+//                    on return
+// @param machineOf   machine of every job in the starting schedule; the best
+//                    schedule found on return
+// @return UFFLP_Optimal if the bisection closed, UFFLP_Feasible otherwise
+UFFLP_StatusType SolveArcFlow(const std::vector<int>& jobSize, int m,
+	const EngineSettings& settings, long long lowerBound,
+	long long& makespan, std::vector<int>& machineOf);
+
+#endif
@@ -0,0 +1,310 @@
+#include "batch.h"
+#include "instance.h"
+#include "options.h"
+#include "portfolio.h"
+#include "report.h"
+#include "solve.h"
+#include "sysutil.h"
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct BatchJob
+{
+	std::string instance;
+	int machines;
+	int ninst;
+	double timeLimit;
+};
+
+// Directory part of a path, including the separator ("" if there is none)
+static std::string DirectoryOf(const std::string& path)
+{
+	size_t sep = path.find_last_of("/\\");
+	return sep == std::string::npos ? std::string() : path.substr(0, sep + 1);
+}
+
+static bool IsAbsolute(const std::string& path)
+{
+	return (!path.empty() && (path[0] == '/' || path[0] == '\\')) ||
+		(path.size() > 1 && path[1] == ':');
+}
+
+// Read "<instance> <#machines> [#instance] [time limit]" lines. Instance
+// paths are relative to the manifest.
+static bool ReadManifest(const char* fname, double timeLimit,
+	std::vector<BatchJob>& jobs)
+{
+	FILE* fin = fopen(fname, "r");
+	char line[1024], path[1024];
+	int lineNo = 0;
+
+	if (fin == NULL)
+	{
+		printf("Unable to open the manifest %s\n", fname);
+		return false;
+	}
+
+	std::string base = DirectoryOf(fname);
+	while (fgets(line, sizeof(line), fin) != NULL)
+	{
+		BatchJob job;
+		lineNo++;
+
+		char* hash = strchr(line, '#');
+		if (hash != NULL)
+			*hash = '\0';
+
+		job.ninst = (int)jobs.size();
+		job.timeLimit = timeLimit;
+		int fields = sscanf(line, "%1023s %d %d %lf", path, &job.machines,
+			&job.ninst, &job.timeLimit);
+		if (fields <= 0)
+			continue;
+		if (fields < 2 || job.machines <= 0 || job.timeLimit <= 0)
+		{
+			printf("%s:%d: expected <instance> <#machines> [#instance] [time limit]\n",
+				fname, lineNo);
+			fclose(fin);
+			return false;
+		}
+		job.instance = IsAbsolute(path) ? path : base + path;
+		jobs.push_back(job);
+	}
+	fclose(fin);
+	return true;
+}
+
+// Parse the numbers of "name-<#machines>m[-<#instance>]" in a file name.
+// @return false if the name does not follow the pattern
+static bool ParseInstanceName(const std::string& name, int& machines,
+	int& ninst)
+{
+	for (size_t k = 0; k < name.size(); k++)
+	{
+		if (name[k] != '-' || k + 1 >= name.size() || !isdigit((unsigned char)name[k + 1]))
+			continue;
+		char* end;
+		long value = strtol(name.c_str() + k + 1, &end, 10);
+		if (*end != 'm')
+			continue;
+		machines = (int)value;
+		if (end[1] == '-' && isdigit((unsigned char)end[2]))
+			ninst = atoi(end + 2);
+		return true;
+	}
+	return false;
+}
+
+// Every *.txt file of a directory. The number of machines comes from
+// --machines or else from the file name.
+static bool ScanDirectory(const BatchOptions& opts, std::vector<BatchJob>& jobs)
+{
+	std::vector<std::string> names;
+
+	if (!ListFiles(opts.input, names))
+	{
+		printf("Unable to read the directory %s\n", opts.input);
+		return false;
+	}
+
+	std::string base = std::string(opts.input) + "/";
+	for (size_t k = 0; k < names.size(); k++)
+	{
+		const std::string& name = names[k];
+		if (name.size() < 4 || name.compare(name.size() - 4, 4, ".txt") != 0)
+			continue;
+
+		BatchJob job;
+		job.instance = base + name;
+		job.machines = 0;
+		job.ninst = (int)jobs.size();
+		job.timeLimit = opts.solve.timeLimit;
+		ParseInstanceName(name, job.machines, job.ninst);
+		if (opts.machines > 0)
+			job.machines = opts.machines;
+		if (job.machines <= 0)
+		{
+			printf("Skipping %s: unknown number of machines, use --machines\n",
+				name.c_str());
+			continue;
+		}
+		jobs.push_back(job);
+	}
+	return true;
+}
+
+// Threads of one solve: users run the solver with --threads threads each,
+// helpers run one thread each beside them. The side local search of the
+// assignment model is a helper, and so is every portfolio member but the MIP.
+static void SolveThreadUse(const VantOptions& opts, int& users, int& helpers)
+{
+	users = 1;
+	helpers = 0;
+	if (opts.engine == "portfolio")
+	{
+		std::vector<std::string> members;
+		ParsePortfolio(opts.portfolio, members);
+		users = (int)std::count(members.begin(), members.end(), std::string("mip"));
+		helpers = (int)members.size() - users;
+	}
+	else if ((opts.engine == "auto" || opts.engine == "mip") && opts.searchTime > 0 &&
+		opts.model != "arcflow" && opts.model != "colgen")
+		helpers = 1;
+}
+
+int RunBatch(int argc, char* argv[])
+{
+	BatchOptions opts;
+	std::vector<BatchJob> jobs;
+
+	if (!ParseBatchOptions(argc, argv, opts))
+		return 1;
+	if (IsDirectory(opts.input) ? !ScanDirectory(opts, jobs) :
+		!ReadManifest(opts.input, opts.solve.timeLimit, jobs))
+		return 1;
+	if (jobs.empty())
+	{
+		printf("No instances to solve\n");
+		return 1;
+	}
+
+	// split the thread budget between concurrent solves and solver threads;
+	// a solve also runs threads of its own besides those of the solver
+	int budget = opts.budget;
+	if (budget <= 0)
+		budget = std::max(1, (int)std::thread::hardware_concurrency());
+	int users, helpers;
+	SolveThreadUse(opts.solve, users, helpers);
+	int threads = opts.solve.threads;
+	if (threads == 0)
+	{
+		// the native engine is single-threaded
+		if (opts.solve.solver == "native" || (int)jobs.size() >= budget)
+			threads = 1;
+		else
+			threads = (budget / (int)jobs.size() - helpers) / std::max(1, users);
+	}
+	if (users > 0)
+		threads = std::min(threads, (budget - helpers) / users);
+	threads = std::max(1, threads);
+	int perSolve = helpers + users * threads;
+	int workers = std::max(1, std::min(budget / perSolve, (int)jobs.size()));
+	printf("Batch: %d instances, %d workers x %d solver threads",
+		(int)jobs.size(), workers, threads);
+	if (helpers > 0)
+		printf(" + %d helper threads", helpers);
+	printf("\n");
+	if (perSolve > budget)
+		printf("One solve needs %d threads, more than the budget of %d\n", perSolve,
+			budget);
+
+	FILE* fres = NULL;
+	if (opts.results != NULL && (fres = fopen(opts.results, "w")) == NULL)
+	{
+		printf("Unable to open the results file %s\n", opts.results);
+		return 1;
+	}
+
+	FILE* freport = NULL;
+	if (opts.report != NULL && (freport = fopen(opts.report, "w")) == NULL)
+	{
+		printf("Unable to open the report file %s\n", opts.report);
+		if (fres != NULL)
+			fclose(fres);
+		return 1;
+	}
+
+	const char* header = ReportCSVHeader(true);
+	fputs(header, stdout);
+	fflush(stdout);
+	if (fres != NULL)
+	{
+		fputs(header, fres);
+		fflush(fres);
+	}
+
+	std::atomic<int> next(0);
+	std::atomic<int> failed(0);
+	std::mutex outputMutex;
+
+	auto worker = [&]()
+	{
+		for (int k = next++; k < (int)jobs.size(); k = next++)
+		{
+			const BatchJob& job = jobs[k];
+			std::vector<int> proctime, setup;
+			JobRelations relations;
+			SolveResult result;
+			VantOptions solve = opts.solve;
+			double start = WallClock();
+			double cpuStart = ThreadCpuTime();
+
+			solve.instance = job.instance.c_str();
+			solve.machines = job.machines;
+			solve.ninst = job.ninst;
+			solve.threads = threads;
+			solve.timeLimit = job.timeLimit;
+
+			// concurrent solves: CPU time of this worker only
+			result.stats.threadCpu = true;
+			PhaseTimer readTimer(&result.stats, Phase_Read);
+			bool read = ReadInstance(job.instance.c_str(), proctime, setup, &relations);
+			readTimer.Stop();
+			int n = (int)proctime.size();
+
+			std::string line, record;
+			if (!read)
+			{
+				failed++;
+				line = FormatReportCSV(solve, n, NULL);
+				record = FormatReportJSON(solve, n, NULL);
+			}
+			else
+			{
+				SolveInstance(solve, n, n > 0 ? &proctime[0] : NULL,
+					n > 0 ? &setup[0] : NULL, result, NULL, &relations);
+				result.stats.totalWall = WallClock() - start;
+				result.stats.totalCpu = ThreadCpuTime() - cpuStart;
+				line = FormatReportCSV(solve, n, &result);
+				record = FormatReportJSON(solve, n, &result);
+			}
+
+			// stream the result as soon as the instance is done
+			std::lock_guard<std::mutex> lock(outputMutex);
+			fputs(line.c_str(), stdout);
+			fflush(stdout);
+			if (fres != NULL)
+			{
+				fputs(line.c_str(), fres);
+				fflush(fres);
+			}
+			if (freport != NULL)
+			{
+				fputs(record.c_str(), freport);
+				fflush(freport);
+			}
+		}
+	};
+
+	std::vector<std::thread> pool;
+	for (int w = 1; w < workers; w++)
+		pool.push_back(std::thread(worker));
+	worker();
+	for (size_t w = 0; w < pool.size(); w++)
+		pool[w].join();
+
+	if (fres != NULL)
+		fclose(fres);
+	if (freport != NULL)
+		fclose(freport);
+	return failed > 0 ? 1 : 0;
+}
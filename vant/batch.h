@@ -0,0 +1,17 @@
+/****************************************************************************
+* Batch mode: many instances solved on a pool of workers
+*****************************************************************************/
+
+#ifndef __BATCH_H__
+#define __BATCH_H__
+
+// vant --batch <manifest|directory> [--option=value ...]
+// Solve every instance of a manifest (one "<instance> <#machines>
+// [#instance] [time limit]" per line, '#' starting a comment) or every *.txt
+// file of a directory. The workers share a global thread budget: many
+// single-threaded solves when there are more instances than threads, fewer
+// multi-threaded ones otherwise. One CSV line is printed per instance as soon
+// as it finishes.
+int RunBatch(int argc, char* argv[]);
+
+#endif
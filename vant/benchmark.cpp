@@ -0,0 +1,644 @@
+#include "benchmark.h"
+#include "models.h"
+#include "dynprog.h"
+#include "generator.h"
+#include "instance.h"
+#include "options.h"
+#include "solve.h"
+#include "solver.h"
+#include "sysutil.h"
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <sstream>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef VANT_WITH_UFFLP
+// Name-keyed construction, as main() did before the model builder
+static void BuildLegacyModel(UFFProblem* prob, int n, int m,
+	const int* proctime, const int* setup)
+{
+	int i, j;
+	std::string varName;
+
+	std::stringstream s;
+	s << "C_max";
+	s >> varName;
+	UFFLP_AddVariable(prob, (char*)varName.c_str(), 0.0, UFFLP_Infinity, 1.0, UFFLP_Integer);
+
+	for (i = 0; i < m; i++)
+	{
+		for (j = 0; j < n; j++)
+		{
+			std::stringstream s;
+			s << "x_" << i << "_" << j;
+			s >> varName;
+			UFFLP_AddVariable(prob, (char*)varName.c_str(), 0.0, 1.0, 0.0, UFFLP_Binary);
+		}
+	}
+
+	std::string consName;
+	for (j = 0; j < n; j++)
+	{
+		std::stringstream s;
+		s << "restr1_" << j;
+		s >> consName;
+		for (i = 0; i < m; i++)
+		{
+			std::stringstream s;
+			s << "x_" << i << "_" << j;
+			s >> varName;
+			UFFLP_SetCoefficient(prob, (char*)consName.c_str(), (char*)varName.c_str(), 1);
+		}
+		UFFLP_AddConstraint(prob, (char*)consName.c_str(), 1, UFFLP_Equal);
+	}
+
+	for (i = 0; i < m; i++)
+	{
+		std::stringstream s;
+		s << "restr2_" << i;
+		s >> consName;
+		for (j = 0; j < n; j++)
+		{
+			std::stringstream s1;
+			s1 << "x_" << i << "_" << j;
+			s1 >> varName;
+			UFFLP_SetCoefficient(prob, (char*)consName.c_str(), (char*)varName.c_str(), setup[j] + proctime[j]);
+		}
+		std::stringstream s2;
+		s2 << "C_max";
+		s2 >> varName;
+		UFFLP_SetCoefficient(prob, (char*)consName.c_str(), (char*)varName.c_str(), -1);
+		UFFLP_AddConstraint(prob, (char*)consName.c_str(), 0, UFFLP_Less);
+	}
+}
+#endif // VANT_WITH_UFFLP
+
+int RunBuildBenchmark(int argc, char* argv[])
+{
+	if (argc < 5) {
+		printf("Usage: vant --bench-build <#jobs> <#machines> <legacy|indexed|noload> [seed]\n");
+		return 1;
+	}
+
+	int n = atoi(argv[2]);
+	int m = atoi(argv[3]);
+	const char* path = argv[4];
+	unsigned seed = argc > 5 ? (unsigned)atoi(argv[5]) : 1;
+
+	if (n <= 0 || m <= 0) {
+		printf("Invalid instance size!\n");
+		return 1;
+	}
+
+	// uniform processing times in [1,100] and setups in [1,20]
+	std::vector<int> proctime(n), setup(n);
+	srand(seed);
+	for (size_t k = 0; k < proctime.size(); k++)
+		proctime[k] = 1 + rand() % 100;
+	for (size_t k = 0; k < setup.size(); k++)
+		setup[k] = 1 + rand() % 20;
+
+	long baseRSS = PeakRSSKB();
+	double start = WallClock();
+	int rows = n + m, cols = 1 + n * m;
+
+	if (strcmp(path, "legacy") == 0)
+	{
+#ifdef VANT_WITH_UFFLP
+		UFFProblem* prob = UFFLP_CreateProblem(UFFLP_Minimize);
+		BuildLegacyModel(prob, n, m, &proctime[0], &setup[0]);
+		UFFLP_DestroyProblem(prob);
+#else
+		printf("The legacy path needs UFFLP (build with VANT_WITH_UFFLP)\n");
+		return 1;
+#endif
+	}
+	else if (strcmp(path, "indexed") == 0 || strcmp(path, "noload") == 0)
+	{
+		ModelBuilder model;
+		BuildAssignmentModel(model, n, m, &proctime[0], &setup[0]);
+		if (strcmp(path, "indexed") == 0)
+		{
+			SolverBackend* solver = CreateSolver(DefaultSolverName());
+			solver->LoadModel(model);
+			delete solver;
+		}
+	}
+	else
+	{
+		printf("Unknown build path: %s\n", path);
+		return 1;
+	}
+
+	double elapsed = WallClock() - start;
+
+	printf("path      n        m      rows       cols    build(s)  peakRSS(KB)  delta(KB)\n");
+	printf("%-8s %-8d %-6d %-10d %-10d %8.3f  %11ld  %9ld\n",
+		path, n, m, rows, cols, elapsed, PeakRSSKB(), PeakRSSKB() - baseRSS);
+	return 0;
+}
+
+int RunSymmetryBenchmark(int argc, char* argv[])
+{
+	static const char* modes[] = { "off", "loads", "fix", "priority" };
+	VantOptions opts;
+	std::vector<int> proctime, setup;
+
+	// the arguments after --bench-symmetry are those of a single run
+	if (!ParseOptions(argc - 1, argv + 1, opts))
+		return 1;
+	if (!ReadInstance(opts.instance, proctime, setup))
+	{
+		printf("Unable to open input file! %s\n", opts.instance);
+		return 1;
+	}
+	int n = (int)proctime.size();
+	opts.engine = "mip";
+	opts.verbose = false;
+
+	printf("%-9s %5s %5s %-10s %10s %10s %10s\n", "symmetry", "n", "m",
+		"status", "makespan", "nodes", "wall(s)");
+	for (size_t k = 0; k < sizeof(modes) / sizeof(modes[0]); k++)
+	{
+		SolveResult result;
+		opts.symmetry = modes[k];
+		if (opts.symmetry == "fix" && opts.aggregate == "on")
+			continue;
+
+		double start = WallClock();
+		SolveInstance(opts, n, n > 0 ? &proctime[0] : NULL,
+			n > 0 ? &setup[0] : NULL, result);
+		double wall = WallClock() - start;
+
+		if (result.nodes < 0 && result.status == UFFLP_Optimal &&
+			result.value <= result.lowerBound)
+		{
+			printf("The heuristic schedule meets the lower bound, the MIP is not run\n");
+			return 0;
+		}
+		printf("%-9s %5d %5d %-10s %10.0f %10ld %10.3f\n", modes[k], n,
+			opts.machines, StatusName(result.status), result.value,
+			result.nodes, wall);
+		fflush(stdout);
+	}
+	return 0;
+}
+
+// Command line options of every engine of the suite; the local search gets
+// the time limit as its search time
+static const char* SuiteEngines[][2] =
+{
+	{ "dp", "--engine=dp --search-time=0" },
+	{ "mip", "--engine=mip --model=assign --search-time=0" },
+	{ "arcflow", "--engine=mip --model=arcflow --search-time=0" },
+	{ "colgen", "--engine=mip --model=colgen --search-time=0" },
+	{ "ils", "--engine=ils" },
+	{ "binpack", "--engine=binpack --search-time=0" },
+	{ "lagrange", "--engine=lagrange --search-time=0" },
+	{ "portfolio", "--engine=portfolio --search-time=0" },
+};
+static const int NumSuiteEngines = sizeof(SuiteEngines) / sizeof(SuiteEngines[0]);
+
+// Differences below these are noise, not regressions
+static const double GapTolerance = 1e-6;
+static const double MinSlowdownSeconds = 0.1;
+static const long MinMemoryKB = 1024;
+
+#ifdef _WIN32
+static const char* NullOutput = " > NUL 2>&1";
+#else
+static const char* NullOutput = " > /dev/null 2>&1";
+#endif
+
+static const char* SuiteCSVHeader = "class,jobs,machines,seed,engine,time_limit,"
+	"status,makespan,best_bound,gap,seconds,time_to_optimal,peak_rss_kb\n";
+
+struct SuiteRecord
+{
+	std::string key;            // class,jobs,machines,seed,engine,time_limit
+	std::string status;
+	double makespan, bound, gap, seconds;
+	long peakRSS;
+};
+
+bool ValidSuiteEngine(const std::string& name)
+{
+	for (int e = 0; e < NumSuiteEngines; e++)
+		if (name == SuiteEngines[e][0])
+			return true;
+	return false;
+}
+
+static const char* SuiteEngineArgs(const std::string& name)
+{
+	for (int e = 0; e < NumSuiteEngines; e++)
+		if (name == SuiteEngines[e][0])
+			return SuiteEngines[e][1];
+	return "";
+}
+
+static std::string Quote(const std::string& s)
+{
+	return "\"" + s + "\"";
+}
+
+// Split a CSV line without quoted fields
+static void SplitFields(const std::string& line, std::vector<std::string>& fields)
+{
+	fields.clear();
+	size_t start = 0;
+	while (true)
+	{
+		size_t end = line.find(',', start);
+		if (end == std::string::npos)
+		{
+			fields.push_back(line.substr(start));
+			return;
+		}
+		fields.push_back(line.substr(start, end - start));
+		start = end + 1;
+	}
+}
+
+static bool ReadLine(FILE* f, std::string& line)
+{
+	char buf[1024];
+	line.clear();
+	while (fgets(buf, sizeof(buf), f) != NULL)
+	{
+		line += buf;
+		if (line[line.size() - 1] == '\n')
+			break;
+	}
+	while (!line.empty() && (line[line.size() - 1] == '\n' ||
+		line[line.size() - 1] == '\r'))
+		line.erase(line.size() - 1);
+	return !line.empty();
+}
+
+// Solve an instance in a child process and read its --report-csv record.
+// @return false if the run left no record
+static bool RunChild(const std::string& self, const std::string& file, int m,
+	int seed, const std::string& engine, double limit, const SuiteOptions& opts,
+	const std::string& report, SuiteRecord& record)
+{
+	char buf[128];
+	std::string command = Quote(self) + " " + Quote(file);
+	sprintf(buf, " %d %d --time-limit=%g", m, seed, limit);
+	command += buf;
+	// the records go to the report only, not to the working directory
+	command += " --files=off --report-csv=" + Quote(report) + " " +
+		SuiteEngineArgs(engine);
+	if (engine == "ils")
+	{
+		sprintf(buf, " --search-time=%g", limit);
+		command += buf;
+	}
+	for (size_t k = 0; k < opts.forward.size(); k++)
+		command += " " + Quote(opts.forward[k]);
+	command += NullOutput;
+#ifdef _WIN32
+	// cmd.exe strips the first and the last quote of the line
+	command = "\"" + command + "\"";
+#endif
+
+	remove(report.c_str());
+	if (system(command.c_str()) == -1)
+		return false;
+	FILE* f = fopen(report.c_str(), "r");
+	if (f == NULL)
+		return false;
+
+	// the record after the header; the instance path comes first and is
+	// skipped whole, since the directory may hold commas
+	std::string line;
+	std::vector<std::string> fields;
+	bool read = ReadLine(f, line) && ReadLine(f, line) &&
+		line.compare(0, file.size(), file) == 0;
+	fclose(f);
+	remove(report.c_str());
+	if (!read)
+		return false;
+	SplitFields(line.substr(file.size()), fields);
+	if (fields.size() < 16)
+		return false;
+	record.status = fields[4];
+	record.makespan = atof(fields[5].c_str());
+	record.seconds = atof(fields[7].c_str());
+	record.bound = atof(fields[8].c_str());
+	record.gap = atof(fields[9].c_str());
+	record.peakRSS = atol(fields[14].c_str());
+	return true;
+}
+
+static std::string FormatSuiteRecord(const SuiteRecord& record)
+{
+	char buf[256];
+	std::string line = record.key;
+	sprintf(buf, ",%s,%.0f,%.0f,%.6f,%.3f,", record.status.c_str(),
+		record.makespan, record.bound, record.gap, record.seconds);
+	line += buf;
+	if (record.status == "optimal")
+	{
+		sprintf(buf, "%.3f", record.seconds);
+		line += buf;
+	}
+	sprintf(buf, ",%ld\n", record.peakRSS);
+	return line + buf;
+}
+
+// Records of an earlier suite by key
+static bool ReadBaseline(const char* fname, std::map<std::string, SuiteRecord>& baseline)
+{
+	FILE* f = fopen(fname, "r");
+	if (f == NULL)
+		return false;
+
+	std::string line;
+	std::vector<std::string> fields;
+	ReadLine(f, line);
+	while (ReadLine(f, line))
+	{
+		SplitFields(line, fields);
+		if (fields.size() < 13)
+			continue;
+		SuiteRecord record;
+		record.key = fields[0];
+		for (int k = 1; k < 6; k++)
+			record.key += "," + fields[k];
+		record.status = fields[6];
+		record.makespan = atof(fields[7].c_str());
+		record.bound = atof(fields[8].c_str());
+		record.gap = atof(fields[9].c_str());
+		record.seconds = atof(fields[10].c_str());
+		record.peakRSS = atol(fields[12].c_str());
+		baseline[record.key] = record;
+	}
+	fclose(f);
+	return true;
+}
+
+// Print the regressions of the records over the baseline.
+// @return their number
+static int CompareWithBaseline(const std::vector<SuiteRecord>& records,
+	const std::map<std::string, SuiteRecord>& baseline, double slowdown)
+{
+	int regressions = 0;
+	for (size_t k = 0; k < records.size(); k++)
+	{
+		const SuiteRecord& now = records[k];
+		std::map<std::string, SuiteRecord>::const_iterator it = baseline.find(now.key);
+		if (it == baseline.end())
+			continue;
+		const SuiteRecord& was = it->second;
+
+		char reason[128] = "";
+		if (was.status == "optimal" && now.status != "optimal")
+			sprintf(reason, "%s, was optimal", now.status.c_str());
+		else if (now.gap > was.gap + GapTolerance)
+			sprintf(reason, "gap %.6f, was %.6f", now.gap, was.gap);
+		else if (now.status == "optimal" && was.status == "optimal" &&
+			now.seconds > was.seconds * slowdown &&
+			now.seconds - was.seconds > MinSlowdownSeconds)
+			sprintf(reason, "%.3f s to optimality, was %.3f s", now.seconds, was.seconds);
+		if (reason[0] != '\0')
+		{
+			printf("Regression %s: %s\n", now.key.c_str(), reason);
+			regressions++;
+		}
+		if (now.peakRSS > was.peakRSS * slowdown &&
+			now.peakRSS - was.peakRSS > MinMemoryKB)
+		{
+			printf("Regression %s: peak RSS %ld KB, was %ld KB\n", now.key.c_str(),
+				now.peakRSS, was.peakRSS);
+			regressions++;
+		}
+	}
+	return regressions;
+}
+
+// Instance of a record: class,jobs,machines,seed
+static std::string InstanceKey(const std::string& key)
+{
+	size_t end = 0;
+	for (int k = 0; k < 4 && end != std::string::npos; k++)
+		end = key.find(',', end + (k > 0 ? 1 : 0));
+	return key.substr(0, end);
+}
+
+// Print the runs whose bound exceeds a makespan that some run found on the
+// same instance, or that claim an optimal makespan above it: no engine may
+// prove such a bound.
+// @return their number
+static int CheckBounds(const std::vector<SuiteRecord>& records)
+{
+	std::map<std::string, double> best;
+	for (size_t k = 0; k < records.size(); k++)
+	{
+		if (records[k].status != "optimal" && records[k].status != "feasible")
+			continue;
+		std::string instance = InstanceKey(records[k].key);
+		std::map<std::string, double>::iterator it = best.find(instance);
+		if (it == best.end() || records[k].makespan < it->second)
+			best[instance] = records[k].makespan;
+	}
+
+	int unsound = 0;
+	for (size_t k = 0; k < records.size(); k++)
+	{
+		std::map<std::string, double>::const_iterator it =
+			best.find(InstanceKey(records[k].key));
+		if (it == best.end() || records[k].status == "failed")
+			continue;
+		double bound = records[k].status == "optimal" ? records[k].makespan :
+			records[k].bound;
+		if (bound > it->second + 0.5)
+		{
+			printf("Unsound bound %s: %.0f, but a run found %.0f\n",
+				records[k].key.c_str(), bound, it->second);
+			unsound++;
+		}
+	}
+	return unsound;
+}
+
+// Solved runs, mean gap, mean time to optimality and largest peak RSS of
+// every engine and time limit
+static void PrintSuiteSummary(const SuiteOptions& opts,
+	const std::vector<SuiteRecord>& records)
+{
+	printf("\n%-10s %9s %9s %10s %10s %12s\n", "engine", "limit(s)", "solved",
+		"mean gap", "mean TTO", "peakRSS(KB)");
+	for (size_t e = 0; e < opts.engines.size(); e++)
+		for (size_t l = 0; l < opts.limits.size(); l++)
+		{
+			char suffix[64];
+			sprintf(suffix, ",%s,%g", opts.engines[e].c_str(), opts.limits[l]);
+			int runs = 0, solved = 0;
+			double gap = 0, tto = 0;
+			long rss = 0;
+			for (size_t k = 0; k < records.size(); k++)
+			{
+				const std::string& key = records[k].key;
+				size_t len = strlen(suffix);
+				if (key.size() < len || key.compare(key.size() - len, len, suffix) != 0)
+					continue;
+				runs++;
+				gap += records[k].gap;
+				rss = std::max(rss, records[k].peakRSS);
+				if (records[k].status == "optimal")
+				{
+					solved++;
+					tto += records[k].seconds;
+				}
+			}
+			if (runs == 0)
+				continue;
+			char count[32];
+			sprintf(count, "%d/%d", solved, runs);
+			printf("%-10s %9g %9s %10.6f %10.3f %12ld\n", opts.engines[e].c_str(),
+				opts.limits[l], count, gap / runs, solved > 0 ? tto / solved : 0.0, rss);
+		}
+}
+
+// Runs of the grid, and the sum of their time limits in seconds; a limit
+// after an optimal run reuses its record, so these are upper bounds
+static int PlannedSuiteRuns(const SuiteOptions& opts, double& seconds)
+{
+	int runs = 0;
+	seconds = 0;
+	for (size_t i = 0; i < opts.machines.size(); i++)
+		for (size_t e = 0; e < opts.engines.size(); e++)
+		{
+			if (opts.engines[e] == "dp" && opts.machines[i] > MaxDpMachines)
+				continue;
+			for (size_t l = 0; l < opts.limits.size(); l++)
+			{
+				runs++;
+				seconds += opts.limits[l];
+			}
+		}
+	int instances = (int)(opts.classes.size() * opts.jobs.size()) * opts.seeds;
+	seconds *= instances;
+	return runs * instances;
+}
+
+int RunBenchmarkSuite(int argc, char* argv[])
+{
+	SuiteOptions opts;
+	std::map<std::string, SuiteRecord> baseline;
+
+	if (!ParseSuiteOptions(argc, argv, opts))
+		return 1;
+	double seconds;
+	int planned = PlannedSuiteRuns(opts, seconds);
+	printf("Planned runs: %d, up to %.0f s of time limits\n", planned, seconds);
+	if (!opts.grid)
+	{
+		printf("No grid given: choose one with --classes, --jobs, --machines,\n");
+		printf("--seeds, --engines or --limits, or run vant --bench-suite=default\n");
+		return 1;
+	}
+	if (!IsDirectory(opts.dir))
+	{
+		printf("No such directory: %s\n", opts.dir);
+		return 1;
+	}
+	if (opts.baseline != NULL && !ReadBaseline(opts.baseline, baseline))
+	{
+		printf("Unable to read the baseline %s\n", opts.baseline);
+		return 1;
+	}
+	FILE* fcsv = NULL;
+	if (opts.csv != NULL)
+	{
+		fcsv = fopen(opts.csv, "w");
+		if (fcsv == NULL)
+		{
+			printf("Unable to write the records to %s\n", opts.csv);
+			return 1;
+		}
+		fputs(SuiteCSVHeader, fcsv);
+	}
+
+	std::string dir(opts.dir);
+	std::string report = dir + "/bench-run.csv";
+	std::vector<SuiteRecord> records;
+	std::vector<int> proctime, setup;
+	char buf[256];
+
+	printf("%-6s %8s %5s %5s %-10s %8s %-10s %10s %9s %9s %11s\n", "class", "n", "m",
+		"seed", "engine", "limit(s)", "status", "makespan", "gap", "wall(s)",
+		"peakRSS(KB)");
+	for (size_t c = 0; c < opts.classes.size(); c++)
+		for (size_t j = 0; j < opts.jobs.size(); j++)
+			for (int seed = 1; seed <= opts.seeds; seed++)
+			{
+				// generated once, kept for the next suites
+				const std::string& name = opts.classes[c];
+				int n = opts.jobs[j];
+				sprintf(buf, "/%s-%d-%d.txt", name.c_str(), n, seed);
+				std::string file = dir + buf;
+				FILE* f = fopen(file.c_str(), "r");
+				if (f != NULL)
+					fclose(f);
+				else if (!GenerateInstance(name, n, (unsigned)seed, proctime, setup) ||
+					!WriteInstance(file.c_str(), proctime, setup, false))
+				{
+					printf("Unable to write the instance %s\n", file.c_str());
+					continue;
+				}
+
+				for (size_t i = 0; i < opts.machines.size(); i++)
+					for (size_t e = 0; e < opts.engines.size(); e++)
+					{
+						int m = opts.machines[i];
+						const std::string& engine = opts.engines[e];
+						if (engine == "dp" && m > MaxDpMachines)
+							continue;
+
+						SuiteRecord record;
+						record.status.clear();
+						for (size_t l = 0; l < opts.limits.size(); l++)
+						{
+							sprintf(buf, "%s,%d,%d,%d,%s,%g", name.c_str(), n, m, seed,
+								engine.c_str(), opts.limits[l]);
+							if (record.status != "optimal" && !RunChild(argv[0], file, m,
+								seed, engine, opts.limits[l], opts, report, record))
+							{
+								record.status = "failed";
+								record.makespan = record.bound = record.seconds = 0;
+								record.gap = 1;
+								record.peakRSS = 0;
+							}
+							record.key = buf;
+							records.push_back(record);
+							if (fcsv != NULL)
+							{
+								fputs(FormatSuiteRecord(record).c_str(), fcsv);
+								fflush(fcsv);
+							}
+							printf("%-6s %8d %5d %5d %-10s %8g %-10s %10.0f %9.6f %9.3f %11ld\n",
+								name.c_str(), n, m, seed, engine.c_str(), opts.limits[l],
+								record.status.c_str(), record.makespan, record.gap,
+								record.seconds, record.peakRSS);
+							fflush(stdout);
+						}
+					}
+			}
+	if (fcsv != NULL)
+		fclose(fcsv);
+
+	PrintSuiteSummary(opts, records);
+	int unsound = CheckBounds(records);
+	if (opts.baseline == NULL)
+		return unsound > 0 ? 1 : 0;
+	int regressions = CompareWithBaseline(records, baseline, opts.slowdown);
+	printf("%d regression(s) over %s\n", regressions, opts.baseline);
+	return regressions > 0 || unsound > 0 ? 1 : 0;
+}
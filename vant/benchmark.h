@@ -0,0 +1,44 @@
+/****************************************************************************
+* Benchmarks comparing alternative code paths of vant
+*****************************************************************************/
+
+#ifndef __BENCHMARK_H__
+#define __BENCHMARK_H__
+
+#include <string>
+
+// vant --bench-build <#jobs> <#machines> <legacy|indexed|noload> [seed]
+// Build the assignment model of a random instance through the selected path
+// and report the build time and the peak RSS. "legacy" is the former
+// name-keyed UFFLP path, "indexed" loads the ModelBuilder into the default
+// solver backend and "noload" only builds it. Run each path in its own
+// process, since the peak RSS never decreases.
+int RunBuildBenchmark(int argc, char* argv[]);
+
+// vant --bench-symmetry <instance> <#machines> <#instance> [--option=value ...]
+// Solve the assignment model once per symmetry breaking mode (off, loads,
+// fix, priority) and report the status, makespan, branch-and-bound nodes
+// and wall time of each run. The exact DP engine is disabled.
+int RunSymmetryBenchmark(int argc, char* argv[]);
+
+// vant --bench-suite[=default] [--option=value ...]
+// Print the number of runs of the grid, and refuse the default grid unless
+// asked for with "=default". Generate the instances of the classes and
+// sizes into the directory, then run every engine on each of them under
+// every time limit, in a process of its own for a true peak RSS, and write
+// one CSV record per run: status, makespan, best bound, gap, wall time,
+// time to optimality and peak RSS. A limit after one that proved
+// optimality reuses its record. With a baseline
+// of an earlier suite, a run that is no longer optimal, ends with a larger
+// gap, or takes the slowdown ratio more time or memory is reported as a
+// regression, and the exit code is 1. So is a run whose bound, or optimal
+// makespan, exceeds a makespan that another run found on the same instance,
+// e.g. --classes=u100 --jobs=100 --machines=10 --seeds=1 --engines=ils,colgen
+// checks the column generation bound against the local search.
+int RunBenchmarkSuite(int argc, char* argv[]);
+
+// @return true if name is an engine of the suite: dp, mip, arcflow,
+// colgen, ils, binpack, lagrange or portfolio
+bool ValidSuiteEngine(const std::string& name);
+
+#endif
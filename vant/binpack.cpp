@@ -0,0 +1,468 @@
+#include "binpack.h"
+#include "heuristics.h"
+#include "portfolio.h"
+#include "runstats.h"
+#include "sysutil.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <limits>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <stdio.h>
+
+// Failed sets of bin loads remembered by the search of one probe
+static const size_t MaxMemoStates = 1 << 20;
+
+// Nodes of the search between two checks of the stop flag and the clock
+static const long long CheckInterval = 1024;
+
+long long BinPackingBound(const std::vector<int>& size, long long capacity)
+{
+	long long C = capacity;
+	std::vector<int> asc(size);
+	std::sort(asc.begin(), asc.end());
+	int n = (int)asc.size();
+	if (n == 0)
+		return 0;
+	if (asc[n - 1] > C)
+		return std::numeric_limits<long long>::max();
+
+	std::vector<long long> prefix(n + 1, 0);
+	for (int k = 0; k < n; k++)
+		prefix[k + 1] = prefix[k] + asc[k];
+	// position of the first size above v
+	auto above = [&asc](long long v)
+	{
+		return (int)(std::upper_bound(asc.begin(), asc.end(), v) - asc.begin());
+	};
+
+	// for K = 0 and every size K up to C/2: the sizes above C - K take a bin
+	// each, those above C/2 too, and the sizes from K to C/2 fill the room
+	// left by the latter before opening more bins
+	int half = above(C / 2);
+	long long best = (prefix[n] + C - 1) / C;
+	for (int k = -1; k < half; k++)
+	{
+		if (k > 0 && asc[k] == asc[k - 1])
+			continue;
+		long long K = k < 0 ? 0 : asc[k];
+		int first = k < 0 ? 0 : k;
+		int big = above(C - K);
+		long long alone = n - big, large = big - half;
+		long long room = large * C - (prefix[big] - prefix[half]);
+		long long extra = prefix[half] - prefix[first] - room;
+		best = std::max(best, alone + large + (extra > 0 ? (extra + C - 1) / C : 0));
+	}
+	return best;
+}
+
+// Depth first search over the jobs in non-increasing size order, after the
+// dominance reductions have given a bin of their own to the jobs whose best
+// companion is known. Every job goes to one bin of every distinct load, the
+// fullest first; bins that cannot take the smallest job count as full, and
+// the loads of the failed nodes are remembered.
+class BinPacker
+{
+public:
+	BinPacker(const std::vector<int>& size, int m, long long capacity,
+		const std::atomic<bool>* stop, double deadline);
+
+	PackResult Solve(std::vector<int>& binOf);
+
+private:
+	long long Size(int k) const { return size[order[items[k]]]; }
+
+	// Reduce the instance; false if it takes more than m bins.
+	bool Reduce();
+
+	// No room left for the jobs from k, or these loads failed before
+	bool Hopeless(int k);
+
+	// Bin of largest load below limit that takes job k, -1 if none
+	int NextBin(int k, long long limit) const;
+
+	// Job position and sorted loads, full bins at the capacity
+	const std::string& Key(int k);
+
+	bool ShouldStop() const;
+
+	const std::vector<int>& size;
+	std::vector<int> order;       // jobs by non-increasing size
+	int m;
+	long long C;
+	const std::atomic<bool>* stop;
+	double deadline;
+
+	int reduced;                  // bins filled by the reductions
+	std::vector<int> binOfPos;    // by position in order
+	std::vector<int> items;       // positions left to the search
+	std::vector<long long> rest;  // rest[k]: total size of items k and after
+	std::vector<long long> load;  // of the m - reduced bins of the search
+	std::vector<long long> sorted;
+	std::string key;
+	std::unordered_set<std::string> failed;
+};
+
+BinPacker::BinPacker(const std::vector<int>& size, int m, long long capacity,
+	const std::atomic<bool>* stop, double deadline) : size(size), m(m),
+	C(capacity), stop(stop), deadline(deadline), reduced(0)
+{
+	SortBySize(size, order);
+}
+
+bool BinPacker::ShouldStop() const
+{
+	return (stop != NULL && stop->load()) || WallClock() >= deadline;
+}
+
+// Position of the first unplaced job at or after p, n if none; placed jobs
+// point past themselves
+static int NextUnplaced(std::vector<int>& next, int p)
+{
+	int root = p;
+	while (next[root] != root)
+		root = next[root];
+	while (next[p] != root)
+	{
+		int up = next[p];
+		next[p] = root;
+		p = up;
+	}
+	return root;
+}
+
+bool BinPacker::Reduce()
+{
+	int n = (int)order.size();
+	std::vector<int> next(n + 1);
+	for (int p = 0; p <= n; p++)
+		next[p] = p;
+	std::vector<char> placed(n, 0);
+	binOfPos.assign(n, -1);
+	int tail = n - 1;
+
+	for (int i = 0; i < n; i++)
+	{
+		if (placed[i])
+			continue;
+		long long s = size[order[i]];
+
+		// the two smallest other jobs still free
+		while (tail >= 0 && placed[tail])
+			tail--;
+		int first = tail;
+		while (first >= 0 && (placed[first] || first == i))
+			first--;
+		int second = first - 1;
+		while (second >= 0 && (placed[second] || second == i))
+			second--;
+
+		// the largest free job that fits with i
+		int j = -1;
+		if (first >= 0 && s + size[order[first]] <= C)
+		{
+			int p = (int)(std::lower_bound(order.begin(), order.end(), C - s,
+				[this](int job, long long v) { return size[job] > v; }) - order.begin());
+			j = NextUnplaced(next, p);
+			if (j == i)
+				j = NextUnplaced(next, i + 1);
+		}
+
+		// alone, filled exactly by j, or with room for j at most
+		bool reduce = j < 0 || s + size[order[j]] == C ||
+			second < 0 || s + size[order[first]] + size[order[second]] > C;
+		if (!reduce)
+			continue;
+		if (reduced == m)
+			return false;
+		placed[i] = 1;
+		next[i] = i + 1;
+		binOfPos[i] = reduced;
+		if (j >= 0)
+		{
+			placed[j] = 1;
+			next[j] = j + 1;
+			binOfPos[j] = reduced;
+		}
+		reduced++;
+	}
+
+	items.clear();
+	for (int p = 0; p < n; p++)
+		if (!placed[p])
+			items.push_back(p);
+	return true;
+}
+
+bool BinPacker::Hopeless(int k)
+{
+	long long smallest = Size((int)items.size() - 1);
+	long long room = 0;
+	for (size_t b = 0; b < load.size(); b++)
+		if (load[b] + smallest <= C)
+			room += C - load[b];
+	return room < rest[k] || failed.count(Key(k)) > 0;
+}
+
+int BinPacker::NextBin(int k, long long limit) const
+{
+	long long s = Size(k);
+	int best = -1;
+	for (size_t b = 0; b < load.size(); b++)
+		if (load[b] < limit && load[b] + s <= C && (best < 0 || load[b] > load[best]))
+			best = (int)b;
+	return best;
+}
+
+const std::string& BinPacker::Key(int k)
+{
+	long long smallest = Size((int)items.size() - 1);
+	sorted = load;
+	for (size_t b = 0; b < sorted.size(); b++)
+		if (sorted[b] + smallest > C)
+			sorted[b] = C;
+	std::sort(sorted.begin(), sorted.end());
+	key.assign((const char*)&k, sizeof(k));
+	key.append((const char*)&sorted[0], sorted.size() * sizeof(long long));
+	return key;
+}
+
+PackResult BinPacker::Solve(std::vector<int>& binOf)
+{
+	if (!Reduce())
+		return Pack_NoFit;
+
+	int count = (int)items.size();
+	rest.assign(count + 1, 0);
+	for (int k = count - 1; k >= 0; k--)
+		rest[k] = rest[k + 1] + Size(k);
+	load.assign(m - reduced, 0);
+
+	// iterative, the path can be as long as the number of jobs
+	std::vector<int> chosen(count, -1);
+	long long nodes = 0;
+	long long limit = -1;   // -1 on the first visit of depth k
+	int k = 0;
+	while (k < count)
+	{
+		int b = -1;
+		if (limit < 0)
+		{
+			if (++nodes % CheckInterval == 0 && ShouldStop())
+				return Pack_Unknown;
+			if (!load.empty() && !Hopeless(k))
+				b = NextBin(k, C + 1);
+		}
+		else
+			b = NextBin(k, limit);
+
+		if (b >= 0)
+		{
+			chosen[k] = b;
+			load[b] += Size(k);
+			k++;
+			limit = -1;
+			continue;
+		}
+
+		// every bin failed: remember the loads and take the next bin above
+		if (failed.size() < MaxMemoStates && !load.empty())
+			failed.insert(Key(k));
+		if (k == 0)
+			return Pack_NoFit;
+		k--;
+		load[chosen[k]] -= Size(k);
+		limit = load[chosen[k]];
+	}
+
+	binOf.assign(size.size(), 0);
+	for (size_t p = 0; p < order.size(); p++)
+		binOf[order[p]] = binOfPos[p];
+	for (int q = 0; q < count; q++)
+		binOf[order[items[q]]] = reduced + chosen[q];
+	return Pack_Fits;
+}
+
+PackResult FitsInBins(const std::vector<int>& size, int m, long long capacity,
+	const std::atomic<bool>* stop, double deadline, std::vector<int>& binOf)
+{
+	binOf.assign(size.size(), 0);
+	if (size.empty())
+		return Pack_Fits;
+
+	// first fit decreasing answers most capacities away from the optimum
+	std::vector<int> order;
+	SortBySize(size, order);
+	if (size[order[0]] > capacity)
+		return Pack_NoFit;
+	if (FirstFitDecreasing(size, order, m, capacity, binOf))
+		return Pack_Fits;
+	if (BinPackingBound(size, capacity) > m)
+		return Pack_NoFit;
+
+	BinPacker packer(size, m, capacity, stop, deadline);
+	return packer.Solve(binOf);
+}
+
+// The makespan lies in [lo, hi]; the probe threads pick the capacities
+struct DualSearch
+{
+	struct Probe
+	{
+		long long capacity;
+		std::atomic<bool> cancel;
+	};
+
+	// Cancel the probes whose answer is already known
+	void CancelPointless();
+
+	// Midpoint of the widest interval between lo - 1, the capacities being
+	// probed and hi; -1 if every capacity in [lo, hi) is being probed
+	long long NextCapacity() const;
+
+	bool Done() const { return lo >= hi || expired; }
+
+	std::mutex mutex;
+	std::condition_variable changed;
+	long long lo, hi;
+	std::vector<int> best;          // schedule of makespan hi
+	std::vector<Probe*> running;
+	bool expired;                   // time limit or the portfolio stopped
+};
+
+void DualSearch::CancelPointless()
+{
+	for (size_t k = 0; k < running.size(); k++)
+		if (expired || running[k]->capacity < lo || running[k]->capacity >= hi)
+			running[k]->cancel = true;
+}
+
+long long DualSearch::NextCapacity() const
+{
+	std::vector<long long> points;
+	points.push_back(lo - 1);
+	points.push_back(hi);
+	for (size_t k = 0; k < running.size(); k++)
+		if (running[k]->capacity >= lo && running[k]->capacity < hi)
+			points.push_back(running[k]->capacity);
+	std::sort(points.begin(), points.end());
+
+	long long widest = 1, capacity = -1;
+	for (size_t k = 1; k < points.size(); k++)
+		if (points[k] - points[k - 1] > widest)
+		{
+			widest = points[k] - points[k - 1];
+			capacity = points[k - 1] + widest / 2;
+		}
+	return capacity;
+}
+
+static void ProbeWorker(DualSearch& search, const std::vector<int>& jobSize,
+	int m, const EngineSettings& settings, double deadline)
+{
+	std::unique_lock<std::mutex> lock(search.mutex);
+	while (!search.Done())
+	{
+		long long C = search.NextCapacity();
+		if (C < 0)
+		{
+			search.changed.wait(lock);
+			continue;
+		}
+
+		DualSearch::Probe probe;
+		probe.capacity = C;
+		probe.cancel = false;
+		search.running.push_back(&probe);
+		lock.unlock();
+
+		double start = WallClock();
+		std::vector<int> binOf;
+		PackResult res = FitsInBins(jobSize, m, C, &probe.cancel, deadline, binOf);
+
+		lock.lock();
+		search.running.erase(std::find(search.running.begin(), search.running.end(),
+			&probe));
+		if (res == Pack_Fits && C < search.hi)
+		{
+			search.hi = ScheduleMakespan(jobSize, m, binOf);
+			search.best = binOf;
+			if (settings.shared != NULL)
+				settings.shared->Offer(settings.member, search.hi, binOf);
+		}
+		else if (res == Pack_NoFit && C >= search.lo)
+		{
+			search.lo = C + 1;
+			if (settings.shared != NULL)
+				settings.shared->RaiseBound(settings.member, search.lo);
+		}
+		else if (res == Pack_Unknown && !probe.cancel)
+			search.expired = true;
+		if (settings.log != NULL)
+			fprintf(settings.log, "Bin packing: capacity %lld %s in %.3f s, range [%lld, %lld]\n",
+				C, res == Pack_Fits ? "fits" : res == Pack_NoFit ? "does not fit" :
+				"cancelled", WallClock() - start, search.lo, search.hi);
+		search.CancelPointless();
+		search.changed.notify_all();
+	}
+}
+
+UFFLP_StatusType SolveByBinPacking(const std::vector<int>& jobSize, int m,
+	const EngineSettings& settings, long long lowerBound,
+	long long& makespan, std::vector<int>& machineOf)
+{
+	PhaseTimer solveTimer(settings.stats, Phase_Solve);
+	double deadline = WallClock() + settings.timeLimit;
+
+	long long total = 0, largest = 0;
+	for (size_t j = 0; j < jobSize.size(); j++)
+	{
+		total += jobSize[j];
+		largest = std::max<long long>(largest, jobSize[j]);
+	}
+
+	DualSearch search;
+	search.lo = std::max(lowerBound, std::max(largest, (total + m - 1) / m));
+	search.hi = makespan;
+	search.best = machineOf;
+	search.expired = false;
+
+	int threads = settings.threads > 0 ? settings.threads :
+		(int)std::thread::hardware_concurrency();
+	threads = (int)std::max(1LL, std::min<long long>(threads, search.hi - search.lo));
+	std::vector<std::thread> pool;
+	for (int t = 0; t < threads; t++)
+		pool.push_back(std::thread(ProbeWorker, std::ref(search), std::cref(jobSize),
+			m, std::cref(settings), deadline));
+
+	// follow the clock and the portfolio while the probes run
+	{
+		std::unique_lock<std::mutex> lock(search.mutex);
+		while (!search.Done())
+		{
+			search.changed.wait_for(lock, std::chrono::milliseconds(5));
+			if (settings.shared != NULL)
+			{
+				settings.shared->Tighten(search.lo, search.hi, search.best);
+				search.expired = settings.shared->stop;
+			}
+			if (WallClock() >= deadline)
+				search.expired = true;
+			search.CancelPointless();
+			search.changed.notify_all();
+		}
+		search.expired = true;
+		search.CancelPointless();
+		search.changed.notify_all();
+	}
+	for (int t = 0; t < threads; t++)
+		pool[t].join();
+
+	makespan = ScheduleMakespan(jobSize, m, search.best);
+	machineOf = search.best;
+	return search.lo >= search.hi ? UFFLP_Optimal : UFFLP_Feasible;
+}
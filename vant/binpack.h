@@ -0,0 +1,53 @@
+/****************************************************************************
+* Dual search on the makespan with a bin-packing oracle
+*
+* For a capacity C the question "do the jobs fit into m bins of size C?" is
+* answered without a MIP: first fit decreasing proves a yes, the volume and
+* the L2 bound of Martello and Toth prove a no, and otherwise the dominance
+* reductions fix the bins of the large jobs and a depth first search over
+* the rest closes the question, remembering the sets of bin loads that were
+* already shown not to fit.
+* The makespan is bracketed between a lower bound and the makespan of a
+* starting schedule, and several capacities are probed at once. A probe
+* that fits cancels the probes of larger capacities, and a probe that does
+* not fit cancels the probes of smaller ones.
+*
+*****************************************************************************/
+
+#ifndef __BIN_PACK_H__
+#define __BIN_PACK_H__
+
+#include "UFFLP.h"
+#include "solver.h"
+
+#include <atomic>
+#include <vector>
+
+enum PackResult { Pack_NoFit, Pack_Fits, Pack_Unknown };
+
+// L2 lower bound on the number of bins of size capacity for the sizes.
+long long BinPackingBound(const std::vector<int>& size, long long capacity);
+
+// Decide whether the sizes fit into m bins of size capacity.
+// @param stop      optional, the probe is abandoned once it is set
+// @param deadline  WallClock() at which the probe is abandoned
+// @param binOf     bin of every size on Pack_Fits
+// @return Pack_Unknown if abandoned
+PackResult FitsInBins(const std::vector<int>& size, int m, long long capacity,
+	const std::atomic<bool>* stop, double deadline, std::vector<int>& binOf);
+
+// Solve the makespan problem by dual search over bin-packing probes,
+// settings.threads of them at once (all cores for 0). The solver of the
+// settings is not used.
+// @param jobSize     setup + proctime of every job
+// @param lowerBound  known lower bound on the makespan
+// @param makespan    makespan of the starting schedule; the best one found
+//                    on return
+// @param machineOf   machine of every job in the starting schedule; the best
+//                    schedule found on return
+// @return UFFLP_Optimal if the search closed, UFFLP_Feasible otherwise
+UFFLP_StatusType SolveByBinPacking(const std::vector<int>& jobSize, int m,
+	const EngineSettings& settings, long long lowerBound,
+	long long& makespan, std::vector<int>& machineOf);
+
+#endif
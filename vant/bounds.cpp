@@ -0,0 +1,27 @@
+#include "bounds.h"
+
+#include <algorithm>
+#include <functional>
+
+void ComputeMakespanBounds(const std::vector<int>& size, int m,
+	MakespanBounds& bounds)
+{
+	std::vector<int> sorted(size);
+	long long total = 0;
+
+	// no machines, no schedule to bound
+	bounds.maxJob = bounds.average = bounds.pair = bounds.lower = 0;
+	if (m <= 0)
+		return;
+
+	std::sort(sorted.begin(), sorted.end(), std::greater<int>());
+	for (size_t j = 0; j < sorted.size(); j++)
+		total += sorted[j];
+
+	bounds.maxJob = sorted.empty() ? 0 : sorted[0];
+	bounds.average = (total + m - 1) / m;
+	bounds.pair = 0;
+	if ((int)sorted.size() > m)
+		bounds.pair = (long long)sorted[m - 1] + sorted[m];
+	bounds.lower = std::max(bounds.maxJob, std::max(bounds.average, bounds.pair));
+}
@@ -0,0 +1,24 @@
+/****************************************************************************
+* Combinatorial lower bounds on the makespan
+*
+* Jobs are given by their sizes setup[j] + proctime[j].
+*****************************************************************************/
+
+#ifndef __BOUNDS_H__
+#define __BOUNDS_H__
+
+#include <vector>
+
+struct MakespanBounds
+{
+	long long maxJob;   // largest job
+	long long average;  // ceil(total / m)
+	long long pair;     // p_m + p_(m+1): two of the m+1 largest jobs share a machine
+	long long lower;    // the best of the three
+};
+
+// Compute the trivial lower bounds in O(n log n); all zero when m <= 0.
+void ComputeMakespanBounds(const std::vector<int>& size, int m,
+	MakespanBounds& bounds);
+
+#endif
@@ -0,0 +1,216 @@
+#include "cache.h"
+#include "sysutil.h"
+
+#include <algorithm>
+#include <functional>
+#include <thread>
+#include <stdio.h>
+
+typedef unsigned long long CacheKey;
+
+// Number of close entries probed at most, one per distinct job size
+static const int MaxNearProbes = 4096;
+
+// Sizes in increasing order with the machine of each, as stored in a file
+struct CacheEntry
+{
+	int m;
+	long long makespan, bound;
+	std::vector<int> size, machine;
+};
+
+// splitmix64 finalizer
+static CacheKey Mix(CacheKey x)
+{
+	x += 0x9e3779b97f4a7c15ULL;
+	x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+	return x ^ (x >> 31);
+}
+
+static CacheKey MultisetKey(const std::vector<int>& size, int m)
+{
+	CacheKey key = Mix(0x5641ULL << 32 | (unsigned)m);
+	for (size_t j = 0; j < size.size(); j++)
+		key += Mix((unsigned)size[j]);
+	return key;
+}
+
+static std::string EntryName(const std::string& dir, CacheKey key)
+{
+	char name[32];
+	sprintf(name, "/%016llx.sol", key);
+	return dir + name;
+}
+
+// Jobs by increasing size, ties by index
+static void SortedOrder(const std::vector<int>& size, std::vector<int>& order)
+{
+	order.resize(size.size());
+	for (size_t j = 0; j < size.size(); j++)
+		order[j] = (int)j;
+	std::stable_sort(order.begin(), order.end(),
+		[&size](int a, int b) { return size[a] < size[b]; });
+}
+
+// Read an entry and recompute its makespan from the loads, so that a
+// damaged file cannot claim a better schedule than the one it holds.
+// @return false if the file is missing or malformed
+static bool ReadEntry(const std::string& fname, CacheEntry& entry)
+{
+	FILE* fin = fopen(fname.c_str(), "r");
+	if (fin == NULL)
+		return false;
+
+	int version, n;
+	bool ok = fscanf(fin, "vant-cache %d %d %d %lld %lld", &version, &entry.m, &n,
+		&entry.makespan, &entry.bound) == 5 && version == 1 && entry.m > 0 && n >= 0;
+	if (ok)
+	{
+		entry.size.resize(n);
+		entry.machine.resize(n);
+		for (int k = 0; ok && k < n; k++)
+			ok = fscanf(fin, "%d %d", &entry.size[k], &entry.machine[k]) == 2 &&
+				entry.machine[k] >= 0 && entry.machine[k] < entry.m &&
+				(k == 0 || entry.size[k - 1] <= entry.size[k]);
+	}
+	fclose(fin);
+	if (!ok)
+		return false;
+
+	std::vector<long long> load(entry.m, 0);
+	entry.makespan = 0;
+	for (int k = 0; k < n; k++)
+	{
+		load[entry.machine[k]] += entry.size[k];
+		entry.makespan = std::max(entry.makespan, load[entry.machine[k]]);
+	}
+	return true;
+}
+
+// Write to a file of this thread, then move it over the entry
+static bool WriteEntry(const std::string& fname, const CacheEntry& entry)
+{
+	char suffix[64];
+	sprintf(suffix, ".%d-%u.tmp", ProcessId(),
+		(unsigned)std::hash<std::thread::id>()(std::this_thread::get_id()));
+	std::string temp = fname + suffix;
+
+	FILE* fout = fopen(temp.c_str(), "w");
+	if (fout == NULL)
+		return false;
+	fprintf(fout, "vant-cache 1 %d %d %lld %lld\n", entry.m, (int)entry.size.size(),
+		entry.makespan, entry.bound);
+	for (size_t k = 0; k < entry.size.size(); k++)
+		fprintf(fout, "%d %d\n", entry.size[k], entry.machine[k]);
+	bool ok = ferror(fout) == 0;
+	ok = fclose(fout) == 0 && ok;
+	if (ok)
+		ok = RenameReplacing(temp.c_str(), fname.c_str());
+	if (!ok)
+		remove(temp.c_str());
+	return ok;
+}
+
+// True if entry holds the sorted sizes, without the one at position skip
+// if skip is not negative
+static bool SameSizes(const CacheEntry& entry, int m,
+	const std::vector<int>& sorted, int skip)
+{
+	size_t n = sorted.size() - (skip >= 0 ? 1 : 0);
+	if (entry.m != m || entry.size.size() != n)
+		return false;
+	for (size_t k = 0; k < n; k++)
+		if (entry.size[k] != sorted[skip >= 0 && (int)k >= skip ? k + 1 : k])
+			return false;
+	return true;
+}
+
+bool LookupCache(const std::string& dir, const std::vector<int>& size, int m,
+	CachedSolution& cached)
+{
+	std::vector<int> order, sorted(size.size());
+	SortedOrder(size, order);
+	for (size_t k = 0; k < order.size(); k++)
+		sorted[k] = size[order[k]];
+
+	CacheKey key = MultisetKey(size, m);
+	CacheEntry entry;
+	int skip = -1;
+	if (!ReadEntry(EntryName(dir, key), entry) || !SameSizes(entry, m, sorted, -1))
+	{
+		// an entry without one of the jobs: without the first job of every
+		// distinct size
+		bool found = false;
+		int probes = 0;
+		for (size_t k = 0; !found && k < sorted.size() && probes < MaxNearProbes; k++)
+		{
+			if (k > 0 && sorted[k] == sorted[k - 1])
+				continue;
+			probes++;
+			found = ReadEntry(EntryName(dir, key - Mix((unsigned)sorted[k])), entry) &&
+				SameSizes(entry, m, sorted, (int)k);
+			if (found)
+				skip = (int)k;
+		}
+		if (!found)
+			return false;
+	}
+
+	std::vector<long long> load(m, 0);
+	cached.machineOf.assign(size.size(), 0);
+	for (size_t k = 0, e = 0; k < sorted.size(); k++)
+	{
+		if ((int)k == skip)
+			continue;
+		cached.machineOf[order[k]] = entry.machine[e];
+		load[entry.machine[e++]] += sorted[k];
+	}
+	if (skip >= 0)
+	{
+		int least = (int)(std::min_element(load.begin(), load.end()) - load.begin());
+		cached.machineOf[order[skip]] = least;
+		load[least] += sorted[skip];
+	}
+
+	cached.exact = skip < 0;
+	cached.makespan = *std::max_element(load.begin(), load.end());
+	cached.bound = entry.bound;
+	cached.optimal = cached.makespan <= cached.bound;
+	return true;
+}
+
+bool StoreCache(const std::string& dir, const std::vector<int>& size, int m,
+	long long makespan, long long bound, const std::vector<int>& machineOf)
+{
+	std::vector<int> order;
+	SortedOrder(size, order);
+	std::string fname = EntryName(dir, MultisetKey(size, m));
+
+	CacheEntry entry;
+	entry.m = m;
+	entry.makespan = makespan;
+	entry.bound = bound;
+	entry.size.resize(size.size());
+	entry.machine.resize(size.size());
+	for (size_t k = 0; k < order.size(); k++)
+	{
+		entry.size[k] = size[order[k]];
+		entry.machine[k] = machineOf[order[k]];
+	}
+
+	// keep the better half of an existing entry
+	CacheEntry old;
+	if (ReadEntry(fname, old) && SameSizes(old, m, entry.size, -1))
+	{
+		if (old.makespan <= entry.makespan && old.bound >= entry.bound)
+			return true;
+		if (old.makespan < entry.makespan)
+		{
+			entry.makespan = old.makespan;
+			entry.machine = old.machine;
+		}
+		entry.bound = std::max(entry.bound, old.bound);
+	}
+	return WriteEntry(fname, entry);
+}
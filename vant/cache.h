@@ -0,0 +1,43 @@
+/****************************************************************************
+* Persistent cache of solved instances
+*
+* An entry is keyed by the number of machines and the multiset of the job
+* sizes, so a re-submitted instance hits it whatever the order of its jobs.
+* The key is a sum of mixed hashes of the sizes: the key of the instance
+* with one job less is derived in O(1), which is how the entries of close
+* instances are found. Entries are one file per key in the cache directory,
+* holding the sizes in increasing order with the machine of each, the best
+* makespan and the best proven bound.
+*
+*****************************************************************************/
+
+#ifndef __CACHE_H__
+#define __CACHE_H__
+
+#include <string>
+#include <vector>
+
+struct CachedSolution
+{
+	bool exact;                 // same multiset, else one job was added since
+	bool optimal;               // the makespan is proven optimal
+	long long makespan;         // of machineOf
+	long long bound;            // valid lower bound for the current instance
+	std::vector<int> machineOf; // in the job order of the current instance
+};
+
+// Look up the instance, then the instances with one job less. The schedule
+// returned is remapped to the current job order; the job missing from a
+// close entry is put on the least loaded machine.
+// @return false if nothing applies to this instance
+bool LookupCache(const std::string& dir, const std::vector<int>& size, int m,
+	CachedSolution& cached);
+
+// Record a schedule and a lower bound, keeping the best of the new and the
+// cached makespans and bounds. The entry is replaced atomically, so
+// concurrent solves of the same instance leave a valid file.
+// @return false if the entry could not be written
+bool StoreCache(const std::string& dir, const std::vector<int>& size, int m,
+	long long makespan, long long bound, const std::vector<int>& machineOf);
+
+#endif
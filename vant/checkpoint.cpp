@@ -0,0 +1,143 @@
+#include "checkpoint.h"
+#include "sysutil.h"
+
+#include <algorithm>
+#include <chrono>
+#include <signal.h>
+#include <stdio.h>
+
+// Milliseconds between two looks at the run and the signals
+static const int PollMillis = 100;
+
+typedef void (*SignalHandler)(int);
+
+// Signal caught while a writer is watching, 0 for none
+static volatile sig_atomic_t caughtSignal = 0;
+static SignalHandler previousTerm, previousInt;
+
+// Only flag the signal; a second one gets the default action
+static void OnSignal(int sig)
+{
+	caughtSignal = sig;
+	signal(sig, SIG_DFL);
+}
+
+bool ReadCheckpoint(const char* fname, const std::vector<int>& size, int m,
+	CheckpointState& state)
+{
+	FILE* fin = fopen(fname, "r");
+	if (fin == NULL)
+		return false;
+
+	int version, fileM, n;
+	bool ok = fscanf(fin, "vant-checkpoint %d %d %d %lld %lld %lf", &version, &fileM,
+		&n, &state.makespan, &state.bound, &state.seconds) == 6 && version == 1 &&
+		fileM == m && n == (int)size.size();
+	std::vector<long long> load(m, 0);
+	state.machineOf.resize(size.size());
+	for (int j = 0; ok && j < n; j++)
+	{
+		int jobSize;
+		ok = fscanf(fin, "%d %d", &jobSize, &state.machineOf[j]) == 2 &&
+			jobSize == size[j] && state.machineOf[j] >= 0 && state.machineOf[j] < m;
+		if (ok)
+			load[state.machineOf[j]] += jobSize;
+	}
+	fclose(fin);
+	if (!ok)
+		return false;
+
+	state.makespan = *std::max_element(load.begin(), load.end());
+	state.bound = std::min(state.bound, state.makespan);
+	return true;
+}
+
+CheckpointWriter::CheckpointWriter(const char* fname, double interval,
+	const std::vector<int>& size, int m, double seconds, SharedSearch& run) :
+	fname(fname), interval(interval), seconds(seconds), size(size), m(m), run(run),
+	writtenMakespan(-1), writtenBound(-1), interrupted(false), done(false)
+{
+	start = last = WallClock();
+	caughtSignal = 0;
+	previousTerm = signal(SIGTERM, OnSignal);
+	previousInt = signal(SIGINT, OnSignal);
+	thread = std::thread(&CheckpointWriter::Watch, this);
+}
+
+CheckpointWriter::~CheckpointWriter()
+{
+	if (thread.joinable())
+		Finish();
+}
+
+bool CheckpointWriter::Finish()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		done = true;
+	}
+	wake.notify_all();
+	thread.join();
+	signal(SIGTERM, previousTerm);
+	signal(SIGINT, previousInt);
+	return Write();
+}
+
+void CheckpointWriter::Watch()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	while (!done)
+	{
+		wake.wait_for(lock, std::chrono::milliseconds(PollMillis));
+		if (done)
+			break;
+
+		// write first: the scheduler may not wait for the engines to stop
+		if (caughtSignal != 0 && !interrupted)
+		{
+			interrupted = true;
+			run.stop = true;
+			bool written = Write();
+			printf("\nSignal %d: %s the checkpoint %s, stopping\n", (int)caughtSignal,
+				written ? "wrote" : "could not write", fname.c_str());
+			fflush(stdout);
+		}
+		else if (WallClock() - last >= interval &&
+			(run.incumbent.Value() != writtenMakespan || run.bound.load() != writtenBound))
+			Write();
+	}
+}
+
+// Write to a file of this process, then move it over the checkpoint
+bool CheckpointWriter::Write()
+{
+	std::vector<int> machineOf;
+	long long bound = run.bound.load();
+	long long makespan = run.incumbent.Best(machineOf);
+	last = WallClock();
+	if (makespan < 0 || machineOf.size() != size.size())
+		return false;
+
+	char suffix[32];
+	sprintf(suffix, ".%d.tmp", ProcessId());
+	std::string temp = fname + suffix;
+	FILE* fout = fopen(temp.c_str(), "w");
+	if (fout == NULL)
+		return false;
+	fprintf(fout, "vant-checkpoint 1 %d %d %lld %lld %.3f\n", m, (int)size.size(),
+		makespan, std::min(bound, makespan), seconds + last - start);
+	for (size_t j = 0; j < size.size(); j++)
+		fprintf(fout, "%d %d\n", size[j], machineOf[j]);
+	bool ok = ferror(fout) == 0;
+	ok = fclose(fout) == 0 && ok;
+	if (ok)
+		ok = RenameReplacing(temp.c_str(), fname.c_str());
+	if (!ok)
+		remove(temp.c_str());
+	else
+	{
+		writtenMakespan = makespan;
+		writtenBound = bound;
+	}
+	return ok;
+}
@@ -0,0 +1,76 @@
+/****************************************************************************
+* Checkpoints of long runs
+*
+* The best schedule and the best proven bound of a run are written to a
+* file when they improve, at most every few seconds, and at once when the
+* process gets SIGTERM or SIGINT. The signal also sets the stop flag of the
+* run, so the engines that watch it return their best schedule as after the
+* time limit; a second signal terminates the process. A later run of the
+* same instance resumes from the file: its schedule seeds the incumbent and
+* the cutoff, and its bound the lower bound.
+* The file holds the size and the machine of every job in the order of the
+* instance, so a checkpoint of another instance is never resumed from, and
+* the makespan is recomputed from the loads when it is read.
+*
+*****************************************************************************/
+
+#ifndef __CHECKPOINT_H__
+#define __CHECKPOINT_H__
+
+#include "portfolio.h"
+
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct CheckpointState
+{
+	long long makespan;         // of machineOf
+	long long bound;            // best proven lower bound
+	double seconds;             // spent by the runs that wrote it
+	std::vector<int> machineOf;
+};
+
+// Read the checkpoint of an instance.
+// @return false if the file is missing, malformed or of another instance
+bool ReadCheckpoint(const char* fname, const std::vector<int>& size, int m,
+	CheckpointState& state);
+
+// Writes the best schedule and bound of a run from a thread of its own
+class CheckpointWriter
+{
+public:
+	// Start watching run, catching SIGTERM and SIGINT until Finish.
+	// @param interval  seconds between two writes at least
+	// @param seconds   spent by the runs resumed from
+	CheckpointWriter(const char* fname, double interval,
+		const std::vector<int>& size, int m, double seconds, SharedSearch& run);
+	~CheckpointWriter();
+
+	// Stop watching and write the final state of the run.
+	// @return false if the file could not be written
+	bool Finish();
+
+	// A signal stopped the run
+	bool Interrupted() const { return interrupted; }
+
+private:
+	void Watch();
+	bool Write();
+
+	std::string fname;
+	double interval, seconds, start, last;
+	std::vector<int> size;
+	int m;
+	SharedSearch& run;
+	long long writtenMakespan, writtenBound;
+	bool interrupted, done;
+
+	std::thread thread;
+	std::mutex mutex;
+	std::condition_variable wake;
+};
+
+#endif
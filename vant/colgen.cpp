@@ -0,0 +1,438 @@
+#include "colgen.h"
+#include "modelbuilder.h"
+#include "solver.h"
+#include "heuristics.h"
+#include "knapsack.h"
+#include "portfolio.h"
+#include "runstats.h"
+#include "sysutil.h"
+
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <set>
+#include <math.h>
+#include <stdio.h>
+
+// Job sizes merged by value, largest first
+struct SizeTypes
+{
+	std::vector<int> size, count;
+	std::vector<std::vector<int> > jobs;
+};
+
+// Copies of each size type on one machine
+typedef std::vector<int> Pattern;
+
+// Columns of all capacities seen so far, without duplicates
+struct PatternPool
+{
+	std::vector<Pattern> patterns;
+	std::set<Pattern> known;
+
+	bool Add(const Pattern& p)
+	{
+		if (!known.insert(p).second)
+			return false;
+		patterns.push_back(p);
+		return true;
+	}
+};
+
+static const double Eps = 1e-6;
+
+static long long PatternWeight(const Pattern& p, const std::vector<int>& size)
+{
+	long long w = 0;
+	for (size_t t = 0; t < p.size(); t++)
+		w += (long long)p[t] * size[t];
+	return w;
+}
+
+// Starting columns for capacity C: the largest single-size patterns and the
+// bins of first fit decreasing, so the master is always feasible.
+static void SeedPatterns(const SizeTypes& types, const std::vector<int>& count,
+	int C, PatternPool& pool)
+{
+	int ntypes = (int)types.size.size();
+	for (int t = 0; t < ntypes; t++)
+	{
+		if (count[t] == 0)
+			continue;
+		Pattern p(ntypes, 0);
+		p[t] = std::min(count[t], C / types.size[t]);
+		pool.Add(p);
+	}
+
+	std::vector<Pattern> bins;
+	std::vector<int> room;
+	for (int t = 0; t < ntypes; t++)
+		for (int c = 0; c < count[t]; c++)
+		{
+			size_t b = 0;
+			while (b < bins.size() && room[b] < types.size[t])
+				b++;
+			if (b == bins.size())
+			{
+				bins.push_back(Pattern(ntypes, 0));
+				room.push_back(C);
+			}
+			bins[b][t]++;
+			room[b] -= types.size[t];
+		}
+	for (size_t b = 0; b < bins.size(); b++)
+		pool.Add(bins[b]);
+}
+
+// The pattern of weight at most C with the largest total dual value
+// @return its value, or -1 if the knapsack tables would be too large
+static double PricePattern(const SizeTypes& types, const std::vector<int>& count,
+	const std::vector<double>& y, int C, Pattern& best)
+{
+	BoundedKnapsack knapsack;
+	if (!knapsack.Solve(types.size, count, y, C, Eps))
+		return -1;
+	knapsack.Pattern(C, best);
+	return knapsack.Value(C);
+}
+
+// Restricted master for capacity C over the pool patterns that fit in it:
+// minimize the number of patterns covering count[t] jobs of every size.
+static SolverBackend* BuildMaster(const SizeTypes& types,
+	const std::vector<int>& count, int m, int C, const PatternPool& pool,
+	const EngineSettings& settings, std::vector<int>& columns)
+{
+	PhaseTimer buildTimer(settings.stats, Phase_Build);
+	int ntypes = (int)types.size.size();
+
+	columns.clear();
+	for (size_t k = 0; k < pool.patterns.size(); k++)
+		if (PatternWeight(pool.patterns[k], types.size) <= C)
+			columns.push_back((int)k);
+
+	ModelBuilder model(UFFLP_Minimize);
+	int first = model.AddVariableBlock("lambda", (int)columns.size(), 0, 0.0, m,
+		1.0, UFFLP_Continuous);
+	model.BeginConstraintBlock("cover");
+	for (int t = 0; t < ntypes; t++)
+	{
+		for (size_t k = 0; k < columns.size(); k++)
+		{
+			int copies = std::min(count[t], pool.patterns[columns[k]][t]);
+			if (copies > 0)
+				model.AddCoefficient(first + (int)k, copies);
+		}
+		model.EndRow(count[t], UFFLP_Greater);
+	}
+
+	SolverBackend* solver = CreateSolver(settings.solver);
+	if (solver == NULL)
+		return NULL;
+	solver->LoadModel(model);
+	if (settings.shared != NULL)
+		solver->SetStopFlag(&settings.shared->stop);
+	solver->SetSolverParameter(SolverParam_Threads, settings.threads);
+	if (settings.stats != NULL)
+		settings.stats->RecordModel(model);
+	return solver;
+}
+
+// Price columns into the master until its LP is solved.
+// @param stopAtM  stop as soon as the LP fits m machines
+// @return 1 if the LP fits m machines, 0 if it cannot, -1 if undecided
+static int GenerateColumns(SolverBackend* solver, const SizeTypes& types,
+	const std::vector<int>& count, int m, int C, PatternPool& pool,
+	std::vector<int>& columns, bool stopAtM, double deadline, FILE* log)
+{
+	int ntypes = (int)types.size.size();
+	std::vector<double> y(ntypes);
+	std::vector<int> rows;
+	std::vector<double> vals;
+	Pattern p;
+	int added = 0;
+
+	for (;;)
+	{
+		double remaining = deadline - WallClock();
+		if (remaining <= 0)
+			return -1;
+		solver->SetParameter(UFFLP_TimeLimit, remaining);
+		if (solver->Solve() != UFFLP_Optimal)
+			return -1;
+
+		double z;
+		solver->GetObjValue(&z);
+		if (stopAtM && z <= m + Eps)
+			return 1;
+
+		// covering rows of a minimization: the duals are non-negative
+		for (int t = 0; t < ntypes; t++)
+		{
+			y[t] = 0.0;
+			solver->GetDualSolution(t, &y[t]);
+		}
+		double v = PricePattern(types, count, y, C, p);
+		if (v < 0)
+			return -1;
+
+		// Farley's bound: no solution uses fewer than z / v patterns
+		bool converged = v <= 1 + Eps;
+		if (converged || z / v > m + Eps)
+		{
+			if (log != NULL)
+				fprintf(log, "Column generation C=%d: %d columns (%d priced), LP %.6f%s\n",
+					C, (int)columns.size(), added, z, converged ? "" : ", stopped by Farley's bound");
+			if (converged)
+				return z <= m + Eps ? 1 : 0;
+			return 0;
+		}
+
+		rows.clear();
+		vals.clear();
+		for (int t = 0; t < ntypes; t++)
+			if (p[t] > 0)
+			{
+				rows.push_back(t);
+				vals.push_back(p[t]);
+			}
+		if (!pool.Add(p) ||
+			solver->AddColumn(0.0, m, 1.0, UFFLP_Continuous, (int)rows.size(),
+				&rows[0], &vals[0]) != UFFLP_Ok)
+			return -1;   // a pattern already present priced out: numerical trouble
+		columns.push_back((int)pool.patterns.size() - 1);
+		added++;
+	}
+}
+
+// Give each machine the jobs of its pattern.
+static void AssignPatterns(const SizeTypes& types,
+	const std::vector<Pattern>& machines, std::vector<int>& machineOf)
+{
+	std::vector<std::vector<int> > jobs(types.jobs);
+	for (size_t i = 0; i < machines.size(); i++)
+		for (size_t t = 0; t < machines[i].size(); t++)
+			for (int q = 0; q < machines[i][t] && !jobs[t].empty(); q++)
+			{
+				machineOf[jobs[t].back()] = (int)i;
+				jobs[t].pop_back();
+			}
+}
+
+// Solve the restricted master with integer variables.
+// @return 1 if at most m patterns cover all jobs, 0 if they cannot, -1 if
+//         the solver gave up
+static int SolveIntegerMaster(SolverBackend* solver, int m,
+	const PatternPool& pool, const std::vector<int>& columns, double deadline,
+	std::vector<Pattern>& machines)
+{
+	for (size_t k = 0; k < columns.size(); k++)
+		solver->ChangeVariableType((int)k, UFFLP_Integer);
+	solver->SetParameter(UFFLP_CutoffValue, m + 0.5);
+	solver->SetParameter(UFFLP_TimeLimit, std::max(0.0, deadline - WallClock()));
+	// any cover with at most m patterns will do
+	solver->SetSolverParameter(SolverParam_RelativeGap, 1.0);
+
+	UFFLP_StatusType status = solver->Solve();
+	double z = m + 1.0;
+	if (status == UFFLP_Optimal || status == UFFLP_Feasible)
+		solver->GetObjValue(&z);
+	if (z > m + Eps)
+		return status == UFFLP_Infeasible || status == UFFLP_Optimal ? 0 : -1;
+
+	machines.clear();
+	std::vector<double> x(columns.size());
+	solver->GetSolutions(0, (int)x.size(), &x[0]);
+	for (size_t k = 0; k < columns.size(); k++)
+		for (int c = (int)floor(x[k] + 0.5); c > 0; c--)
+			machines.push_back(pool.patterns[columns[k]]);
+	return 1;
+}
+
+// Diving: fix copies of the pattern with the largest LP value, then price
+// the remaining jobs again, until all jobs are placed or m machines are used.
+// @return 1 if the dive placed all jobs, 0 if it failed, -1 if out of time
+static int DiveMaster(const SizeTypes& types, int m, int C, PatternPool& pool,
+	const EngineSettings& settings, double deadline,
+	std::vector<Pattern>& machines)
+{
+	int ntypes = (int)types.size.size();
+	std::vector<int> count(types.count), columns;
+	int left = m;
+
+	machines.clear();
+	for (;;)
+	{
+		int jobs = 0;
+		for (int t = 0; t < ntypes; t++)
+			jobs += count[t];
+		if (jobs == 0)
+			return 1;
+		if (left == 0)
+			return 0;
+
+		SeedPatterns(types, count, C, pool);
+		SolverBackend* solver = BuildMaster(types, count, left, C, pool, settings,
+			columns);
+		if (solver == NULL)
+			return -1;
+		PhaseTimer solveTimer(settings.stats, Phase_Solve);
+		int res = GenerateColumns(solver, types, count, left, C, pool, columns,
+			false, deadline, NULL);
+		solveTimer.Stop();
+		if (res <= 0)
+		{
+			delete solver;
+			return res;
+		}
+
+		size_t best = 0;
+		double bestValue = -1.0;
+		std::vector<double> x(columns.size());
+		solver->GetSolutions(0, (int)x.size(), &x[0]);
+		for (size_t k = 0; k < columns.size(); k++)
+		{
+			double v = x[k];
+			if (v > bestValue)
+			{
+				best = k;
+				bestValue = v;
+			}
+		}
+		delete solver;
+
+		Pattern p(pool.patterns[columns[best]]);
+		for (int t = 0; t < ntypes; t++)
+			p[t] = std::min(p[t], count[t]);
+		int copies = std::max(1, (int)floor(bestValue + Eps));
+		for (int c = 0; c < copies && left > 0; c++, left--)
+		{
+			machines.push_back(p);
+			for (int t = 0; t < ntypes; t++)
+				count[t] = std::max(0, count[t] - p[t]);
+		}
+	}
+}
+
+UFFLP_StatusType SolveColumnGeneration(const std::vector<int>& jobSize, int m,
+	const EngineSettings& settings, long long lowerBound,
+	long long& makespan, std::vector<int>& machineOf)
+{
+	double deadline = WallClock() + settings.timeLimit;
+	int n = (int)jobSize.size();
+
+	// merge identical sizes into types, largest first
+	std::map<int, std::vector<int>, std::greater<int> > bySize;
+	long long total = 0;
+	for (int j = 0; j < n; j++)
+	{
+		bySize[jobSize[j]].push_back(j);
+		total += jobSize[j];
+	}
+
+	SizeTypes types;
+	for (std::map<int, std::vector<int>, std::greater<int> >::iterator it = bySize.begin();
+		it != bySize.end(); ++it)
+	{
+		types.size.push_back(it->first);
+		types.count.push_back((int)it->second.size());
+		types.jobs.push_back(it->second);
+	}
+	if (settings.log != NULL)
+		fprintf(settings.log, "Column generation: %d jobs merged into %d sizes\n",
+			n, (int)types.size.size());
+
+	long long lo = std::max<long long>(types.size.empty() ? 0 : types.size[0],
+		(total + m - 1) / m);
+	lo = std::max(lo, lowerBound);
+	long long hi = makespan;
+
+	// smallest capacity whose LP relaxation fits m machines; the starting
+	// schedule already fits hi
+	PatternPool pool;
+	std::vector<int> columns;
+	while (lo < hi)
+	{
+		if (settings.shared != NULL)
+		{
+			settings.shared->Tighten(lo, makespan, machineOf);
+			hi = std::min(hi, makespan);
+			if (lo >= hi)
+				break;
+		}
+		int C = (int)((lo + hi) / 2);
+		SeedPatterns(types, types.count, C, pool);
+		SolverBackend* solver = BuildMaster(types, types.count, m, C, pool,
+			settings, columns);
+		if (solver == NULL)
+			return UFFLP_Feasible;
+		PhaseTimer solveTimer(settings.stats, Phase_Solve);
+		int res = GenerateColumns(solver, types, types.count, m, C, pool, columns,
+			true, deadline, settings.log);
+		solveTimer.Stop();
+		delete solver;
+		if (res < 0)
+			return UFFLP_Feasible;
+		if (res > 0)
+			hi = C;
+		else
+			lo = C + 1;
+	}
+	long long lpBound = lo;
+	if (settings.shared != NULL)
+		settings.shared->RaiseBound(settings.member, lpBound);
+	if (settings.log != NULL)
+		fprintf(settings.log, "Column generation: LP bound %lld, %d columns\n",
+			lpBound, (int)pool.patterns.size());
+	if (lpBound >= makespan)
+		return UFFLP_Optimal;
+
+	// integer master over the generated columns, then a dive, raising C
+	// until one of them fits m machines
+	std::vector<Pattern> machines;
+	for (long long C = lpBound; C < makespan; C++)
+	{
+		if (settings.shared != NULL)
+		{
+			settings.shared->Tighten(lpBound, makespan, machineOf);
+			C = std::max(C, lpBound);
+			if (C >= makespan)
+				break;
+		}
+		SeedPatterns(types, types.count, (int)C, pool);
+		SolverBackend* solver = BuildMaster(types, types.count, m, (int)C, pool,
+			settings, columns);
+		if (solver == NULL)
+			break;
+		PhaseTimer solveTimer(settings.stats, Phase_Solve);
+		int res = GenerateColumns(solver, types, types.count, m, (int)C, pool,
+			columns, false, deadline, settings.log);
+		if (res > 0)
+			res = SolveIntegerMaster(solver, m, pool, columns, deadline, machines);
+		solveTimer.Stop();
+		delete solver;
+		if (res == 0)
+		{
+			if (settings.log != NULL)
+				fprintf(settings.log, "Column generation C=%lld: no integer cover with"
+					" the columns generated, diving\n", C);
+			res = DiveMaster(types, m, (int)C, pool, settings, deadline, machines);
+		}
+		if (res < 0)
+			break;
+		if (res > 0)
+		{
+			std::vector<int> schedule(n, -1);
+			AssignPatterns(types, machines, schedule);
+			long long value = ScheduleMakespan(jobSize, m, schedule);
+			if (value < makespan)
+			{
+				makespan = value;
+				machineOf = schedule;
+				if (settings.shared != NULL)
+					settings.shared->Offer(settings.member, makespan, machineOf);
+			}
+			return makespan <= lpBound ? UFFLP_Optimal : UFFLP_Feasible;
+		}
+	}
+	return makespan <= lpBound ? UFFLP_Optimal : UFFLP_Feasible;
+}
@@ -0,0 +1,35 @@
+/****************************************************************************
+* Column generation for the UAV makespan problem
+*
+* For a capacity C, a column is a pattern: how many jobs of each size fit
+* together on one machine. The master covers every size with patterns and
+* minimizes their number, which must not exceed m. Patterns are priced by a
+* bounded knapsack over the duals of the covering rows. A bisection on C
+* finds the smallest capacity whose LP relaxation fits m machines, a lower
+* bound on the makespan; the integer master is then solved over the columns
+* generated (price-and-branch) from that capacity upwards.
+*
+*****************************************************************************/
+
+#ifndef __COLGEN_H__
+#define __COLGEN_H__
+
+#include "UFFLP.h"
+#include "solver.h"
+
+#include <vector>
+
+// Solve the makespan problem by column generation.
+// @param jobSize     setup + proctime of every job
+// @param lowerBound  known lower bound on the makespan
+// @param makespan    makespan of the starting schedule; the best one found
+//                    on return
+// @param machineOf   machine of every job in the starting schedule; the best
+//                    schedule found on return
+// @return UFFLP_Optimal if the schedule meets the LP bound of the master,
+//         UFFLP_Feasible otherwise
+UFFLP_StatusType SolveColumnGeneration(const std::vector<int>& jobSize, int m,
+	const EngineSettings& settings, long long lowerBound,
+	long long& makespan, std::vector<int>& machineOf);
+
+#endif
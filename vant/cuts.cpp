@@ -0,0 +1,320 @@
+#include "cuts.h"
+#include "models.h"
+#include "solver.h"
+#include "sysutil.h"
+
+#include <algorithm>
+#include <math.h>
+
+// Smallest violation of a cut worth adding
+static const double CutViolation = 1e-4;
+
+// Cuts stay in the LP of every later node: at most this many per machine
+static const long MaxCutsPerMachine = 25;
+
+CutStats::CutStats() : cardinality(0), cover(0), load(0), seconds(0)
+{
+}
+
+CutSeparator::CutSeparator(const std::vector<int>& weight,
+	const std::vector<int>& count, int m, long long upperBound,
+	const CutSettings& settings) : weight(weight), count(count), m(m),
+	settings(settings), capacity(upperBound), limitsFor(-1), round(0),
+	lastBound(0), lastDepth(-1), lastCuts(0)
+{
+	binary = true;
+	for (size_t c = 0; c < count.size(); c++)
+		if (count[c] != 1)
+			binary = false;
+
+	order.resize(weight.size());
+	for (size_t c = 0; c < order.size(); c++)
+		order[c] = (int)c;
+	std::stable_sort(order.begin(), order.end(),
+		[&weight](int a, int b) { return weight[a] > weight[b]; });
+}
+
+void CutSeparator::SetIncumbent(long long makespan)
+{
+	long long current = capacity.load();
+	while (makespan - 1 < current)
+		if (capacity.compare_exchange_weak(current, makespan - 1))
+			return;
+}
+
+void CutSeparator::Callback(SolverBackend* solver, void* data)
+{
+	CutSeparator* separator = (CutSeparator*)data;
+	std::lock_guard<std::mutex> lock(separator->mutex);
+	separator->Separate(solver);
+}
+
+void CutSeparator::Separate(SolverBackend* solver)
+{
+	double start = WallClock();
+	int depth = 0;
+	double bound;
+	if (solver->GetNodeDepth(&depth) != UFFLP_Ok)
+		depth = 0;
+	if (solver->GetObjValue(&bound) != UFFLP_Ok)
+		return;
+
+	// cuts at the last call bring the node back here for another round
+	if (lastCuts > 0 && depth == lastDepth)
+	{
+		stats.rounds[round].gain += bound - lastBound;
+		round++;
+	}
+	else
+		round = 0;
+	lastCuts = 0;
+	lastBound = bound;
+	lastDepth = depth;
+	if (depth > settings.maxDepth || stats.seconds >= settings.timeLimit ||
+		stats.cardinality + stats.cover + stats.load >= MaxCutsPerMachine * m)
+		return;
+
+	std::vector<double> x(1 + m * weight.size());
+	if (weight.empty() || solver->GetSolutions(0, (int)x.size(), &x[0]) != UFFLP_Ok)
+		return;
+
+	int cuts = SeparateCardinality(solver, x) + SeparateLoad(solver, x);
+	if (binary)
+		cuts += SeparateCover(solver, x);
+
+	if ((int)stats.rounds.size() <= round)
+		stats.rounds.resize(round + 1, CutRound());
+	stats.rounds[round].calls++;
+	stats.rounds[round].cuts += cuts;
+	lastCuts = cuts;
+	stats.seconds += WallClock() - start;
+}
+
+bool CutSeparator::AddCut(SolverBackend* solver, int machine,
+	const std::vector<int>& cols, double rhs, const std::vector<double>& x)
+{
+	int width = (int)weight.size();
+	double lhs = 0;
+	std::vector<int> index(cols.size());
+	std::vector<double> ones(cols.size(), 1.0);
+	for (size_t k = 0; k < cols.size(); k++)
+	{
+		lhs += x[1 + machine * width + cols[k]];
+		index[k] = 1 + machine * width + cols[k];
+	}
+	if (lhs <= rhs + CutViolation)
+		return false;
+	return solver->AddConstraint((int)index.size(), &index[0], &ones[0], rhs,
+		UFFLP_Less) == UFFLP_Ok;
+}
+
+int CutSeparator::SeparateCardinality(SolverBackend* solver,
+	const std::vector<double>& x)
+{
+	int width = (int)weight.size();
+	long long C = capacity.load();
+
+	// of the jobs in the r + 1 largest columns, the smallest ones that fit
+	// within C; only the longest prefix with a given limit is kept
+	if (limitsFor != C)
+	{
+		limitsFor = C;
+		prefixEnd.clear();
+		prefixLimit.clear();
+		long long jobs = 0;
+		for (int r = 0; r < width; r++)
+		{
+			jobs += count[order[r]];
+			long long load = 0, fit = 0;
+			for (int k = r; k >= 0 && load <= C; k--)
+			{
+				int c = order[k];
+				long long take = std::min<long long>(count[c],
+					weight[c] > 0 ? (C - load) / weight[c] : count[c]);
+				fit += take;
+				load += take * weight[c];
+				if (take < count[c])
+					break;
+			}
+			if (fit >= jobs)
+				continue;
+			if (!prefixLimit.empty() && prefixLimit.back() == fit)
+				prefixEnd.back() = r;
+			else
+			{
+				prefixEnd.push_back(r);
+				prefixLimit.push_back(fit);
+			}
+		}
+	}
+
+	// the most violated prefix of every machine
+	int cuts = 0;
+	std::vector<int> cols;
+	for (int i = 0; i < m; i++)
+	{
+		double sum = 0, worst = CutViolation;
+		int best = -1;
+		size_t p = 0;
+		for (int r = 0; r < width && p < prefixEnd.size(); r++)
+		{
+			sum += x[1 + i * width + order[r]];
+			if (r == prefixEnd[p])
+			{
+				if (sum - prefixLimit[p] > worst)
+				{
+					worst = sum - prefixLimit[p];
+					best = (int)p;
+				}
+				p++;
+			}
+		}
+		if (best < 0)
+			continue;
+		cols.assign(order.begin(), order.begin() + prefixEnd[best] + 1);
+		if (AddCut(solver, i, cols, (double)prefixLimit[best], x))
+		{
+			cuts++;
+			stats.cardinality++;
+		}
+	}
+	return cuts;
+}
+
+int CutSeparator::SeparateLoad(SolverBackend* solver,
+	const std::vector<double>& x)
+{
+	int width = (int)weight.size();
+	int cuts = 0;
+	std::vector<int> cols;
+	std::vector<double> vals;
+
+	for (int i = 0; i < m; i++)
+	{
+		// with q jobs of the r + 1 largest columns, the load is at least the
+		// total f(q) of the q smallest of them; f is convex, so it lies above
+		// its secant f(t) + d (q - t) between t and t + 1
+		double q = 0, worst = CutViolation;
+		long long jobs = 0, bestF = 0, bestD = 0;
+		int bestR = -1, bestT = 0;
+		for (int r = 0; r < width; r++)
+		{
+			q += x[1 + i * width + order[r]];
+			jobs += count[order[r]];
+			int t = (int)floor(q + 1e-9);
+			if (t < 1 || t >= jobs)
+				continue;
+
+			// f(t) and the (t + 1)-th smallest job d
+			long long f = 0, d = -1;
+			int taken = 0;
+			for (int k = r; k >= 0 && d < 0; k--)
+				for (int copy = 0; copy < count[order[k]] && d < 0; copy++)
+				{
+					if (taken++ < t)
+						f += weight[order[k]];
+					else
+						d = weight[order[k]];
+				}
+			double violation = f + d * (q - t) - x[CmaxColumn];
+			if (violation > worst)
+			{
+				worst = violation;
+				bestR = r;
+				bestT = t;
+				bestF = f;
+				bestD = d;
+			}
+		}
+		if (bestR < 0)
+			continue;
+
+		// C_max - d sum x_i_j >= f(t) - d t over the r + 1 largest columns
+		cols.assign(1, CmaxColumn);
+		vals.assign(1, 1.0);
+		for (int r = 0; r <= bestR; r++)
+		{
+			cols.push_back(1 + i * width + order[r]);
+			vals.push_back(-(double)bestD);
+		}
+		if (solver->AddConstraint((int)cols.size(), &cols[0], &vals[0],
+			(double)(bestF - bestD * bestT), UFFLP_Greater) == UFFLP_Ok)
+		{
+			cuts++;
+			stats.load++;
+		}
+	}
+	return cuts;
+}
+
+int CutSeparator::SeparateCover(SolverBackend* solver,
+	const std::vector<double>& x)
+{
+	int width = (int)weight.size();
+	long long C = capacity.load();
+	int cuts = 0;
+	std::vector<int> cand, cover, cols;
+	std::vector<char> inCover(width);
+
+	for (int i = 0; i < m; i++)
+	{
+		const double* xi = &x[1 + i * width];
+
+		// greedy cover: the columns closest to one per unit of weight first
+		cand.clear();
+		for (int c = 0; c < width; c++)
+			if (xi[c] > 1e-6 && weight[c] > 0)
+				cand.push_back(c);
+		std::sort(cand.begin(), cand.end(), [&](int a, int b)
+		{
+			return (1 - xi[a]) * weight[b] < (1 - xi[b]) * weight[a];
+		});
+		cover.clear();
+		long long load = 0;
+		for (size_t k = 0; k < cand.size() && load <= C; k++)
+		{
+			cover.push_back(cand[k]);
+			load += weight[cand[k]];
+		}
+		if (load <= C)
+			continue;
+
+		// drop the columns of least value while it still exceeds C
+		std::sort(cover.begin(), cover.end(),
+			[&](int a, int b) { return xi[a] < xi[b]; });
+		std::vector<int> kept;
+		for (size_t k = 0; k < cover.size(); k++)
+			if (load - weight[cover[k]] > C)
+				load -= weight[cover[k]];
+			else
+				kept.push_back(cover[k]);
+
+		// extend with every column at least as heavy as the cover
+		int heaviest = 0;
+		std::fill(inCover.begin(), inCover.end(), 0);
+		for (size_t k = 0; k < kept.size(); k++)
+		{
+			heaviest = std::max(heaviest, weight[kept[k]]);
+			inCover[kept[k]] = 1;
+		}
+		cols = kept;
+		for (int c = 0; c < width; c++)
+			if (!inCover[c] && weight[c] >= heaviest)
+				cols.push_back(c);
+		if (AddCut(solver, i, cols, (double)kept.size() - 1, x))
+		{
+			cuts++;
+			stats.cover++;
+		}
+	}
+	return cuts;
+}
+
+void CutSeparator::PrintStats(FILE* out) const
+{
+	fprintf(out, "Cuts: %ld cardinality, %ld cover, %ld load in %.3f s\n",
+		stats.cardinality, stats.cover, stats.load, stats.seconds);
+	for (size_t r = 0; r < stats.rounds.size(); r++)
+		fprintf(out, "  round %d: %ld separations, %ld cuts, bound gain %.3f\n",
+			(int)r, stats.rounds[r].calls, stats.rounds[r].cuts, stats.rounds[r].gain);
+}
@@ -0,0 +1,104 @@
+/****************************************************************************
+* Cut separation for the load rows of the assignment models
+*
+* restr2_i is a knapsack row whose capacity is C_max. Only schedules better
+* than the incumbent matter, so the capacity is taken as the incumbent
+* makespan minus one (the starting makespan before the solver has one).
+* Three families of cuts are separated on every machine:
+* - cardinality: of the r largest jobs, any k_r + 1 exceed the capacity,
+*   so at most k_r of them share a machine;
+* - lifted cover: a set S of jobs exceeding the capacity, extended with the
+*   jobs at least as large as the largest of S, has at most |S| - 1 jobs on
+*   a machine (binary model only);
+* - load: with q of the r largest jobs, a machine carries at least the q
+*   smallest of them, which bounds C_max from below by the secants of that
+*   convex function of q. These hold for every schedule.
+* The separation runs down to a node depth, within a time budget and up to
+* a number of cuts, since they stay in the LP of every later node. It counts
+* the cuts and the gain of the LP bound after every round.
+*
+*****************************************************************************/
+
+#ifndef __CUTS_H__
+#define __CUTS_H__
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <stdio.h>
+
+class SolverBackend;
+
+struct CutSettings
+{
+	int maxDepth;       // deepest node separated, 0 for the root only
+	double timeLimit;   // seconds of separation over the whole solve
+};
+
+// Separations of the k-th round at a node, k = 0 when the node is entered
+struct CutRound
+{
+	long calls;
+	long cuts;
+	double gain;        // increase of the LP bound after the round
+};
+
+struct CutStats
+{
+	CutStats();
+
+	long cardinality, cover, load;
+	double seconds;
+	std::vector<CutRound> rounds;
+};
+
+class CutSeparator
+{
+public:
+	// @param weight  size of the job or job type behind the k-th column of a
+	//                machine, whose columns start at 1 + i * weight.size()
+	// @param count   jobs of every column: 1 in the binary model
+	// @param upperBound  makespan of the starting schedule
+	CutSeparator(const std::vector<int>& weight, const std::vector<int>& count,
+		int m, long long upperBound, const CutSettings& settings);
+
+	// Makespan of the incumbent of the solver, from a heuristic callback
+	void SetIncumbent(long long makespan);
+
+	// Cut callback; data is the separator
+	static void Callback(SolverBackend* solver, void* data);
+
+	// Counts of the cuts and the gain of every round
+	void PrintStats(FILE* out) const;
+
+	CutStats stats;
+
+private:
+	void Separate(SolverBackend* solver);
+	int SeparateCardinality(SolverBackend* solver, const std::vector<double>& x);
+	int SeparateLoad(SolverBackend* solver, const std::vector<double>& x);
+	int SeparateCover(SolverBackend* solver, const std::vector<double>& x);
+	bool AddCut(SolverBackend* solver, int machine, const std::vector<int>& cols,
+		double rhs, const std::vector<double>& x);
+
+	std::vector<int> weight, count;
+	std::vector<int> order;         // columns by non-increasing weight
+	bool binary;
+	int m;
+	CutSettings settings;
+	std::atomic<long long> capacity;
+
+	// cardinality cuts for the capacity limitsFor: at most prefixLimit[p]
+	// jobs of the columns order[0 .. prefixEnd[p]] on a machine
+	long long limitsFor;
+	std::vector<int> prefixEnd;
+	std::vector<long long> prefixLimit;
+
+	// rounds at the current node
+	int round;
+	double lastBound;
+	int lastDepth, lastCuts;
+	std::mutex mutex;
+};
+
+#endif
@@ -0,0 +1,747 @@
+#include "daemon.h"
+#include "bounds.h"
+#include "instance.h"
+#include "localsearch.h"
+#include "modelbuilder.h"
+#include "models.h"
+#include "options.h"
+#include "solve.h"
+#include "solver.h"
+#include "sysutil.h"
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#pragma comment(lib, "ws2_32.lib")
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+typedef int SOCKET;
+#define INVALID_SOCKET (-1)
+#define closesocket close
+#endif
+
+// Share of the budget given to the local search when no job is fixed
+static const double SearchShare = 0.3;
+
+struct PlanResult
+{
+	long long makespan;
+	long long bound;
+	bool optimal;       // the makespan meets the bound
+	int moved;          // planned jobs that changed machine
+};
+
+// Schedule handed once to the MIP of a re-plan
+struct DaemonWarmStart
+{
+	std::vector<int> cols;
+	std::vector<double> values;
+	bool sent;
+};
+
+static void DaemonWarmStartCallback(SolverBackend* solver, void* data)
+{
+	DaemonWarmStart* warm = (DaemonWarmStart*)data;
+	if (warm->sent)
+		return;
+	warm->sent = true;
+	for (size_t k = 0; k < warm->cols.size(); k++)
+		solver->SetSolution(warm->cols[k], warm->values[k]);
+}
+
+// The job set of the session, its schedule and the live model
+class Planner
+{
+public:
+	Planner(const DaemonOptions& opts);
+	~Planner() { delete solver; }
+
+	bool Ready() const { return solver != NULL; }
+
+	// Changes of the job set.
+	// @return an error message, NULL if the change was applied
+	const char* Add(int id, int proctime, int setup);
+	const char* Remove(int id);
+	const char* Fix(int id, int machine);   // -1 releases the job
+
+	// Smallest id above all the ids in use
+	int NextId() const { return jobs.empty() ? 0 : jobs.rbegin()->first + 1; }
+	int NumJobs() const { return (int)jobs.size(); }
+
+	// Place the new jobs and improve the schedule within the budget
+	void Replan(PlanResult& result);
+
+	// Machine of every job, by increasing id
+	void Schedule(std::vector<std::pair<int, int> >& assignment) const;
+
+private:
+	struct Job
+	{
+		int type;
+		int machine;    // -1 until the next re-plan places it
+		int fixed;      // machine the job is fixed to, -1 if free
+	};
+
+	struct Type
+	{
+		int size;
+		int count;                  // jobs of the type
+		int firstCol;               // y_0_t .. y_(m-1)_t, then z_t
+		std::vector<int> fixedOn;   // fixed jobs on every machine
+	};
+
+	int TypeOf(int proctime, int setup);
+	void UpdateBounds(int t);
+	bool ExpandCounts(const std::vector<double>& x, const std::vector<Job*>& dense,
+		std::vector<int>& machineOf) const;
+	void Stabilize(const std::vector<Job*>& dense, const std::vector<int>& before,
+		std::vector<int>& machineOf) const;
+
+	const DaemonOptions& opts;
+	int m;
+	SolverBackend* solver;
+	std::map<int, Job> jobs;
+	std::vector<Type> types;
+	std::map<std::pair<int, int>, int> typeIndex;
+	int ncols;
+	int nfixed;
+	unsigned replans;
+};
+
+// The model starts with C_max and the load rows restr2_i only
+Planner::Planner(const DaemonOptions& opts) : opts(opts), m(opts.machines),
+	ncols(1), nfixed(0), replans(0)
+{
+	ModelBuilder model;
+	model.AddVariable("C_max", 0.0, UFFLP_Infinity, 1.0, UFFLP_Integer);
+	model.BeginConstraintBlock("restr2");
+	for (int i = 0; i < m; i++)
+	{
+		model.AddCoefficient(CmaxColumn, -1);
+		model.EndRow(0, UFFLP_Less);
+	}
+
+	solver = CreateSolver(opts.solve.solver.c_str());
+	if (solver == NULL)
+		return;
+	solver->LoadModel(model);
+	solver->SetLogInfo("vant-daemon.log", 1);
+	solver->SetSolverParameter(SolverParam_Threads, opts.solve.threads);
+	solver->SetSolverParameter(SolverParam_RelativeGap, 1e-8);
+}
+
+// A new type appends y_i_t with its size in every load row, z_t and the
+// row sum_i y_i_t - z_t = 0
+int Planner::TypeOf(int proctime, int setup)
+{
+	std::pair<int, int> key(proctime, setup);
+	std::map<std::pair<int, int>, int>::iterator it = typeIndex.find(key);
+	if (it != typeIndex.end())
+		return it->second;
+
+	Type type;
+	type.size = proctime + setup;
+	type.count = 0;
+	type.firstCol = ncols;
+	type.fixedOn.assign(m, 0);
+
+	std::vector<int> cols;
+	std::vector<double> vals;
+	double size = (double)type.size;
+	for (int i = 0; i < m; i++)
+	{
+		solver->AddColumn(0.0, 0.0, 0.0, UFFLP_Integer, 1, &i, &size);
+		cols.push_back(ncols++);
+		vals.push_back(1.0);
+	}
+	solver->AddColumn(0.0, 0.0, 0.0, UFFLP_Integer, 0, NULL, NULL);
+	cols.push_back(ncols++);
+	vals.push_back(-1.0);
+	solver->AddConstraint((int)cols.size(), &cols[0], &vals[0], 0.0, UFFLP_Equal);
+
+	types.push_back(type);
+	typeIndex[key] = (int)types.size() - 1;
+	return (int)types.size() - 1;
+}
+
+void Planner::UpdateBounds(int t)
+{
+	const Type& type = types[t];
+	for (int i = 0; i < m; i++)
+		solver->ChangeBounds(type.firstCol + i, type.fixedOn[i], type.count);
+	solver->ChangeBounds(type.firstCol + m, type.count, type.count);
+}
+
+const char* Planner::Add(int id, int proctime, int setup)
+{
+	if (jobs.count(id) > 0)
+		return "job id already in use";
+	if (proctime < 0 || setup < 0)
+		return "negative time";
+
+	Job job;
+	job.type = TypeOf(proctime, setup);
+	job.machine = -1;
+	job.fixed = -1;
+	jobs[id] = job;
+	types[job.type].count++;
+	UpdateBounds(job.type);
+	return NULL;
+}
+
+const char* Planner::Remove(int id)
+{
+	std::map<int, Job>::iterator it = jobs.find(id);
+	if (it == jobs.end())
+		return "unknown job";
+
+	Type& type = types[it->second.type];
+	if (it->second.fixed >= 0)
+	{
+		type.fixedOn[it->second.fixed]--;
+		nfixed--;
+	}
+	type.count--;
+	UpdateBounds(it->second.type);
+	jobs.erase(it);
+	return NULL;
+}
+
+const char* Planner::Fix(int id, int machine)
+{
+	std::map<int, Job>::iterator it = jobs.find(id);
+	if (it == jobs.end())
+		return "unknown job";
+	if (machine < -1 || machine >= m)
+		return "machine out of range";
+
+	Job& job = it->second;
+	Type& type = types[job.type];
+	if (job.fixed >= 0)
+	{
+		type.fixedOn[job.fixed]--;
+		nfixed--;
+	}
+	if (machine >= 0)
+	{
+		type.fixedOn[machine]++;
+		nfixed++;
+		job.machine = machine;
+	}
+	job.fixed = machine;
+	UpdateBounds(job.type);
+	return NULL;
+}
+
+// Turn the counts y_i_t of a MIP solution into machines, keeping the fixed
+// jobs and then as many jobs as possible where they already are.
+// @return false if the counts do not cover the jobs
+bool Planner::ExpandCounts(const std::vector<double>& x,
+	const std::vector<Job*>& dense, std::vector<int>& machineOf) const
+{
+	std::vector<std::vector<int> > ofType(types.size());
+	for (size_t k = 0; k < dense.size(); k++)
+		ofType[dense[k]->type].push_back((int)k);
+
+	std::vector<int> result(machineOf.size(), -1), need(m);
+	for (size_t t = 0; t < types.size(); t++)
+	{
+		for (int i = 0; i < m; i++)
+			need[i] = (int)floor(x[types[t].firstCol + i] + 0.5);
+
+		std::vector<int> rest;
+		for (size_t k = 0; k < ofType[t].size(); k++)
+		{
+			int j = ofType[t][k];
+			if (dense[j]->fixed >= 0)
+			{
+				result[j] = dense[j]->fixed;
+				need[result[j]]--;
+			}
+		}
+		for (size_t k = 0; k < ofType[t].size(); k++)
+		{
+			int j = ofType[t][k];
+			if (dense[j]->fixed >= 0)
+				continue;
+			if (need[machineOf[j]] > 0)
+			{
+				result[j] = machineOf[j];
+				need[result[j]]--;
+			}
+			else
+				rest.push_back(j);
+		}
+		int i = 0;
+		for (size_t k = 0; k < rest.size(); k++)
+		{
+			while (i < m && need[i] <= 0)
+				i++;
+			if (i == m)
+				return false;
+			result[rest[k]] = i;
+			need[i]--;
+		}
+	}
+	machineOf = result;
+	return true;
+}
+
+// Make a new schedule as close as possible to the one before the re-plan
+// without changing its loads: renumber the machines to keep the most jobs
+// in place when no job is fixed, then exchange jobs of the same type.
+void Planner::Stabilize(const std::vector<Job*>& dense,
+	const std::vector<int>& before, std::vector<int>& machineOf) const
+{
+	int n = (int)machineOf.size();
+	if (nfixed == 0)
+	{
+		// greedy matching of the new machines to the old ones by shared jobs
+		std::vector<std::pair<int, int> > shared;
+		std::vector<int> overlap(m * m, 0);
+		for (int j = 0; j < n; j++)
+			overlap[machineOf[j] * m + before[j]]++;
+		for (int k = 0; k < m * m; k++)
+			if (overlap[k] > 0)
+				shared.push_back(std::make_pair(-overlap[k], k));
+		std::sort(shared.begin(), shared.end());
+
+		std::vector<int> label(m, -1);
+		std::vector<bool> taken(m, false);
+		for (size_t k = 0; k < shared.size(); k++)
+		{
+			int from = shared[k].second / m, to = shared[k].second % m;
+			if (label[from] < 0 && !taken[to])
+			{
+				label[from] = to;
+				taken[to] = true;
+			}
+		}
+		for (int i = 0, free = 0; i < m; i++)
+		{
+			if (label[i] >= 0)
+				continue;
+			while (taken[free])
+				free++;
+			label[i] = free;
+			taken[free] = true;
+		}
+		for (int j = 0; j < n; j++)
+			machineOf[j] = label[machineOf[j]];
+	}
+
+	std::vector<double> x(ncols, 0.0);
+	for (int j = 0; j < n; j++)
+		x[types[dense[j]->type].firstCol + machineOf[j]] += 1.0;
+	std::vector<int> stable(before);
+	if (ExpandCounts(x, dense, stable))
+		machineOf = stable;
+}
+
+void Planner::Replan(PlanResult& result)
+{
+	double start = WallClock();
+	int n = (int)jobs.size();
+	std::vector<Job*> dense;
+	std::vector<int> size, machineOf, previous;
+	dense.reserve(n);
+	for (std::map<int, Job>::iterator it = jobs.begin(); it != jobs.end(); ++it)
+	{
+		dense.push_back(&it->second);
+		size.push_back(types[it->second.type].size);
+		machineOf.push_back(it->second.machine);
+	}
+	previous = machineOf;
+
+	// repair: the new jobs go to the least loaded machine
+	std::vector<long long> load(m, 0), fixedLoad(m, 0);
+	for (int j = 0; j < n; j++)
+	{
+		if (machineOf[j] >= 0)
+			load[machineOf[j]] += size[j];
+		if (dense[j]->fixed >= 0)
+			fixedLoad[dense[j]->fixed] += size[j];
+	}
+	for (int j = 0; j < n; j++)
+	{
+		if (machineOf[j] >= 0)
+			continue;
+		int least = (int)(std::min_element(load.begin(), load.end()) - load.begin());
+		machineOf[j] = least;
+		load[least] += size[j];
+	}
+	long long makespan = n > 0 ? *std::max_element(load.begin(), load.end()) : 0;
+	std::vector<int> repaired(machineOf);
+
+	long long bound = *std::max_element(fixedLoad.begin(), fixedLoad.end());
+	if (n > 0)
+	{
+		MakespanBounds bounds;
+		ComputeMakespanBounds(size, m, bounds);
+		bound = std::max(bound, bounds.lower);
+	}
+
+	// the local search ignores fixed jobs, so it only runs without them
+	if (makespan > bound && nfixed == 0)
+	{
+		SharedSchedule best;
+		LocalSearchSettings settings;
+		settings.threads = opts.solve.threads;
+		settings.timeLimit = opts.budget * SearchShare;
+		settings.seed = opts.solve.seed + replans;
+		settings.lowerBound = bound;
+		settings.stop = NULL;
+		best.Offer(makespan, machineOf);
+		makespan = IteratedLocalSearch(size, m, settings, best);
+		best.Best(machineOf);
+	}
+
+	double remaining = opts.budget - (WallClock() - start);
+	if (makespan > bound && remaining > 1e-3)
+	{
+		DaemonWarmStart warm;
+		std::vector<int> count(types.size() * m, 0);
+		for (int j = 0; j < n; j++)
+			count[dense[j]->type * m + machineOf[j]]++;
+		warm.cols.push_back(CmaxColumn);
+		warm.values.push_back((double)makespan);
+		for (size_t t = 0; t < types.size(); t++)
+		{
+			for (int i = 0; i < m; i++)
+			{
+				warm.cols.push_back(types[t].firstCol + i);
+				warm.values.push_back(count[t * m + i]);
+			}
+			warm.cols.push_back(types[t].firstCol + m);
+			warm.values.push_back(types[t].count);
+		}
+		warm.sent = false;
+
+		solver->SetHeurCallBack(DaemonWarmStartCallback, &warm);
+		solver->SetParameter(UFFLP_CutoffValue, (double)makespan);
+		solver->SetParameter(UFFLP_TimeLimit, remaining);
+		UFFLP_StatusType status = solver->Solve();
+		solver->SetHeurCallBack(NULL, NULL);
+
+		double objective, mipBound;
+		std::vector<double> x(ncols);
+		if ((status == UFFLP_Optimal || status == UFFLP_Feasible) &&
+			solver->GetObjValue(&objective) == UFFLP_Ok && objective < makespan - 0.5 &&
+			solver->GetSolutions(0, ncols, &x[0]) == UFFLP_Ok &&
+			ExpandCounts(x, dense, machineOf))
+		{
+			load.assign(m, 0);
+			for (int j = 0; j < n; j++)
+				load[machineOf[j]] += size[j];
+			makespan = *std::max_element(load.begin(), load.end());
+		}
+
+		// nothing below the cutoff proves the schedule optimal
+		if (status == UFFLP_Optimal || status == UFFLP_Infeasible)
+			bound = std::max(bound, makespan);
+		else if (solver->GetBestBound(&mipBound) == UFFLP_Ok)
+			bound = std::max(bound, (long long)ceil(mipBound - 1e-6));
+	}
+
+	Stabilize(dense, repaired, machineOf);
+	result.moved = 0;
+	for (int j = 0; j < n; j++)
+	{
+		if (previous[j] >= 0 && previous[j] != machineOf[j])
+			result.moved++;
+		dense[j]->machine = machineOf[j];
+	}
+	result.makespan = makespan;
+	result.bound = std::min(bound, makespan);
+	result.optimal = makespan <= bound;
+	replans++;
+}
+
+void Planner::Schedule(std::vector<std::pair<int, int> >& assignment) const
+{
+	assignment.clear();
+	for (std::map<int, Job>::const_iterator it = jobs.begin(); it != jobs.end(); ++it)
+		assignment.push_back(std::make_pair(it->first, it->second.machine));
+}
+
+// Lines of commands and their replies
+class Channel
+{
+public:
+	virtual ~Channel() {}
+
+	// @return false at the end of the input
+	virtual bool ReadLine(std::string& line) = 0;
+	virtual void Write(const std::string& text) = 0;
+};
+
+class StdioChannel : public Channel
+{
+public:
+	bool ReadLine(std::string& line)
+	{
+		char buf[4096];
+		line.clear();
+		while (fgets(buf, sizeof(buf), stdin) != NULL)
+		{
+			line += buf;
+			if (line[line.size() - 1] == '\n')
+				return true;
+		}
+		return !line.empty();
+	}
+
+	void Write(const std::string& text)
+	{
+		fputs(text.c_str(), stdout);
+		fflush(stdout);
+	}
+};
+
+// One client of the listening socket; closes the connection when destroyed
+class SocketChannel : public Channel
+{
+public:
+	SocketChannel(SOCKET s) : s(s) {}
+	~SocketChannel() { closesocket(s); }
+
+	bool ReadLine(std::string& line)
+	{
+		for (;;)
+		{
+			size_t eol = pending.find('\n');
+			if (eol != std::string::npos)
+			{
+				line = pending.substr(0, eol + 1);
+				pending.erase(0, eol + 1);
+				return true;
+			}
+			char buf[4096];
+			int got = recv(s, buf, sizeof(buf), 0);
+			if (got <= 0)
+			{
+				line.swap(pending);
+				pending.clear();
+				return !line.empty();
+			}
+			pending.append(buf, got);
+		}
+	}
+
+	void Write(const std::string& text)
+	{
+#ifdef MSG_NOSIGNAL
+		int flags = MSG_NOSIGNAL;
+#else
+		int flags = 0;
+#endif
+		size_t sent = 0;
+		while (sent < text.size())
+		{
+			int k = send(s, text.data() + sent, (int)(text.size() - sent), flags);
+			if (k <= 0)
+				return;
+			sent += k;
+		}
+	}
+
+private:
+	SOCKET s;
+	std::string pending;
+};
+
+static SOCKET ListenLoopback(int port)
+{
+	SOCKET s = socket(AF_INET, SOCK_STREAM, 0);
+	if (s == INVALID_SOCKET)
+		return s;
+
+	int yes = 1;
+	setsockopt(s, SOL_SOCKET, SO_REUSEADDR, (const char*)&yes, sizeof(yes));
+	sockaddr_in addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons((unsigned short)port);
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	if (bind(s, (sockaddr*)&addr, sizeof(addr)) != 0 || listen(s, 1) != 0)
+	{
+		closesocket(s);
+		return INVALID_SOCKET;
+	}
+	return s;
+}
+
+// Nearest-rank percentile of the latencies, 0 without any
+static double Percentile(std::vector<double> values, double q)
+{
+	if (values.empty())
+		return 0.0;
+	size_t rank = (size_t)ceil(q * values.size());
+	rank = rank > 0 ? rank - 1 : 0;
+	std::nth_element(values.begin(), values.begin() + rank, values.end());
+	return values[rank];
+}
+
+// Parse the jobs of an instance file as new jobs.
+// @return an error message, NULL if the jobs were added
+static const char* LoadJobs(Planner& planner, const char* fname)
+{
+	std::vector<int> proctime, setup;
+	if (!ReadInstance(fname, proctime, setup))
+		return "unable to read the instance";
+	for (size_t j = 0; j < proctime.size(); j++)
+		if (proctime[j] < 0 || setup[j] < 0)
+			return "negative time";
+
+	int next = planner.NextId();
+	for (size_t j = 0; j < proctime.size(); j++)
+		planner.Add(next + (int)j, proctime[j], setup[j]);
+	return NULL;
+}
+
+// Answer the commands of a channel until its end or "quit".
+// @return true on "quit"
+static bool Serve(Planner& planner, Channel& channel, std::vector<double>& latency)
+{
+	std::string line;
+	char word[16], buf[256];
+	int id, a, b;
+
+	while (channel.ReadLine(line))
+	{
+		const char* s = line.c_str();
+		if (sscanf(s, "%15s", word) != 1 || word[0] == '#')
+			continue;
+
+		double start = WallClock();
+		const char* error = NULL;
+		if (strcmp(word, "add") == 0)
+			error = sscanf(s, "%*s %d %d %d", &id, &a, &b) == 3 ?
+				planner.Add(id, a, b) : "usage: add <id> <proctime> <setup>";
+		else if (strcmp(word, "remove") == 0)
+			error = sscanf(s, "%*s %d", &id) == 1 ?
+				planner.Remove(id) : "usage: remove <id>";
+		else if (strcmp(word, "fix") == 0)
+			error = sscanf(s, "%*s %d %d", &id, &a) == 2 && a >= 0 ?
+				planner.Fix(id, a) : "usage: fix <id> <machine>";
+		else if (strcmp(word, "unfix") == 0)
+			error = sscanf(s, "%*s %d", &id) == 1 ?
+				planner.Fix(id, -1) : "usage: unfix <id>";
+		else if (strcmp(word, "load") == 0)
+		{
+			std::string fname = line.substr(line.find("load") + 4);
+			size_t first = fname.find_first_not_of(" \t");
+			size_t last = fname.find_last_not_of(" \t\r\n");
+			error = first == std::string::npos ? "usage: load <file>" :
+				LoadJobs(planner, fname.substr(first, last - first + 1).c_str());
+		}
+		else if (strcmp(word, "schedule") == 0)
+		{
+			std::vector<std::pair<int, int> > assignment;
+			planner.Schedule(assignment);
+			std::string text;
+			for (size_t k = 0; k < assignment.size(); k++)
+			{
+				sprintf(buf, "job %d %d\n", assignment[k].first, assignment[k].second);
+				text += buf;
+			}
+			channel.Write(text + "end\n");
+			continue;
+		}
+		else if (strcmp(word, "stats") == 0)
+		{
+			sprintf(buf, "stats jobs %d updates %d p50 %.1f p99 %.1f max %.1f\n",
+				planner.NumJobs(), (int)latency.size(), Percentile(latency, 0.5),
+				Percentile(latency, 0.99), Percentile(latency, 1.0));
+			channel.Write(buf);
+			continue;
+		}
+		else if (strcmp(word, "quit") == 0)
+			return true;
+		else
+			error = "unknown command";
+
+		if (error != NULL)
+		{
+			channel.Write(std::string("error ") + error + "\n");
+			continue;
+		}
+
+		PlanResult plan;
+		planner.Replan(plan);
+		double ms = (WallClock() - start) * 1000.0;
+		latency.push_back(ms);
+		sprintf(buf, "plan %lld %lld %s %.1f %d\n", plan.makespan, plan.bound,
+			StatusName(plan.optimal ? UFFLP_Optimal : UFFLP_Feasible), ms, plan.moved);
+		channel.Write(buf);
+	}
+	return false;
+}
+
+int RunDaemon(int argc, char* argv[])
+{
+	DaemonOptions opts;
+	if (!ParseDaemonOptions(argc, argv, opts))
+		return 1;
+
+	Planner planner(opts);
+	if (!planner.Ready())
+	{
+		printf("Solver backend not available: %s\n", opts.solve.solver.c_str());
+		return 1;
+	}
+
+	std::vector<double> latency;
+	if (opts.port == 0)
+	{
+		StdioChannel channel;
+		Serve(planner, channel, latency);
+	}
+	else
+	{
+#ifdef _WIN32
+		WSADATA wsa;
+		if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0)
+			return 1;
+#endif
+		SOCKET server = ListenLoopback(opts.port);
+		if (server == INVALID_SOCKET)
+		{
+			printf("Unable to listen on 127.0.0.1:%d\n", opts.port);
+			return 1;
+		}
+		printf("Listening on 127.0.0.1:%d\n", opts.port);
+		fflush(stdout);
+
+		// one client at a time; the jobs outlive the connections
+		bool quit = false;
+		while (!quit)
+		{
+			SOCKET client = accept(server, NULL, NULL);
+			if (client == INVALID_SOCKET)
+				break;
+			SocketChannel channel(client);
+			quit = Serve(planner, channel, latency);
+		}
+		closesocket(server);
+#ifdef _WIN32
+		WSACleanup();
+#endif
+	}
+
+	// on the error stream, away from the replies
+	fprintf(stderr, "%d re-plans, latency p50 %.1f ms, p99 %.1f ms, max %.1f ms\n",
+		(int)latency.size(), Percentile(latency, 0.5), Percentile(latency, 0.99),
+		Percentile(latency, 1.0));
+	return 0;
+}
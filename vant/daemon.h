@@ -0,0 +1,20 @@
+/****************************************************************************
+* Daemon mode: incremental re-planning of online job arrivals
+*
+* The aggregated model stays loaded in the backend for the whole session.
+* Every job type owns m count columns y_i_t and a demand column z_t tied by
+* sum_i y_i_t = z_t, so adding or removing a job of a known type only moves
+* the bounds of z_t, a new type appends its columns and its row, and fixing
+* a job to a machine raises the lower bound of a y_i_t. After every change
+* the previous schedule is repaired, improved by the local search and handed
+* to the MIP as its incumbent, all within the latency budget.
+*
+*****************************************************************************/
+
+#ifndef __DAEMON_H__
+#define __DAEMON_H__
+
+// vant --daemon <#machines> [--option=value ...]
+int RunDaemon(int argc, char* argv[]);
+
+#endif
@@ -0,0 +1,353 @@
+#include "dynprog.h"
+#include "heuristics.h"
+
+#include <algorithm>
+#include <functional>
+#include <unordered_map>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+typedef unsigned long long Word;
+
+// Largest half sum of the partition DP: the back pointers take 4 bytes each
+static const long long MaxPartitionSum = 1LL << 25;
+
+// Word operations of the partition DP considered cheap
+static const double PartitionWorkLimit = 2e9;
+
+// States kept by the load DP over all jobs, and the largest capacity that
+// fits the 16 bits of a packed load
+static const long long MaxLoadStates = 1LL << 22;
+static const long long MaxPackedLoad = 0xffff;
+
+static int LowestBit(Word w)
+{
+#if defined(_MSC_VER) && defined(_WIN64)
+	unsigned long k;
+	_BitScanForward64(&k, w);
+	return (int)k;
+#elif defined(_MSC_VER)
+	unsigned long k;
+	if (_BitScanForward(&k, (unsigned long)w))
+		return (int)k;
+	_BitScanForward(&k, (unsigned long)(w >> 32));
+	return (int)k + 32;
+#else
+	return __builtin_ctzll(w);
+#endif
+}
+
+// Copies of one job size packed into a single item of the partition DP.
+// Splitting a count c into 1, 2, 4, ... and the remainder reaches every
+// number of copies from 0 to c with O(log c) items.
+struct Chunk
+{
+	long long size;
+	int first;      // position of the first copy in the sorted job order
+	int copies;
+};
+
+static void SplitCopies(const std::vector<int>& size,
+	const std::vector<int>& order, std::vector<Chunk>& chunks)
+{
+	chunks.clear();
+	for (size_t k = 0; k < order.size(); )
+	{
+		int s = size[order[k]];
+		size_t end = k;
+		while (end < order.size() && size[order[end]] == s)
+			end++;
+
+		int left = (int)(end - k);
+		for (int copies = 1; left > 0; copies *= 2)
+		{
+			Chunk c;
+			c.copies = std::min(copies, left);
+			c.size = (long long)c.copies * s;
+			c.first = (int)end - left;
+			if (s > 0)
+				chunks.push_back(c);
+			left -= c.copies;
+		}
+		k = end;
+	}
+}
+
+// Two machines: the subset of load closest to total/2 goes to machine 0
+static void SolvePartition(const std::vector<int>& size,
+	std::vector<int>& machineOf)
+{
+	std::vector<int> order;
+	std::vector<Chunk> chunks;
+	long long total = 0;
+
+	for (size_t j = 0; j < size.size(); j++)
+		total += size[j];
+	SortBySize(size, order);
+	SplitCopies(size, order, chunks);
+
+	// bit t of reach: some subset of the chunks seen so far sums to t;
+	// first[t] is the chunk that reached t first
+	long long half = total / 2;
+	size_t words = (size_t)(half / 64) + 1;
+	Word lastMask = (half % 64 == 63) ? ~(Word)0 : (((Word)1 << (half % 64 + 1)) - 1);
+	std::vector<Word> reach(words, 0);
+	std::vector<int> first((size_t)half + 1, -1);
+	reach[0] = 1;
+
+	for (size_t c = 0; c < chunks.size() && !((reach[words - 1] >> (half % 64)) & 1); c++)
+	{
+		if (chunks[c].size > half)
+			continue;
+		size_t ws = (size_t)(chunks[c].size / 64);
+		int bs = (int)(chunks[c].size % 64);
+
+		// reach |= reach << size, from the top word down so that every
+		// source word is read before it is updated
+		for (size_t k = words; k-- > ws; )
+		{
+			Word shifted = reach[k - ws] << bs;
+			if (bs != 0 && k > ws)
+				shifted |= reach[k - ws - 1] >> (64 - bs);
+			Word fresh = shifted & ~reach[k];
+			if (k == words - 1)
+				fresh &= lastMask;
+			if (fresh == 0)
+				continue;
+			reach[k] |= fresh;
+			for (; fresh != 0; fresh &= fresh - 1)
+				first[k * 64 + LowestBit(fresh)] = (int)c;
+		}
+	}
+
+	long long best = half;
+	while (!((reach[(size_t)(best / 64)] >> (best % 64)) & 1))
+		best--;
+
+	machineOf.assign(size.size(), 1);
+	for (long long t = best; t > 0; t -= chunks[first[(size_t)t]].size)
+	{
+		const Chunk& c = chunks[first[(size_t)t]];
+		for (int k = 0; k < c.copies; k++)
+			machineOf[order[c.first + k]] = 0;
+	}
+}
+
+// Packed state of the load DP: the loads sorted in non-increasing order,
+// 16 bits each, machines that cannot take any further job set to C
+struct LoadState
+{
+	Word key;
+	int parent;     // state of the previous job
+	int slot;       // sorted position of the machine that took the job
+};
+
+static Word PackLoads(const long long* load, int m)
+{
+	Word key = 0;
+	for (int i = 0; i < m; i++)
+		key = (key << 16) | (Word)load[i];
+	return key;
+}
+
+static void UnpackLoads(Word key, int m, long long* load)
+{
+	for (int i = m - 1; i >= 0; i--)
+	{
+		load[i] = (long long)(key & 0xffff);
+		key >>= 16;
+	}
+}
+
+// Close the machines with no room for the smallest remaining job and sort
+static void Canonical(long long* load, int m, long long C, long long smallest)
+{
+	for (int i = 0; i < m; i++)
+		if (C - load[i] < smallest)
+			load[i] = C;
+	std::sort(load, load + m, std::greater<long long>());
+}
+
+// Decide whether m machines of capacity C take all jobs.
+// @return 1 with the schedule in machineOf, 0 if not, -1 at the state limit
+static int FitsCapacity(const std::vector<int>& size,
+	const std::vector<int>& order, int m, long long C, long long& states,
+	std::vector<int>& machineOf)
+{
+	int n = (int)order.size();
+	std::vector<long long> remaining(n + 1, 0);
+	for (int k = n - 1; k >= 0; k--)
+		remaining[k] = remaining[k + 1] + size[order[k]];
+	long long smallest = n > 0 ? size[order[n - 1]] : 0;
+
+	std::vector<std::vector<LoadState> > layer(n + 1);
+	std::unordered_map<Word, int> seen;
+	long long load[MaxDpMachines], next[MaxDpMachines];
+
+	LoadState root;
+	for (int i = 0; i < m; i++)
+		load[i] = 0;
+	Canonical(load, m, C, smallest);
+	root.key = PackLoads(load, m);
+	root.parent = -1;
+	root.slot = -1;
+	layer[0].push_back(root);
+
+	for (int k = 0; k < n; k++)
+	{
+		long long s = size[order[k]];
+		long long after = k + 1 < n ? smallest : 0;
+		seen.clear();
+		for (int p = 0; p < (int)layer[k].size(); p++)
+		{
+			UnpackLoads(layer[k][p].key, m, load);
+			for (int i = 0; i < m; i++)
+			{
+				// equal loads lead to the same state
+				if (load[i] + s > C || (i > 0 && load[i] == load[i - 1]))
+					continue;
+
+				long long room = 0;
+				std::copy(load, load + m, next);
+				next[i] += s;
+				Canonical(next, m, C, after);
+				for (int q = 0; q < m; q++)
+					room += C - next[q];
+				if (room < remaining[k + 1])
+					continue;
+
+				Word key = PackLoads(next, m);
+				if (seen.count(key))
+					continue;
+				if (++states > MaxLoadStates)
+					return -1;
+				seen[key] = (int)layer[k + 1].size();
+				LoadState st;
+				st.key = key;
+				st.parent = p;
+				st.slot = i;
+				layer[k + 1].push_back(st);
+			}
+		}
+		if (layer[k + 1].empty())
+			return 0;
+	}
+
+	// follow the parents back, then replay the slots on real machines
+	std::vector<int> slot(n);
+	for (int k = n, p = 0; k > 0; k--)
+	{
+		slot[k - 1] = layer[k][p].slot;
+		p = layer[k][p].parent;
+	}
+
+	std::vector<long long> real(m, 0), key(m);
+	std::vector<int> byLoad(m);
+	machineOf.assign(size.size(), -1);
+	for (int k = 0; k < n; k++)
+	{
+		long long before = smallest;
+		for (int i = 0; i < m; i++)
+		{
+			key[i] = C - real[i] < before ? C : real[i];
+			byLoad[i] = i;
+		}
+		std::stable_sort(byLoad.begin(), byLoad.end(),
+			[&key](int a, int b) { return key[a] > key[b]; });
+		int machine = byLoad[slot[k]];
+		machineOf[order[k]] = machine;
+		real[machine] += size[order[k]];
+	}
+	return 1;
+}
+
+// Three or four machines: bisection on C over the load DP
+static bool SolveLoads(const std::vector<int>& size, int m,
+	long long lowerBound, long long& makespan, std::vector<int>& machineOf)
+{
+	std::vector<int> order, schedule;
+	long long states = 0;
+
+	SortBySize(size, order);
+	long long lo = lowerBound, hi = makespan - 1;
+	std::vector<int> best(machineOf);
+	long long bestMakespan = makespan;
+	while (lo <= hi)
+	{
+		long long C = (lo + hi) / 2;
+		int res = FitsCapacity(size, order, m, C, states, schedule);
+		if (res < 0)
+			return false;
+		if (res > 0)
+		{
+			best = schedule;
+			bestMakespan = ScheduleMakespan(size, m, best);
+			hi = bestMakespan - 1;
+		}
+		else
+			lo = C + 1;
+	}
+	makespan = bestMakespan;
+	machineOf = best;
+	return true;
+}
+
+bool DpIsCheap(const std::vector<int>& size, int m, long long upperBound)
+{
+	long long total = 0;
+	for (size_t j = 0; j < size.size(); j++)
+		total += size[j];
+
+	if (m == 2)
+	{
+		std::vector<int> order;
+		std::vector<Chunk> chunks;
+		SortBySize(size, order);
+		SplitCopies(size, order, chunks);
+		double words = (double)(total / 2) / 64 + 1;
+		return total / 2 <= MaxPartitionSum &&
+			words * chunks.size() <= PartitionWorkLimit;
+	}
+	if (m == 3 || m == 4)
+	{
+		// the loads of a layer add up to the work done so far, so a layer
+		// holds about C^(m-2) / (m-2)! states
+		double perLayer = m == 3 ? (double)upperBound :
+			(double)upperBound * upperBound / 2;
+		return upperBound - 1 <= MaxPackedLoad &&
+			perLayer * size.size() <= (double)MaxLoadStates;
+	}
+	return false;
+}
+
+bool SolveByDP(const std::vector<int>& size, int m, long long lowerBound,
+	long long& makespan, std::vector<int>& machineOf)
+{
+	long long total = 0;
+	for (size_t j = 0; j < size.size(); j++)
+		total += size[j];
+
+	if (m == 2)
+	{
+		if (total / 2 > MaxPartitionSum)
+			return false;
+		std::vector<int> schedule;
+		SolvePartition(size, schedule);
+		long long value = ScheduleMakespan(size, m, schedule);
+		if (value < makespan)
+		{
+			makespan = value;
+			machineOf = schedule;
+		}
+		return true;
+	}
+	if (m == 3 || m == 4)
+	{
+		if (makespan - 1 > MaxPackedLoad)
+			return false;
+		return SolveLoads(size, m, lowerBound, makespan, machineOf);
+	}
+	return false;
+}
@@ -0,0 +1,36 @@
+/****************************************************************************
+* Exact dynamic programming for few machines
+*
+* With m = 2 the makespan problem is a partition of the job sizes: a subset
+* sum DP over a bitset, shifted a 64-bit word at a time, finds the reachable
+* load closest to total/2 in O(n C / 64). With m = 3 or 4 a state DP over the
+* sorted machine loads decides whether a capacity C suffices; states that can
+* no longer take any job close their machine, which merges them, and states
+* without room for the remaining work are dropped. The makespan is found by
+* bisection on C.
+*
+*****************************************************************************/
+
+#ifndef __DYN_PROG_H__
+#define __DYN_PROG_H__
+
+#include <vector>
+
+// Largest number of machines handled by the DP engine
+const int MaxDpMachines = 4;
+
+// Whether the DP engine is expected to be cheaper than the MIP for the jobs
+// sizes, m machines and a makespan of at most upperBound.
+bool DpIsCheap(const std::vector<int>& size, int m, long long upperBound);
+
+// Minimize the makespan by dynamic programming.
+// @param lowerBound  known lower bound on the makespan
+// @param makespan    makespan of a starting schedule; the optimal one on
+//                    return
+// @param machineOf   starting schedule; an optimal one on return
+// @return false if m is not supported or the state limit was reached, in
+//         which case makespan and machineOf are left unchanged
+bool SolveByDP(const std::vector<int>& size, int m, long long lowerBound,
+	long long& makespan, std::vector<int>& machineOf);
+
+#endif
@@ -0,0 +1,95 @@
+#include "export.h"
+#include "modelbuilder.h"
+#include "sysutil.h"
+
+#include <memory>
+#include <stdio.h>
+
+#ifdef _WIN32
+#define popen _popen
+#define pclose _pclose
+#endif
+
+static bool EndsWith(const std::string& s, const char* suffix)
+{
+	std::string tail(suffix);
+	return s.size() >= tail.size() &&
+		s.compare(s.size() - tail.size(), tail.size(), tail) == 0;
+}
+
+bool ValidExportFormat(const std::string& format)
+{
+	std::string base = format;
+	if (EndsWith(base, ".gz"))
+		base.resize(base.size() - 3);
+	else if (EndsWith(base, ".zst"))
+		base.resize(base.size() - 4);
+	return base == "lp" || base == "mps";
+}
+
+bool WriteModelFile(const ModelBuilder& model, const std::string& fname)
+{
+	// compressed files are written through the compressor's standard input
+	std::string plain = fname;
+	const char* compressor = NULL;
+	if (EndsWith(fname, ".gz"))
+	{
+		compressor = "gzip -c";
+		plain.resize(plain.size() - 3);
+	}
+	else if (EndsWith(fname, ".zst"))
+	{
+		compressor = "zstd -q -c";
+		plain.resize(plain.size() - 4);
+	}
+
+	FILE* f;
+	if (compressor != NULL)
+	{
+		std::string command = std::string(compressor) + " > \"" + fname + "\"";
+		f = popen(command.c_str(), "w");
+	}
+	else
+		f = fopen(fname.c_str(), "w");
+	if (f == NULL)
+		return false;
+
+	bool ok = EndsWith(plain, ".mps") ? model.WriteMPS(f) : model.WriteLP(f);
+	if (compressor != NULL)
+		ok = pclose(f) == 0 && ok;
+	else
+		ok = fclose(f) == 0 && ok;
+	return ok;
+}
+
+ModelExport::ModelExport() : ok(true), seconds(0), cpuSeconds(0)
+{
+}
+
+// The writer owns its copy of the model and publishes its results before
+// the thread ends; Wait() reads them after the join.
+static void WriteInBackground(std::shared_ptr<const ModelBuilder> model,
+	std::string fname, bool* ok, double* seconds, double* cpuSeconds)
+{
+	double wall = WallClock(), cpu = ThreadCpuTime();
+	*ok = WriteModelFile(*model, fname);
+	*seconds = WallClock() - wall;
+	*cpuSeconds = ThreadCpuTime() - cpu;
+	if (!*ok)
+		printf("Could not export the model to %s\n", fname.c_str());
+}
+
+void ModelExport::Start(const ModelBuilder& model, const std::string& fname)
+{
+	Wait();
+	std::shared_ptr<const ModelBuilder> snapshot(new ModelBuilder(model));
+	writer = std::thread(WriteInBackground, snapshot, fname, &ok, &seconds,
+		&cpuSeconds);
+}
+
+bool ModelExport::Wait()
+{
+	if (writer.joinable())
+		writer.join();
+	return ok;
+}
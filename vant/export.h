@@ -0,0 +1,53 @@
+/****************************************************************************
+* Background export of a model
+*
+* The model is copied when the export starts and written by its own thread,
+* so the solve can modify and solve the original meanwhile. The format
+* follows the file name: ".lp" or ".mps", optionally followed by ".gz" or
+* ".zst" to pipe the output through the gzip or zstd command.
+*
+*****************************************************************************/
+
+#ifndef __EXPORT_H__
+#define __EXPORT_H__
+
+#include <string>
+#include <thread>
+
+class ModelBuilder;
+
+// True if format is lp or mps, optionally followed by .gz or .zst
+bool ValidExportFormat(const std::string& format);
+
+// Write a model to a file, in the format given by its extension.
+// @return false if the file or the compressor could not be written
+bool WriteModelFile(const ModelBuilder& model, const std::string& fname);
+
+class ModelExport
+{
+public:
+	ModelExport();
+	~ModelExport() { Wait(); }
+
+	// Copy the model and start writing it on a new thread. Only one export
+	// runs at a time: a previous one is waited for first.
+	void Start(const ModelBuilder& model, const std::string& fname);
+
+	// Wait for the writer thread, if any.
+	// @return false if the last export failed
+	bool Wait();
+
+	// Wall and CPU time of the writer thread, valid after Wait()
+	double Seconds() const { return seconds; }
+	double CpuSeconds() const { return cpuSeconds; }
+
+private:
+	ModelExport(const ModelExport&);
+	ModelExport& operator=(const ModelExport&);
+
+	std::thread writer;
+	bool ok;
+	double seconds, cpuSeconds;
+};
+
+#endif
@@ -0,0 +1,95 @@
+#include "generator.h"
+#include "instance.h"
+
+#include <random>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Jobs of the huge class that get the large processing times
+static const int HugeJobs = 5;
+
+// Uniform in [lo, hi] from the raw 32-bit draws: the distributions of
+// <random> differ between standard libraries
+static int Draw(std::mt19937& rng, long long lo, long long hi)
+{
+	return (int)(lo + (long long)(rng() % (unsigned long long)(hi - lo + 1)));
+}
+
+bool ValidInstanceClass(const std::string& name)
+{
+	return name == "u100" || name == "u1000" || name == "n4n" || name == "near" ||
+		name == "huge";
+}
+
+bool GenerateInstance(const std::string& name, int n, unsigned seed,
+	std::vector<int>& proctime, std::vector<int>& setup)
+{
+	if (!ValidInstanceClass(name) || n < 1 || n > MaxGeneratedJobs)
+		return false;
+
+	long long pLo = 1, pHi = 100, sHi = 20;
+	if (name == "u1000")
+	{
+		pHi = 1000;
+		sHi = 200;
+	}
+	else if (name == "n4n")
+	{
+		pLo = n;
+		pHi = 4LL * n;
+		sHi = n;
+	}
+	else if (name == "near")
+	{
+		pLo = 995;
+		pHi = 1005;
+		sHi = 5;
+	}
+
+	std::mt19937 rng(seed);
+	proctime.resize(n);
+	setup.resize(n);
+	for (int j = 0; j < n; j++)
+	{
+		proctime[j] = Draw(rng, pLo, pHi);
+		setup[j] = Draw(rng, 0, sHi);
+	}
+	if (name == "huge")
+	{
+		int count = n < HugeJobs ? n : HugeJobs;
+		for (int k = 0; k < count; k++)
+			proctime[k * (n / count)] = Draw(rng, 10LL * n, 50LL * n);
+	}
+	return true;
+}
+
+int RunGenerate(int argc, char* argv[])
+{
+	std::vector<int> proctime, setup;
+
+	if (argc < 6 || (argc > 6 && strcmp(argv[6], "--binary") != 0) || argc > 7)
+	{
+		printf("Usage: %s --generate <class> <#jobs> <seed> <output> [--binary]\n",
+			argv[0]);
+		printf("  classes: u100, u1000, n4n, near and huge; up to %d jobs\n",
+			MaxGeneratedJobs);
+		return 1;
+	}
+	bool binary = argc == 7;
+
+	if (!GenerateInstance(argv[2], atoi(argv[3]), (unsigned)atoi(argv[4]),
+		proctime, setup))
+	{
+		printf("Unknown class or invalid number of jobs: %s %s\n", argv[2], argv[3]);
+		return 1;
+	}
+	if (!WriteInstance(argv[5], proctime, setup, binary))
+	{
+		printf("Unable to write the instance %s\n", argv[5]);
+		return 1;
+	}
+	printf("%d jobs of class %s written as %s to %s\n", (int)proctime.size(),
+		argv[2], binary ? "binary" : "text", argv[5]);
+	return 0;
+}
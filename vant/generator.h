@@ -0,0 +1,35 @@
+/****************************************************************************
+* Seeded generator of benchmark instances
+*
+* The classes, with the processing and setup times drawn uniformly:
+*   u100   proctime in [1, 100], setup in [0, 20]
+*   u1000  proctime in [1, 1000], setup in [0, 200]
+*   n4n    proctime in [n, 4n], setup in [0, n]
+*   near   proctime in [995, 1005], setup in [0, 5]: near-identical jobs
+*   huge   as u100, except 5 jobs spread evenly with proctime in [10n, 50n]
+* The draws come from std::mt19937, whose sequence is fixed by the standard,
+* so a class, n and seed give the same instance on every platform.
+*
+*****************************************************************************/
+
+#ifndef __GENERATOR_H__
+#define __GENERATOR_H__
+
+#include <string>
+#include <vector>
+
+// Largest number of jobs of a generated instance
+const int MaxGeneratedJobs = 1000000;
+
+// @return true if name is one of the classes above
+bool ValidInstanceClass(const std::string& name);
+
+// Generate the times of an instance of a class with n jobs.
+// @return false if the class is unknown or n is out of range
+bool GenerateInstance(const std::string& name, int n, unsigned seed,
+	std::vector<int>& proctime, std::vector<int>& setup);
+
+// Entry point of "vant --generate <class> <#jobs> <seed> <output> [--binary]"
+int RunGenerate(int argc, char* argv[]);
+
+#endif
@@ -0,0 +1,120 @@
+#include "heuristics.h"
+
+#include <algorithm>
+#include <functional>
+#include <queue>
+#include <utility>
+
+void SortBySize(const std::vector<int>& size, std::vector<int>& order)
+{
+	order.resize(size.size());
+	for (size_t j = 0; j < order.size(); j++)
+		order[j] = (int)j;
+	std::stable_sort(order.begin(), order.end(),
+		[&size](int a, int b) { return size[a] > size[b]; });
+}
+
+long long ScheduleMakespan(const std::vector<int>& size, int m,
+	const std::vector<int>& machineOf)
+{
+	std::vector<long long> load(m, 0);
+	long long makespan = 0;
+	for (size_t j = 0; j < size.size(); j++)
+	{
+		load[machineOf[j]] += size[j];
+		makespan = std::max(makespan, load[machineOf[j]]);
+	}
+	return makespan;
+}
+
+long long LptSchedule(const std::vector<int>& size, int m,
+	std::vector<int>& machineOf)
+{
+	typedef std::pair<long long, int> Load;
+	std::priority_queue<Load, std::vector<Load>, std::greater<Load> > loads;
+	std::vector<int> order;
+	long long makespan = 0;
+
+	for (int i = 0; i < m; i++)
+		loads.push(Load(0, i));
+
+	SortBySize(size, order);
+	machineOf.assign(size.size(), -1);
+	for (size_t k = 0; k < order.size(); k++)
+	{
+		Load least = loads.top();
+		loads.pop();
+		machineOf[order[k]] = least.second;
+		least.first += size[order[k]];
+		makespan = std::max(makespan, least.first);
+		loads.push(least);
+	}
+	return makespan;
+}
+
+bool FirstFitDecreasing(const std::vector<int>& size,
+	const std::vector<int>& order, int m, long long C,
+	std::vector<int>& machineOf)
+{
+	// tree[1] is the root; leaf i is tree[leaves + i]
+	int leaves = 1;
+	while (leaves < m)
+		leaves *= 2;
+	std::vector<long long> tree(2 * leaves, -1);
+	for (int i = 0; i < m; i++)
+		tree[leaves + i] = C;
+	for (int k = leaves - 1; k >= 1; k--)
+		tree[k] = std::max(tree[2 * k], tree[2 * k + 1]);
+
+	for (size_t k = 0; k < order.size(); k++)
+	{
+		int job = order[k];
+		if (tree[1] < size[job])
+			return false;
+
+		// leftmost machine with enough room
+		int node = 1;
+		while (node < leaves)
+			node = tree[2 * node] >= size[job] ? 2 * node : 2 * node + 1;
+		machineOf[job] = node - leaves;
+
+		tree[node] -= size[job];
+		for (node /= 2; node >= 1; node /= 2)
+			tree[node] = std::max(tree[2 * node], tree[2 * node + 1]);
+	}
+	return true;
+}
+
+long long MultifitSchedule(const std::vector<int>& size, int m,
+	std::vector<int>& machineOf)
+{
+	std::vector<int> order, packing(size.size());
+	long long total = 0, largest = 0;
+
+	SortBySize(size, order);
+	for (size_t j = 0; j < size.size(); j++)
+	{
+		total += size[j];
+		largest = std::max<long long>(largest, size[j]);
+	}
+
+	// first fit decreasing always succeeds with C = max(2 total / m, largest)
+	long long lo = std::max(largest, (total + m - 1) / m);
+	long long hi = std::max(largest, (2 * total + m - 1) / m);
+	bool found = false;
+	while (lo <= hi)
+	{
+		long long C = (lo + hi) / 2;
+		if (FirstFitDecreasing(size, order, m, C, packing))
+		{
+			machineOf = packing;
+			found = true;
+			hi = C - 1;
+		}
+		else
+			lo = C + 1;
+	}
+	if (!found)
+		return LptSchedule(size, m, machineOf);
+	return ScheduleMakespan(size, m, machineOf);
+}
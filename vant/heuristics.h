@@ -0,0 +1,39 @@
+/****************************************************************************
+* Constructive heuristics for the UAV makespan problem
+*
+* Jobs are given by their sizes setup[j] + proctime[j]; a schedule is the
+* machine assigned to every job.
+*****************************************************************************/
+
+#ifndef __HEURISTICS_H__
+#define __HEURISTICS_H__
+
+#include <vector>
+
+// Job indices sorted by non-increasing size, ties by index
+void SortBySize(const std::vector<int>& size, std::vector<int>& order);
+
+// Makespan of the schedule in machineOf
+long long ScheduleMakespan(const std::vector<int>& size, int m,
+	const std::vector<int>& machineOf);
+
+// Longest processing time first: jobs in non-increasing size order, each one
+// to the least loaded machine. O(n log n + n log m).
+// @return the makespan of the schedule stored in machineOf
+long long LptSchedule(const std::vector<int>& size, int m,
+	std::vector<int>& machineOf);
+
+// First fit of the jobs, taken in order, into m machines of capacity C.
+// @return false if some job fits in no machine
+bool FirstFitDecreasing(const std::vector<int>& size,
+	const std::vector<int>& order, int m, long long C,
+	std::vector<int>& machineOf);
+
+// MULTIFIT: bisection on the capacity C, packing the jobs by first fit
+// decreasing into m machines of capacity C. The first fit keeps the residual
+// capacities in a max segment tree, so every packing takes O(n log m).
+// @return the makespan of the schedule stored in machineOf
+long long MultifitSchedule(const std::vector<int>& size, int m,
+	std::vector<int>& machineOf);
+
+#endif
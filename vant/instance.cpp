@@ -0,0 +1,249 @@
+#include "instance.h"
+#include "sysutil.h"
+
+#include <string>
+#include <limits.h>
+#include <string.h>
+
+static const char BinaryMagic[8] = { 'V', 'A', 'N', 'T', 'J', 'O', 'B', '1' };
+static const size_t BinaryHeader = 16;    // magic and the 64-bit n
+
+// Integer scanner over a mapped buffer that is not NUL terminated
+class IntScanner
+{
+public:
+	IntScanner(const char* begin, const char* end) : p(begin), end(end) {}
+
+	// Skip the whitespace and read a decimal integer with an optional sign.
+	// @return false at the end of the buffer, on anything else than a digit
+	// or if the value does not fit an int
+	bool Next(int& value)
+	{
+		while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r'))
+			p++;
+		bool negative = false;
+		if (p < end && (*p == '-' || *p == '+'))
+			negative = *p++ == '-';
+		if (p == end || *p < '0' || *p > '9')
+			return false;
+
+		long long v = 0;
+		while (p < end && *p >= '0' && *p <= '9')
+		{
+			v = v * 10 + (*p++ - '0');
+			if (v > (long long)INT_MAX + 1)
+				return false;
+		}
+		if (negative)
+			v = -v;
+		if (v > INT_MAX)
+			return false;
+		value = (int)v;
+		return true;
+	}
+
+	// Skip the whitespace and read a word of letters.
+	// @return false at the end of the buffer or on anything else
+	bool Word(std::string& word)
+	{
+		while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r'))
+			p++;
+		word.clear();
+		while (p < end && ((*p >= 'a' && *p <= 'z') || (*p >= 'A' && *p <= 'Z')))
+			word += *p++;
+		return !word.empty();
+	}
+
+	bool AtEnd()
+	{
+		while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r'))
+			p++;
+		return p == end;
+	}
+
+private:
+	const char* p;
+	const char* end;
+};
+
+// The sections after the jobs of a text instance
+static bool ReadRelations(IntScanner& scan, int n, JobRelations& relations)
+{
+	std::string section;
+	int count, a, b, c;
+
+	relations = JobRelations();
+	while (!scan.AtEnd())
+	{
+		if (!scan.Word(section) || !scan.Next(count) || count < 0)
+			return false;
+		for (int k = 0; k < count; k++)
+		{
+			if (!scan.Next(a) || !scan.Next(b) || a < 0 || a >= n)
+				return false;
+			if (section == "precedence")
+			{
+				if (b < 0 || b >= n)
+					return false;
+				relations.arcs.push_back(std::make_pair(a, b));
+				continue;
+			}
+			if (!scan.Next(c))
+				return false;
+			if (section == "window" && b >= 0 && c >= -1)
+			{
+				relations.release.resize(n, 0);
+				relations.deadline.resize(n, -1);
+				relations.release[a] = b;
+				relations.deadline[a] = c;
+			}
+			else if (section == "transition" && b >= 0 && b < n && c >= 0)
+			{
+				Transition t = { a, b, c };
+				relations.transitions.push_back(t);
+			}
+			else
+				return false;
+		}
+	}
+	return true;
+}
+
+static bool ReadText(const char* data, size_t size, std::vector<int>& proctime,
+	std::vector<int>& setup, JobRelations* relations)
+{
+	IntScanner scan(data, data + size);
+	int n;
+	if (!scan.Next(n) || n < 0)
+		return false;
+
+	// every job takes at least four characters, which bounds the allocation
+	// for a corrupted n
+	if ((size_t)n > size / 4 + 1)
+		return false;
+	proctime.resize(n);
+	setup.resize(n);
+	for (int j = 0; j < n; j++)
+		if (!scan.Next(proctime[j]) || !scan.Next(setup[j]))
+			return false;
+	return relations == NULL || ReadRelations(scan, n, *relations);
+}
+
+static bool ReadBinary(const char* data, size_t size, std::vector<int>& proctime,
+	std::vector<int>& setup)
+{
+	long long n;
+	memcpy(&n, data + sizeof(BinaryMagic), sizeof(n));
+	if (n < 0 || n > INT_MAX || (size_t)n > (size - BinaryHeader) / (2 * sizeof(int)))
+		return false;
+
+	proctime.resize((size_t)n);
+	setup.resize((size_t)n);
+	if (n > 0)
+	{
+		const char* column = data + BinaryHeader;
+		memcpy(&proctime[0], column, (size_t)n * sizeof(int));
+		memcpy(&setup[0], column + (size_t)n * sizeof(int), (size_t)n * sizeof(int));
+	}
+	return true;
+}
+
+bool ReadInstance(const char* fname, std::vector<int>& proctime,
+	std::vector<int>& setup, JobRelations* relations)
+{
+	MappedFile file;
+	if (!file.Open(fname))
+		return false;
+
+	if (file.Size() >= BinaryHeader &&
+		memcmp(file.Data(), BinaryMagic, sizeof(BinaryMagic)) == 0)
+	{
+		if (relations != NULL)
+			*relations = JobRelations();
+		return ReadBinary(file.Data(), file.Size(), proctime, setup);
+	}
+	return ReadText(file.Data(), file.Size(), proctime, setup, relations);
+}
+
+bool WriteInstance(const char* fname, const std::vector<int>& proctime,
+	const std::vector<int>& setup, bool binary)
+{
+	FILE* fout = fopen(fname, binary ? "wb" : "w");
+	if (fout == NULL)
+		return false;
+
+	long long n = (long long)proctime.size();
+	bool ok;
+	if (binary)
+	{
+		ok = fwrite(BinaryMagic, 1, sizeof(BinaryMagic), fout) == sizeof(BinaryMagic) &&
+			fwrite(&n, sizeof(n), 1, fout) == 1;
+		if (ok && n > 0)
+			ok = fwrite(&proctime[0], sizeof(int), (size_t)n, fout) == (size_t)n &&
+				fwrite(&setup[0], sizeof(int), (size_t)n, fout) == (size_t)n;
+	}
+	else
+	{
+		ok = fprintf(fout, "%lld\n", n) > 0;
+		for (size_t j = 0; ok && j < proctime.size(); j++)
+			ok = fprintf(fout, "%d %d\n", proctime[j], setup[j]) > 0;
+	}
+	ok = fclose(fout) == 0 && ok;
+	return ok;
+}
+
+// One row of values separated by tabs, formatted into a buffer flushed in
+// large blocks
+static void EchoRow(FILE* out, const std::vector<int>& values)
+{
+	char buf[8192];
+	size_t used = 0;
+	for (size_t j = 0; j < values.size(); j++)
+	{
+		if (used > sizeof(buf) - 16)
+		{
+			fwrite(buf, 1, used, out);
+			used = 0;
+		}
+		used += sprintf(buf + used, "%d\t", values[j]);
+	}
+	fwrite(buf, 1, used, out);
+}
+
+void EchoInstance(FILE* out, const std::vector<int>& proctime,
+	const std::vector<int>& setup)
+{
+	fprintf(out, "Processing Times:\n");
+	EchoRow(out, proctime);
+	fprintf(out, "\nSetups:\n");
+	EchoRow(out, setup);
+}
+
+int RunConvert(int argc, char* argv[])
+{
+	std::vector<int> proctime, setup;
+
+	if (argc < 4 || (argc > 4 && strcmp(argv[4], "--text") != 0) || argc > 5)
+	{
+		printf("Usage: %s --convert input output [--text]\n", argv[0]);
+		printf("  writes the instance in the binary format, or as text with --text\n");
+		return 1;
+	}
+	bool binary = argc == 4;
+
+	double start = WallClock();
+	if (!ReadInstance(argv[2], proctime, setup))
+	{
+		printf("Unable to read the instance %s\n", argv[2]);
+		return 1;
+	}
+	double read = WallClock() - start;
+	if (!WriteInstance(argv[3], proctime, setup, binary))
+	{
+		printf("Unable to write the instance %s\n", argv[3]);
+		return 1;
+	}
+	printf("%d jobs read in %.3f s, written as %s to %s\n",
+		(int)proctime.size(), read, binary ? "binary" : "text", argv[3]);
+	return 0;
+}
@@ -0,0 +1,72 @@
+/****************************************************************************
+* Instance files
+*
+* Two formats are read, told apart by the first bytes of the file:
+*  - text: the number of jobs n followed by n pairs "proctime setup", any
+*    whitespace in between;
+*  - binary: the 8 bytes "VANTJOB1", n as a 64-bit integer, then the n
+*    processing times and the n setup times as 32-bit integers, all little
+*    endian (the byte order of the x86 hosts this runs on). The columns are
+*    loaded with one copy each.
+* Both are memory-mapped and parsed in place.
+* The text format may go on with sections relating the jobs, numbered from
+* zero, in any order:
+*    precedence K   then K pairs "a b": b starts once a is finished
+*    window K       then K triples "j release deadline", -1 for no deadline
+*    transition K   then K triples "j k s": k takes the setup s instead of
+*                   its own when it directly follows j on a machine
+* Readers that do not ask for them ignore the sections, and the binary
+* format holds the jobs only.
+*
+*****************************************************************************/
+
+#ifndef __INSTANCE_H__
+#define __INSTANCE_H__
+
+#include <stdio.h>
+#include <utility>
+#include <vector>
+
+// A sequence-dependent setup
+struct Transition
+{
+	int from, to, setup;
+};
+
+// Sections of an extended text instance
+struct JobRelations
+{
+	std::vector<std::pair<int, int> > arcs;     // precedence (a, b)
+	std::vector<long long> release, deadline;   // of every job, empty without
+	                                            // windows; deadline -1 for none
+	std::vector<Transition> transitions;
+
+	bool Empty() const
+	{
+		return arcs.empty() && release.empty() && transitions.empty();
+	}
+};
+
+// Read the processing and setup times of an instance file, and its
+// sections if relations is not NULL.
+// @return false if the file could not be opened, is truncated, holds
+// something else than integers where numbers are expected, a negative n, an
+// unknown section or a job out of range
+bool ReadInstance(const char* fname, std::vector<int>& proctime,
+	std::vector<int>& setup, JobRelations* relations = NULL);
+
+// Write an instance in the binary format, or in the text format if binary
+// is false.
+// @return false if the file could not be written
+bool WriteInstance(const char* fname, const std::vector<int>& proctime,
+	const std::vector<int>& setup, bool binary);
+
+// Print the processing and setup times as the single run echoes them
+void EchoInstance(FILE* out, const std::vector<int>& proctime,
+	const std::vector<int>& setup);
+
+// Entry point of "vant --convert input output [--text]": rewrite an
+// instance in the binary format, or in the text one with --text.
+int RunConvert(int argc, char* argv[]);
+
+#endif
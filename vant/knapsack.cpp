@@ -0,0 +1,61 @@
+#include "knapsack.h"
+
+#include <algorithm>
+
+bool BoundedKnapsack::Solve(const std::vector<int>& size,
+	const std::vector<int>& count, const std::vector<double>& value,
+	int capacity, double minValue)
+{
+	int C = capacity;
+	ntypes = (int)size.size();
+	chunks.clear();
+	for (int t = 0; t < ntypes; t++)
+	{
+		if (value[t] <= minValue)
+			continue;
+		int left = size[t] > 0 ? std::min(count[t], C / size[t]) : count[t];
+		for (int c = 1; left > 0; c *= 2)
+		{
+			Chunk chunk;
+			chunk.type = t;
+			chunk.copies = std::min(c, left);
+			chunk.weight = chunk.copies * size[t];
+			chunks.push_back(chunk);
+			left -= chunk.copies;
+		}
+	}
+
+	width = (size_t)C + 1;
+	if ((long long)chunks.size() * (long long)width > MaxKnapsackBits)
+		return false;
+
+	best.assign(width, 0.0);
+	take.assign((chunks.size() * width + 7) / 8, 0);
+	for (size_t q = 0; q < chunks.size(); q++)
+	{
+		int w = chunks[q].weight;
+		double v = chunks[q].copies * value[chunks[q].type];
+		for (int c = C; c >= w; c--)
+			if (best[c - w] + v > best[c] + 1e-12)
+			{
+				best[c] = best[c - w] + v;
+				size_t bit = q * width + c;
+				take[bit >> 3] |= (unsigned char)(1 << (bit & 7));
+			}
+	}
+	return true;
+}
+
+void BoundedKnapsack::Pattern(int c, std::vector<int>& copies) const
+{
+	copies.assign(ntypes, 0);
+	for (size_t q = chunks.size(); q-- > 0;)
+	{
+		size_t bit = q * width + c;
+		if (take[bit >> 3] & (1 << (bit & 7)))
+		{
+			copies[chunks[q].type] += chunks[q].copies;
+			c -= chunks[q].weight;
+		}
+	}
+}
@@ -0,0 +1,50 @@
+/****************************************************************************
+* Bounded knapsack over item types
+*
+* Copies of type t weigh size[t] and are worth value[t], with at most
+* count[t] of them. Every type is split into chunks of 1, 2, 4, ... copies
+* and a 0-1 knapsack runs over the chunks in O(chunks * capacity), keeping
+* one choice bit per chunk and capacity to rebuild the best pattern of any
+* capacity up to the one solved. Shared by the pricing of the column
+* generation and the Lagrangian relaxation.
+*
+*****************************************************************************/
+
+#ifndef __KNAPSACK_H__
+#define __KNAPSACK_H__
+
+#include <vector>
+#include <stddef.h>
+
+// Largest number of choice bits kept by one knapsack (256 MB)
+const long long MaxKnapsackBits = 1LL << 31;
+
+class BoundedKnapsack
+{
+public:
+	// Fill the tables for the capacities 0 .. capacity. Types worth at most
+	// minValue are left out.
+	// @return false if the tables would take more than MaxKnapsackBits
+	bool Solve(const std::vector<int>& size, const std::vector<int>& count,
+		const std::vector<double>& value, int capacity, double minValue);
+
+	// Best value of a pattern of weight at most c <= the capacity solved
+	double Value(int c) const { return best[c]; }
+
+	// Copies of every type in a best pattern of weight at most c
+	void Pattern(int c, std::vector<int>& copies) const;
+
+private:
+	struct Chunk
+	{
+		int type, copies, weight;
+	};
+
+	int ntypes;
+	size_t width;
+	std::vector<Chunk> chunks;
+	std::vector<double> best;
+	std::vector<unsigned char> take;
+};
+
+#endif
@@ -0,0 +1,190 @@
+#include "lagrange.h"
+#include "knapsack.h"
+#include "portfolio.h"
+#include "runstats.h"
+#include "sysutil.h"
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <map>
+#include <thread>
+#include <math.h>
+#include <stdio.h>
+
+// Step factor of the first trajectory; every next one starts 1/sqrt(2) lower
+static const double StartStep = 2.0;
+
+// The step factor halves after this many steps without a better bound, and
+// the trajectory ends once it falls below MinStep
+static const int MaxStaleSteps = 20;
+static const double MinStep = 1e-3;
+
+// Jobs of the same size, by non-increasing size
+struct JobTypes
+{
+	std::vector<int> size, count;
+	std::vector<std::vector<int> > jobs;
+};
+
+// The machines take the pattern while its jobs last, then the remaining
+// jobs go, the largest first, to the least loaded machine.
+// @return the makespan of machineOf
+static long long PatternSchedule(const JobTypes& types, int m,
+	const std::vector<int>& pattern, std::vector<int>& machineOf)
+{
+	size_t ntypes = types.size.size();
+	std::vector<size_t> next(ntypes, 0);
+	std::vector<long long> load(m, 0);
+	for (int i = 0; i < m; i++)
+		for (size_t t = 0; t < ntypes; t++)
+			for (int k = 0; k < pattern[t] && next[t] < types.jobs[t].size(); k++)
+			{
+				machineOf[types.jobs[t][next[t]++]] = i;
+				load[i] += types.size[t];
+			}
+
+	for (size_t t = 0; t < ntypes; t++)
+		while (next[t] < types.jobs[t].size())
+		{
+			int i = (int)(std::min_element(load.begin(), load.end()) - load.begin());
+			machineOf[types.jobs[t][next[t]++]] = i;
+			load[i] += types.size[t];
+		}
+	return *std::max_element(load.begin(), load.end());
+}
+
+// One subgradient trajectory, publishing its bounds and schedules
+static void Trajectory(const JobTypes& types, int jobs, int m,
+	SharedSearch& search, int member, double step, double deadline,
+	std::atomic<long long>& bound, std::atomic<long>& steps,
+	std::atomic<bool>& tooLarge)
+{
+	size_t ntypes = types.size.size();
+
+	// size / m for every job reproduces the volume bound
+	std::vector<double> lambda(ntypes);
+	for (size_t t = 0; t < ntypes; t++)
+		lambda[t] = (double)types.size[t] / m;
+
+	BoundedKnapsack knapsack;
+	std::vector<int> pattern, machineOf(jobs), best;
+	double bestL = -1e300;
+	int stale = 0;
+	while (step >= MinStep && !search.stop && !search.Closed() && WallClock() < deadline)
+	{
+		long long lo = 0, hi = 0x7fffffffffffffffLL;
+		search.Tighten(lo, hi, best);
+		if (!knapsack.Solve(types.size, types.count, lambda, (int)hi, 0.0))
+		{
+			tooLarge = true;
+			return;
+		}
+
+		// L = sum_j lambda_j + min over lo <= C <= hi of C - m K(C)
+		double L = 0;
+		for (size_t t = 0; t < ntypes; t++)
+			L += types.count[t] * lambda[t];
+		long long bestC = hi;
+		double inner = hi - m * knapsack.Value((int)hi);
+		for (long long C = lo; C < hi; C++)
+		{
+			double v = C - m * knapsack.Value((int)C);
+			if (v < inner)
+			{
+				inner = v;
+				bestC = C;
+			}
+		}
+		L += inner;
+		long long value = (long long)ceil(L - 1e-6);
+		search.RaiseBound(member, value);
+		long long current = bound.load();
+		while (value > current && !bound.compare_exchange_weak(current, value))
+			;
+
+		knapsack.Pattern((int)bestC, pattern);
+		long long makespan = PatternSchedule(types, m, pattern, machineOf);
+		search.Offer(member, makespan, machineOf);
+		steps++;
+
+		// g_t = count_t - m pattern_t; zero if the pattern covers the jobs
+		double norm = 0;
+		for (size_t t = 0; t < ntypes; t++)
+		{
+			double g = types.count[t] - (double)m * pattern[t];
+			norm += g * g;
+		}
+		if (norm == 0)
+			break;
+		if (L > bestL + 1e-9)
+		{
+			bestL = L;
+			stale = 0;
+		}
+		else if (++stale >= MaxStaleSteps)
+		{
+			step /= 2;
+			stale = 0;
+		}
+
+		// Polyak's step towards the best makespan
+		double length = step * (hi - L) / norm;
+		for (size_t t = 0; t < ntypes; t++)
+			lambda[t] += length * (types.count[t] - (double)m * pattern[t]);
+	}
+}
+
+UFFLP_StatusType SolveLagrangian(const std::vector<int>& jobSize, int m,
+	const EngineSettings& settings, long long& lowerBound,
+	long long& makespan, std::vector<int>& machineOf)
+{
+	PhaseTimer solveTimer(settings.stats, Phase_Solve);
+	double deadline = WallClock() + settings.timeLimit;
+
+	std::map<int, std::vector<int>, std::greater<int> > bySize;
+	for (size_t j = 0; j < jobSize.size(); j++)
+		bySize[jobSize[j]].push_back((int)j);
+	JobTypes types;
+	for (std::map<int, std::vector<int>, std::greater<int> >::const_iterator it =
+		bySize.begin(); it != bySize.end(); ++it)
+	{
+		types.size.push_back(it->first);
+		types.count.push_back((int)it->second.size());
+		types.jobs.push_back(it->second);
+	}
+
+	// alone, the trajectories share a search of their own
+	SharedSearch local(lowerBound);
+	SharedSearch& search = settings.shared != NULL ? *settings.shared : local;
+	int member = settings.shared != NULL ? settings.member : 0;
+	if (settings.shared == NULL)
+		local.Offer(PresolveMember, makespan, machineOf);
+
+	int threads = settings.threads > 0 ? settings.threads :
+		(int)std::thread::hardware_concurrency();
+	threads = std::max(1, threads);
+	std::atomic<long long> bound(lowerBound);
+	std::atomic<long> steps(0);
+	std::atomic<bool> tooLarge(false);
+	std::vector<std::thread> pool;
+	for (int t = 0; t < threads; t++)
+		pool.push_back(std::thread(Trajectory, std::cref(types), (int)jobSize.size(),
+			m, std::ref(search), member, StartStep * pow(0.5, 0.5 * t), deadline,
+			std::ref(bound), std::ref(steps), std::ref(tooLarge)));
+	for (int t = 0; t < threads; t++)
+		pool[t].join();
+
+	if (tooLarge && settings.log != NULL)
+		fprintf(settings.log, "Lagrangian: the knapsack of capacity %lld is too large\n",
+			makespan);
+	// only the bound of the trajectories counts here: in a portfolio the
+	// shared one may come from another member
+	long long lo = lowerBound;
+	search.Tighten(lo, makespan, machineOf);
+	lowerBound = std::max(lowerBound, bound.load());
+	if (settings.log != NULL)
+		fprintf(settings.log, "Lagrangian: bound %lld, makespan %lld after %ld steps"
+			" on %d threads\n", lowerBound, makespan, steps.load(), threads);
+	return lowerBound >= makespan ? UFFLP_Optimal : UFFLP_Feasible;
+}
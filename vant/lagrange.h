@@ -0,0 +1,43 @@
+/****************************************************************************
+* Lagrangian relaxation of the assignment model
+*
+* Dualizing the assignment rows restr1 with multipliers lambda_j leaves
+*   L(lambda) = sum_j lambda_j + min over C of [ C - sum_i K_i(C) ]
+* where K_i(C) is the largest total multiplier of jobs that fit on machine i
+* within C. The machines are identical, so the m knapsacks are a single
+* one; jobs of the same size share a multiplier and the knapsack bounds the
+* copies of every size. One DP over the capacities up to the best makespan
+* gives K for every C, and C ranges over the known bounds.
+* Subgradient steps (Polyak's rule towards the best makespan) raise the
+* bound. Every step also builds a schedule from the knapsack pattern: the
+* machines take the pattern while its jobs last and LPT places the rest.
+* Several trajectories with different step sizes run on their own threads
+* and share the best bound and schedule.
+*
+*****************************************************************************/
+
+#ifndef __LAGRANGE_H__
+#define __LAGRANGE_H__
+
+#include "UFFLP.h"
+#include "solver.h"
+
+#include <vector>
+
+// Bound the makespan by Lagrangian relaxation, settings.threads
+// trajectories at once (all cores for 0). The solver of the settings is not
+// used; in a portfolio the bound and the schedules are shared as they come.
+// @param jobSize     setup + proctime of every job
+// @param lowerBound  known lower bound on the makespan; the Lagrangian bound
+//                    on return if it is higher
+// @param makespan    makespan of the starting schedule; the best one found
+//                    on return
+// @param machineOf   machine of every job in the starting schedule; the best
+//                    schedule found on return
+// @return UFFLP_Optimal if the bound meets the schedule, UFFLP_Feasible
+//         otherwise
+UFFLP_StatusType SolveLagrangian(const std::vector<int>& jobSize, int m,
+	const EngineSettings& settings, long long& lowerBound,
+	long long& makespan, std::vector<int>& machineOf);
+
+#endif
@@ -0,0 +1,374 @@
+#include "localsearch.h"
+#include "sysutil.h"
+
+#include <algorithm>
+#include <random>
+#include <set>
+#include <thread>
+#include <utility>
+
+SharedSchedule::SharedSchedule() : value(-1)
+{
+}
+
+bool SharedSchedule::Offer(long long makespan, const std::vector<int>& machineOf)
+{
+	long long v = value.load();
+	if (v >= 0 && makespan >= v)
+		return false;
+
+	std::lock_guard<std::mutex> lock(mutex);
+	v = value.load();
+	if (v >= 0 && makespan >= v)
+		return false;
+	schedule = machineOf;
+	value.store(makespan);
+	return true;
+}
+
+long long SharedSchedule::Best(std::vector<int>& machineOf) const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	machineOf = schedule;
+	return value.load();
+}
+
+typedef std::pair<long long, int> LoadKey;   // (load, machine)
+typedef std::pair<int, int> JobKey;          // (size, job)
+
+// A schedule with its loads in an ordered set, the smallest and largest
+// loads being its first and last elements, and the jobs of each machine
+// sorted by size. The moves since the last Commit are journaled so that
+// Undo takes them back one by one.
+class Schedule
+{
+public:
+	Schedule(const std::vector<int>& size, int m);
+
+	void Assign(const std::vector<int>& schedule);
+	void Move(int job, int to);
+	void Commit() { journal.clear(); }
+	void Undo();
+
+	long long Makespan() const { return byLoad.rbegin()->first; }
+	int Critical() const { return byLoad.rbegin()->second; }
+
+	const std::vector<int>& size;
+	int m;
+	std::vector<int> machineOf;
+	std::vector<long long> load;
+	std::set<LoadKey> byLoad;
+	std::vector<std::set<JobKey> > jobs;
+	std::vector<std::pair<int, int> > journal;   // (job, machine it left)
+};
+
+Schedule::Schedule(const std::vector<int>& size, int m) : size(size), m(m)
+{
+}
+
+void Schedule::Assign(const std::vector<int>& schedule)
+{
+	machineOf = schedule;
+	load.assign(m, 0);
+	jobs.assign(m, std::set<JobKey>());
+	for (size_t j = 0; j < size.size(); j++)
+	{
+		load[machineOf[j]] += size[j];
+		jobs[machineOf[j]].insert(JobKey(size[j], (int)j));
+	}
+	byLoad.clear();
+	for (int i = 0; i < m; i++)
+		byLoad.insert(LoadKey(load[i], i));
+	journal.clear();
+}
+
+void Schedule::Move(int job, int to)
+{
+	int from = machineOf[job];
+	if (from == to)
+		return;
+
+	byLoad.erase(LoadKey(load[from], from));
+	byLoad.erase(LoadKey(load[to], to));
+	load[from] -= size[job];
+	load[to] += size[job];
+	byLoad.insert(LoadKey(load[from], from));
+	byLoad.insert(LoadKey(load[to], to));
+
+	jobs[from].erase(JobKey(size[job], job));
+	jobs[to].insert(JobKey(size[job], job));
+	machineOf[job] = to;
+	journal.push_back(std::make_pair(job, from));
+}
+
+void Schedule::Undo()
+{
+	while (!journal.empty())
+	{
+		std::pair<int, int> last = journal.back();
+		Move(last.first, last.second);
+		journal.pop_back();   // the move back
+		journal.pop_back();
+	}
+}
+
+// Every improving move below lowers the critical machine and keeps the
+// machines it touches under the makespan, so the number of machines at the
+// makespan (or the makespan itself) decreases.
+
+// Pairs of jobs, or of a job and a machine, that a swap or an ejection
+// examines before giving up; each costs O(log n)
+static const int ScanLimit = 64;
+
+// Move a job of the critical machine to the least loaded one, the job whose
+// size is closest to half of the load difference.
+static bool TryMove(Schedule& s)
+{
+	int c = s.Critical();
+	int k = s.byLoad.begin()->second;
+	long long gap = s.load[c] - s.load[k];
+	if (k == c || gap <= 1)
+		return false;
+
+	int best = -1;
+	long long bestMax = s.load[c];
+	std::set<JobKey>::iterator it = s.jobs[c].lower_bound(JobKey((int)(gap / 2), -1));
+	for (int q = 0; q < 2; q++)
+	{
+		if (q == 1)
+		{
+			if (it == s.jobs[c].begin())
+				break;
+			--it;
+		}
+		if (it == s.jobs[c].end() || it->first <= 0 || it->first >= gap)
+			continue;
+		long long top = std::max(s.load[c] - it->first, s.load[k] + it->first);
+		if (top < bestMax)
+		{
+			best = it->second;
+			bestMax = top;
+		}
+	}
+	if (best < 0)
+		return false;
+	s.Move(best, k);
+	return true;
+}
+
+// Swap a job of the critical machine with a smaller one of another machine,
+// the size difference closest to half of the load difference. The least
+// loaded machines and the largest jobs of c come first.
+static bool TrySwap(Schedule& s)
+{
+	int c = s.Critical();
+	int scanned = 0;
+
+	for (std::set<LoadKey>::iterator mk = s.byLoad.begin(); mk != s.byLoad.end(); ++mk)
+	{
+		int k = mk->second;
+		long long gap = s.load[c] - mk->first;
+		if (gap <= 1)
+			break;   // loads only grow from here
+		if (k == c)
+			continue;
+
+		int bestJ = -1, bestI = -1;
+		long long bestDist = gap;
+		for (std::set<JobKey>::reverse_iterator jt = s.jobs[c].rbegin();
+			jt != s.jobs[c].rend() && scanned < ScanLimit; ++jt, ++scanned)
+		{
+			long long target = jt->first - gap / 2;
+			std::set<JobKey>::iterator it = s.jobs[k].lower_bound(JobKey((int)std::max(0LL, target), -1));
+			for (int q = 0; q < 2; q++)
+			{
+				if (q == 1)
+				{
+					if (it == s.jobs[k].begin())
+						break;
+					--it;
+				}
+				if (it == s.jobs[k].end())
+					continue;
+				long long delta = jt->first - it->first;
+				if (delta <= 0 || delta >= gap)
+					continue;
+				long long dist = delta > gap / 2 ? delta - gap / 2 : gap / 2 - delta;
+				if (dist < bestDist)
+				{
+					bestDist = dist;
+					bestJ = jt->second;
+					bestI = it->second;
+				}
+			}
+		}
+		if (bestJ >= 0)
+		{
+			s.Move(bestJ, k);
+			s.Move(bestI, c);
+			return true;
+		}
+		if (scanned >= ScanLimit)
+			break;
+	}
+	return false;
+}
+
+// Ejection chain of length two: a job of the critical machine goes to a
+// machine k that it would overflow, and the smallest job of k that makes
+// room moves on to the least loaded third machine.
+static bool TryEject(Schedule& s)
+{
+	int c = s.Critical();
+	long long C = s.load[c];
+
+	// the two least loaded machines other than c: the third machine is the
+	// first one unless it is k
+	int low[2] = { -1, -1 };
+	for (std::set<LoadKey>::iterator ml = s.byLoad.begin();
+		ml != s.byLoad.end() && low[1] < 0; ++ml)
+		if (ml->second != c)
+			low[low[0] < 0 ? 0 : 1] = ml->second;
+	if (low[1] < 0)
+		return false;
+
+	int scanned = 0;
+	for (std::set<JobKey>::reverse_iterator jt = s.jobs[c].rbegin(); jt != s.jobs[c].rend(); ++jt)
+	{
+		if (jt->first <= 0)
+			break;
+		for (std::set<LoadKey>::iterator mk = s.byLoad.begin(); mk != s.byLoad.end(); ++mk)
+		{
+			int k = mk->second;
+			if (k == c)
+				continue;
+			if (++scanned > ScanLimit)
+				return false;
+
+			int l = low[0] != k ? low[0] : low[1];
+			long long lo = s.load[k] + jt->first - C + 1;
+			long long hi = C - 1 - s.load[l];
+			if (lo > hi)
+				continue;
+			std::set<JobKey>::iterator it = s.jobs[k].lower_bound(JobKey((int)std::max(0LL, lo), -1));
+			if (it == s.jobs[k].end() || it->first > hi)
+				continue;
+
+			int j = jt->second, i = it->second;
+			s.Move(j, k);
+			s.Move(i, l);
+			return true;
+		}
+	}
+	return false;
+}
+
+static void Descend(Schedule& s)
+{
+	while (TryMove(s) || TrySwap(s) || TryEject(s))
+		;
+}
+
+// Random moves and swaps
+static void Shake(Schedule& s, int strength, std::mt19937& rng)
+{
+	int n = (int)s.size.size();
+	if (n == 0 || s.m < 2)
+		return;
+
+	std::uniform_int_distribution<int> anyJob(0, n - 1);
+	std::uniform_int_distribution<int> otherMachine(1, s.m - 1);
+	for (int r = 0; r < strength; r++)
+	{
+		int j = anyJob(rng);
+		if (rng() & 1)
+		{
+			s.Move(j, (s.machineOf[j] + otherMachine(rng)) % s.m);
+			continue;
+		}
+		int i = anyJob(rng);
+		int a = s.machineOf[j], b = s.machineOf[i];
+		if (a != b)
+		{
+			s.Move(j, b);
+			s.Move(i, a);
+		}
+	}
+}
+
+// Restart from the shared best after this many shakes without improvement
+static const int StallRestart = 500;
+
+static void SearchThread(const std::vector<int>& size, int m,
+	const LocalSearchSettings& settings, int index, double deadline,
+	SharedSchedule& best)
+{
+	std::mt19937 rng(settings.seed + index);
+	Schedule s(size, m);
+	std::vector<int> current;
+
+	best.Best(current);
+	s.Assign(current);
+	// the other threads start from a shaken copy
+	if (index > 0)
+		Shake(s, std::max(1, (int)size.size() / 10), rng);
+	Descend(s);
+	s.Commit();
+	long long value = s.Makespan();
+	best.Offer(value, s.machineOf);
+
+	int maxStrength = std::max(2, std::min((int)size.size(), 12));
+	int strength = 1, stall = 0;
+	for (;;)
+	{
+		if (best.Value() <= settings.lowerBound || WallClock() >= deadline ||
+			(settings.stop != NULL && settings.stop->load()))
+			break;
+
+		Shake(s, strength, rng);
+		Descend(s);
+		long long v = s.Makespan();
+		if (v < value)
+		{
+			s.Commit();
+			value = v;
+			best.Offer(value, s.machineOf);
+			strength = 1;
+			stall = 0;
+			continue;
+		}
+
+		// equal schedules are accepted to walk along plateaus
+		if (v == value)
+			s.Commit();
+		else
+			s.Undo();
+		strength = strength % maxStrength + 1;
+
+		if (++stall >= StallRestart)
+		{
+			if (best.Value() < value)
+			{
+				value = best.Best(current);
+				s.Assign(current);
+			}
+			stall = 0;
+		}
+	}
+}
+
+long long IteratedLocalSearch(const std::vector<int>& size, int m,
+	const LocalSearchSettings& settings, SharedSchedule& best)
+{
+	double deadline = WallClock() + settings.timeLimit;
+	int threads = std::max(1, settings.threads);
+	std::vector<std::thread> workers;
+
+	for (int k = 1; k < threads; k++)
+		workers.push_back(std::thread(SearchThread, std::cref(size), m,
+			std::cref(settings), k, deadline, std::ref(best)));
+	SearchThread(size, m, settings, 0, deadline, best);
+	for (size_t k = 0; k < workers.size(); k++)
+		workers[k].join();
+	return best.Value();
+}
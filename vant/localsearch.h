@@ -0,0 +1,60 @@
+/****************************************************************************
+* Iterated local search for the UAV makespan problem
+*
+* Every thread descends with three neighbourhoods around the critical
+* machine (move a job, swap two jobs, and a move that ejects a job of the
+* target machine to a third one), then shakes the local optimum with a
+* growing number of random moves, as in variable neighbourhood search.
+* Loads are kept in an ordered set that serves as a double-ended heap and
+* the jobs of every machine in a set sorted by size, so a move is evaluated
+* and applied in O(log n); a neighbourhood examines a bounded number of
+* moves, and a rejected shake is undone move by move. Threads start from
+* different seeds and share the best schedule found.
+*
+*****************************************************************************/
+
+#ifndef __LOCAL_SEARCH_H__
+#define __LOCAL_SEARCH_H__
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+// Best schedule found by any thread
+class SharedSchedule
+{
+public:
+	SharedSchedule();
+
+	// Keep the schedule if its makespan is below the best one.
+	// @return true if it was kept
+	bool Offer(long long makespan, const std::vector<int>& machineOf);
+
+	// Copy the best schedule into machineOf.
+	// @return its makespan, -1 if none was offered
+	long long Best(std::vector<int>& machineOf) const;
+
+	// Makespan of the best schedule, -1 if none was offered
+	long long Value() const { return value.load(); }
+
+private:
+	mutable std::mutex mutex;
+	std::atomic<long long> value;
+	std::vector<int> schedule;
+};
+
+struct LocalSearchSettings
+{
+	int threads;
+	double timeLimit;                 // seconds
+	unsigned seed;                    // thread k uses seed + k
+	long long lowerBound;             // stop when the best schedule reaches it
+	const std::atomic<bool>* stop;    // optional, stop when set
+};
+
+// Run the search from the schedule in best, which must hold one.
+// @return the makespan of the best schedule
+long long IteratedLocalSearch(const std::vector<int>& size, int m,
+	const LocalSearchSettings& settings, SharedSchedule& best);
+
+#endif
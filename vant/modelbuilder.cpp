@@ -0,0 +1,405 @@
+#include "modelbuilder.h"
+
+#include <stdio.h>
+#include <string.h>
+
+// Values at or beyond this magnitude are treated as infinite bounds
+static const double InfBound = UFFLP_Infinity;
+
+// Write a non-negative integer at buf, returning the number of digits
+static int AppendInt(char* buf, int v)
+{
+	char tmp[12];
+	int len = 0;
+
+	do {
+		tmp[len++] = (char)('0' + v % 10);
+		v /= 10;
+	} while (v > 0);
+
+	for (int k = 0; k < len; k++)
+		buf[k] = tmp[len - 1 - k];
+	return len;
+}
+
+ModelBuilder::ModelBuilder(UFFLP_ObjSense sense) : sense(sense)
+{
+	rowStart.push_back(0);
+}
+
+int ModelBuilder::AddVariable(const char* name, double lb, double ub,
+	double obj, UFFLP_VarType type)
+{
+	NameBlock block;
+	block.prefix = name;
+	block.first = NumVariables();
+	block.cols = 0;
+	block.scalar = true;
+	varBlocks.push_back(block);
+
+	this->lb.push_back(lb);
+	this->ub.push_back(ub);
+	this->obj.push_back(obj);
+	this->type.push_back(type);
+	return block.first;
+}
+
+int ModelBuilder::AddVariableBlock(const char* prefix, int rows, int cols,
+	double lb, double ub, double obj, UFFLP_VarType type)
+{
+	NameBlock block;
+	block.prefix = prefix;
+	block.first = NumVariables();
+	block.cols = cols;
+	block.scalar = false;
+	varBlocks.push_back(block);
+
+	size_t count = (size_t)rows * (cols > 0 ? cols : 1);
+	this->lb.insert(this->lb.end(), count, lb);
+	this->ub.insert(this->ub.end(), count, ub);
+	this->obj.insert(this->obj.end(), count, obj);
+	this->type.insert(this->type.end(), count, type);
+	return block.first;
+}
+
+void ModelBuilder::BeginConstraintBlock(const char* prefix)
+{
+	NameBlock block;
+	block.prefix = prefix;
+	block.first = NumConstraints();
+	block.cols = 0;
+	block.scalar = false;
+	consBlocks.push_back(block);
+}
+
+void ModelBuilder::AddCoefficient(int col, double value)
+{
+	colIdx.push_back(col);
+	this->value.push_back(value);
+}
+
+int ModelBuilder::EndRow(double rhs, UFFLP_ConsType type)
+{
+	if (consBlocks.empty())
+		BeginConstraintBlock("c");
+
+	rowStart.push_back((int)colIdx.size());
+	this->rhs.push_back(rhs);
+	sign.push_back(type);
+	return NumConstraints() - 1;
+}
+
+void ModelBuilder::Reserve(int vars, int cons, size_t nonzeros)
+{
+	lb.reserve(vars);
+	ub.reserve(vars);
+	obj.reserve(vars);
+	type.reserve(vars);
+	rowStart.reserve(cons + 1);
+	rhs.reserve(cons);
+	sign.reserve(cons);
+	colIdx.reserve(nonzeros);
+	value.reserve(nonzeros);
+}
+
+int ModelBuilder::FormatName(const std::vector<NameBlock>& blocks, int index,
+	char* buf)
+{
+	// find the last block starting at or before index
+	size_t lo = 0, hi = blocks.size();
+	while (hi - lo > 1)
+	{
+		size_t mid = (lo + hi) / 2;
+		if (blocks[mid].first <= index)
+			lo = mid;
+		else
+			hi = mid;
+	}
+	const NameBlock& block = blocks[lo];
+
+	int len = (int)block.prefix.size();
+	memcpy(buf, block.prefix.c_str(), len);
+	if (!block.scalar)
+	{
+		int k = index - block.first;
+		buf[len++] = '_';
+		if (block.cols > 0)
+		{
+			len += AppendInt(buf + len, k / block.cols);
+			buf[len++] = '_';
+			len += AppendInt(buf + len, k % block.cols);
+		}
+		else
+			len += AppendInt(buf + len, k);
+	}
+	buf[len] = '\0';
+	return len;
+}
+
+int ModelBuilder::VarName(int col, char* buf) const
+{
+	return FormatName(varBlocks, col, buf);
+}
+
+int ModelBuilder::ConsName(int row, char* buf) const
+{
+	return FormatName(consBlocks, row, buf);
+}
+
+void ModelBuilder::VarNamePool(std::vector<char>& pool,
+	std::vector<size_t>& offset) const
+{
+	char buf[MaxNameLen];
+
+	pool.clear();
+	pool.reserve((size_t)NumVariables() * 10);
+	offset.resize(NumVariables());
+	for (int j = 0; j < NumVariables(); j++)
+	{
+		int len = VarName(j, buf);
+		offset[j] = pool.size();
+		pool.insert(pool.end(), buf, buf + len + 1);
+	}
+}
+
+void ModelBuilder::ConsNamePool(std::vector<char>& pool,
+	std::vector<size_t>& offset) const
+{
+	char buf[MaxNameLen];
+
+	pool.clear();
+	offset.resize(NumConstraints());
+	for (int i = 0; i < NumConstraints(); i++)
+	{
+		int len = ConsName(i, buf);
+		offset[i] = pool.size();
+		pool.insert(pool.end(), buf, buf + len + 1);
+	}
+}
+
+#ifdef VANT_WITH_UFFLP
+UFFLP_ErrorType ModelBuilder::LoadInto(UFFProblem* prob) const
+{
+	std::vector<char> pool;
+	std::vector<size_t> offset;
+
+	VarNamePool(pool, offset);
+	return LoadInto(prob, pool, offset);
+}
+
+UFFLP_ErrorType ModelBuilder::LoadInto(UFFProblem* prob,
+	std::vector<char>& pool, const std::vector<size_t>& offset) const
+{
+	int nvars = NumVariables();
+	UFFLP_ErrorType err;
+	char buf[MaxNameLen];
+
+	for (int j = 0; j < nvars; j++)
+	{
+		err = UFFLP_AddVariable(prob, &pool[offset[j]], lb[j], ub[j], obj[j],
+			type[j]);
+		if (err != UFFLP_Ok)
+			return err;
+	}
+
+	for (int i = 0; i < NumConstraints(); i++)
+	{
+		ConsName(i, buf);
+		for (int k = rowStart[i]; k < rowStart[i + 1]; k++)
+		{
+			err = UFFLP_SetCoefficient(prob, buf, &pool[offset[colIdx[k]]],
+				value[k]);
+			if (err != UFFLP_Ok)
+				return err;
+		}
+		err = UFFLP_AddConstraint(prob, buf, rhs[i], sign[i]);
+		if (err != UFFLP_Ok)
+			return err;
+	}
+
+	return UFFLP_Ok;
+}
+#endif // VANT_WITH_UFFLP
+
+// Write one linear term; long expressions are wrapped as CPLEX does
+static void WriteTerm(FILE* f, double coef, const char* name, int& terms,
+	bool first)
+{
+	if (terms > 0 && terms % 8 == 0)
+		fputs("\n      ", f);
+
+	if (coef < 0)
+		fputs(first ? "- " : " - ", f);
+	else if (!first)
+		fputs(" + ", f);
+
+	double a = coef < 0 ? -coef : coef;
+	if (a != 1.0)
+		fprintf(f, "%.15g ", a);
+	fputs(name, f);
+	terms++;
+}
+
+bool ModelBuilder::WriteLP(FILE* f) const
+{
+	int nvars = NumVariables();
+	char name[MaxNameLen];
+	int terms;
+
+	fputs("\\ENCODING=ISO-8859-1\n\\Problem name: \n\n", f);
+	fputs(sense == UFFLP_Minimize ? "Minimize\n" : "Maximize\n", f);
+	fputs(" obj:", f);
+	terms = 0;
+	for (int j = 0; j < nvars; j++)
+	{
+		if (obj[j] == 0.0)
+			continue;
+		VarName(j, name);
+		fputc(' ', f);
+		WriteTerm(f, obj[j], name, terms, terms == 0);
+	}
+
+	fputs("\nSubject To\n", f);
+	for (int i = 0; i < NumConstraints(); i++)
+	{
+		ConsName(i, name);
+		fprintf(f, " %s: ", name);
+		terms = 0;
+		for (int k = rowStart[i]; k < rowStart[i + 1]; k++)
+		{
+			VarName(colIdx[k], name);
+			WriteTerm(f, value[k], name, terms, k == rowStart[i]);
+		}
+		fprintf(f, " %s %.15g\n",
+			sign[i] == UFFLP_Less ? "<=" : (sign[i] == UFFLP_Equal ? " =" : ">="),
+			rhs[i]);
+	}
+
+	fputs("Bounds\n", f);
+	for (int j = 0; j < nvars; j++)
+	{
+		VarName(j, name);
+		if (lb[j] <= -InfBound && ub[j] >= InfBound)
+			fprintf(f, "      %s Free\n", name);
+		else if (ub[j] >= InfBound)
+			fprintf(f, "      %s >= %.15g\n", name, lb[j]);
+		else if (lb[j] <= -InfBound)
+			fprintf(f, " -inf <= %s <= %.15g\n", name, ub[j]);
+		else
+			fprintf(f, " %.15g <= %s <= %.15g\n", lb[j], name, ub[j]);
+	}
+
+	// integrality sections
+	const UFFLP_VarType sections[2] = { UFFLP_Binary, UFFLP_Integer };
+	const char* titles[2] = { "Binaries\n", "Generals\n" };
+	for (int s = 0; s < 2; s++)
+	{
+		terms = 0;
+		for (int j = 0; j < nvars; j++)
+		{
+			if (type[j] != sections[s])
+				continue;
+			if (terms == 0)
+				fputs(titles[s], f);
+			VarName(j, name);
+			fprintf(f, " %s ", name);
+			if (++terms % 8 == 0)
+				fputc('\n', f);
+		}
+		if (terms > 0 && terms % 8 != 0)
+			fputc('\n', f);
+	}
+
+	fputs("End\n", f);
+	return ferror(f) == 0;
+}
+
+bool ModelBuilder::WriteMPS(FILE* f) const
+{
+	int nvars = NumVariables();
+	int ncons = NumConstraints();
+	char name[MaxNameLen], row[MaxNameLen];
+
+	fputs("NAME vant\n", f);
+	fputs(sense == UFFLP_Minimize ? "OBJSENSE\n    MIN\n" : "OBJSENSE\n    MAX\n", f);
+	fputs("ROWS\n N  obj\n", f);
+	for (int i = 0; i < ncons; i++)
+	{
+		ConsName(i, name);
+		fprintf(f, " %c  %s\n",
+			sign[i] == UFFLP_Less ? 'L' : (sign[i] == UFFLP_Equal ? 'E' : 'G'), name);
+	}
+
+	// the rows are stored by row, MPS lists the coefficients by column
+	std::vector<int> colStart(nvars + 1, 0), rowOf(colIdx.size());
+	std::vector<double> colValue(colIdx.size());
+	for (size_t k = 0; k < colIdx.size(); k++)
+		colStart[colIdx[k] + 1]++;
+	for (int j = 0; j < nvars; j++)
+		colStart[j + 1] += colStart[j];
+	std::vector<int> next(colStart.begin(), colStart.end() - 1);
+	for (int i = 0; i < ncons; i++)
+		for (int k = rowStart[i]; k < rowStart[i + 1]; k++)
+		{
+			int pos = next[colIdx[k]]++;
+			rowOf[pos] = i;
+			colValue[pos] = value[k];
+		}
+
+	fputs("COLUMNS\n", f);
+	bool integer = false;
+	int markers = 0;
+	for (int j = 0; j < nvars; j++)
+	{
+		bool isInteger = type[j] != UFFLP_Continuous;
+		if (isInteger != integer)
+		{
+			fprintf(f, "    MARKER%d 'MARKER' '%s'\n", markers++,
+				isInteger ? "INTORG" : "INTEND");
+			integer = isInteger;
+		}
+		VarName(j, name);
+		if (obj[j] != 0.0)
+			fprintf(f, "    %s obj %.15g\n", name, obj[j]);
+		for (int k = colStart[j]; k < colStart[j + 1]; k++)
+		{
+			ConsName(rowOf[k], row);
+			fprintf(f, "    %s %s %.15g\n", name, row, colValue[k]);
+		}
+	}
+	if (integer)
+		fprintf(f, "    MARKER%d 'MARKER' 'INTEND'\n", markers);
+
+	fputs("RHS\n", f);
+	for (int i = 0; i < ncons; i++)
+	{
+		if (rhs[i] == 0.0)
+			continue;
+		ConsName(i, name);
+		fprintf(f, "    rhs %s %.15g\n", name, rhs[i]);
+	}
+
+	// only the bounds that differ from [0, inf), and an explicit infinite
+	// upper bound for the integers, which some readers default to 1
+	fputs("BOUNDS\n", f);
+	for (int j = 0; j < nvars; j++)
+	{
+		VarName(j, name);
+		if (lb[j] <= -InfBound && ub[j] >= InfBound)
+		{
+			fprintf(f, " FR bnd %s\n", name);
+			continue;
+		}
+		if (lb[j] <= -InfBound)
+			fprintf(f, " MI bnd %s\n", name);
+		else if (lb[j] != 0.0)
+			fprintf(f, " LO bnd %s %.15g\n", name, lb[j]);
+		if (ub[j] < InfBound)
+			fprintf(f, " UP bnd %s %.15g\n", name, ub[j]);
+		else if (type[j] != UFFLP_Continuous)
+			fprintf(f, " PL bnd %s\n", name);
+	}
+
+	fputs("ENDATA\n", f);
+	return ferror(f) == 0;
+}
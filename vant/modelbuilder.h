@@ -0,0 +1,113 @@
+/****************************************************************************
+* ModelBuilder - index-based construction of MIP models
+*
+* Variables and constraints are addressed by their integer position. Rows are
+* accumulated in compressed sparse row (CSR) form and handed to the solver in a
+* single pass. Names are never stored: they are generated from the pattern of
+* the block a variable or constraint belongs to, and only when a solver or an
+* LP export actually asks for them.
+*
+*****************************************************************************/
+
+#ifndef __MODEL_BUILDER_H__
+#define __MODEL_BUILDER_H__
+
+#include "UFFLP.h"
+
+#include <stddef.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+class ModelBuilder
+{
+public:
+	ModelBuilder(UFFLP_ObjSense sense = UFFLP_Minimize);
+
+	// Insert a single variable with a fixed name.
+	// @return the index of the new variable
+	int AddVariable(const char* name, double lb, double ub, double obj,
+		UFFLP_VarType type);
+
+	// Insert a block of rows*cols variables named "prefix_i_j" (or "prefix_i"
+	// when cols is zero), stored in row-major order.
+	// @return the index of the first variable of the block
+	int AddVariableBlock(const char* prefix, int rows, int cols, double lb,
+		double ub, double obj, UFFLP_VarType type);
+
+	// Start a new block of constraints named "prefix_k", k counting from zero
+	// within the block.
+	void BeginConstraintBlock(const char* prefix);
+
+	// Append a coefficient to the row currently under construction.
+	void AddCoefficient(int col, double value);
+
+	// Close the row under construction.
+	// @return the index of the new constraint
+	int EndRow(double rhs, UFFLP_ConsType type);
+
+	// Reserve storage for the expected model size.
+	void Reserve(int vars, int cons, size_t nonzeros);
+
+	int NumVariables() const { return (int)lb.size(); }
+	int NumConstraints() const { return (int)rhs.size(); }
+	size_t NumNonzeros() const { return colIdx.size(); }
+
+	// Format the name of a variable or constraint into buf.
+	// @return the number of characters written
+	int VarName(int col, char* buf) const;
+	int ConsName(int row, char* buf) const;
+
+	// Format all variable (or constraint) names into a single pool of
+	// zero-terminated strings; offset[k] locates the name of entity k.
+	void VarNamePool(std::vector<char>& pool, std::vector<size_t>& offset) const;
+	void ConsNamePool(std::vector<char>& pool, std::vector<size_t>& offset) const;
+
+#ifdef VANT_WITH_UFFLP
+	// Load the whole model into an UFFLP problem. UFFLP only accepts named
+	// entities, so every variable name is formatted exactly once and reused
+	// for all of its coefficients.
+	// @return the first error reported by UFFLP or UFFLP_Ok
+	UFFLP_ErrorType LoadInto(UFFProblem* prob) const;
+	UFFLP_ErrorType LoadInto(UFFProblem* prob, std::vector<char>& varPool,
+		const std::vector<size_t>& varOffset) const;
+#endif
+
+	// Write the model in the CPLEX LP format, or in free MPS.
+	// @return false on a write error
+	bool WriteLP(FILE* f) const;
+	bool WriteMPS(FILE* f) const;
+
+	UFFLP_ObjSense sense;
+
+	// column data
+	std::vector<double> lb, ub, obj;
+	std::vector<UFFLP_VarType> type;
+
+	// row data (CSR)
+	std::vector<int> rowStart;
+	std::vector<int> colIdx;
+	std::vector<double> value;
+	std::vector<double> rhs;
+	std::vector<UFFLP_ConsType> sign;
+
+	// Maximum length of a generated name, including the terminator
+	enum { MaxNameLen = 64 };
+
+private:
+	struct NameBlock
+	{
+		std::string prefix;
+		int first;   // index of the first entity in the block
+		int cols;    // second dimension, 0 for one-dimensional blocks
+		bool scalar; // a single entity named after the prefix itself
+	};
+
+	static int FormatName(const std::vector<NameBlock>& blocks, int index,
+		char* buf);
+
+	std::vector<NameBlock> varBlocks;
+	std::vector<NameBlock> consBlocks;
+};
+
+#endif
@@ -0,0 +1,238 @@
+#include "models.h"
+
+#include <algorithm>
+#include <map>
+#include <utility>
+
+void JobSizes(int n, const int* proctime, const int* setup,
+	std::vector<int>& size)
+{
+	size.resize(n);
+	for (int j = 0; j < n; j++)
+		size[j] = setup[j] + proctime[j];
+}
+
+void GroupJobTypes(int n, const int* proctime, const int* setup,
+	JobTypes& types)
+{
+	std::map<std::pair<int, int>, int> typeOf;
+
+	types.proctime.clear();
+	types.setup.clear();
+	types.jobs.clear();
+	for (int j = 0; j < n; j++)
+	{
+		std::pair<int, int> key(proctime[j], setup[j]);
+		std::map<std::pair<int, int>, int>::iterator it = typeOf.find(key);
+		if (it == typeOf.end())
+		{
+			it = typeOf.insert(std::make_pair(key, (int)types.jobs.size())).first;
+			types.proctime.push_back(proctime[j]);
+			types.setup.push_back(setup[j]);
+			types.jobs.push_back(std::vector<int>());
+		}
+		types.jobs[it->second].push_back(j);
+	}
+}
+
+void BuildAssignmentModel(ModelBuilder& model, int n, int m,
+	const int* proctime, const int* setup)
+{
+	int i, j;
+
+	model.Reserve(1 + n * m, n + m, (size_t)2 * n * m + m);
+
+	model.AddVariable("C_max", 0.0, UFFLP_Infinity, 1.0, UFFLP_Integer);
+	model.AddVariableBlock("x", m, n, 0.0, 1.0, 0.0, UFFLP_Binary);
+
+	model.BeginConstraintBlock("restr1");
+	for (j = 0; j < n; j++)
+	{
+		for (i = 0; i < m; i++)
+			model.AddCoefficient(AssignColumn(n, i, j), 1);
+		model.EndRow(1, UFFLP_Equal);
+	}
+
+	model.BeginConstraintBlock("restr2");
+	for (i = 0; i < m; i++)
+	{
+		for (j = 0; j < n; j++)
+			model.AddCoefficient(AssignColumn(n, i, j), setup[j] + proctime[j]);
+		model.AddCoefficient(CmaxColumn, -1);
+		model.EndRow(0, UFFLP_Less);
+	}
+}
+
+void BuildAggregatedModel(ModelBuilder& model, const JobTypes& types, int m)
+{
+	int ntypes = (int)types.jobs.size();
+	int i, t;
+
+	model.Reserve(1 + ntypes * m, ntypes + m, (size_t)2 * ntypes * m + m);
+
+	model.AddVariable("C_max", 0.0, UFFLP_Infinity, 1.0, UFFLP_Integer);
+	model.AddVariableBlock("y", m, ntypes, 0.0, 1.0, 0.0, UFFLP_Integer);
+	for (i = 0; i < m; i++)
+		for (t = 0; t < ntypes; t++)
+			model.ub[TypeColumn(ntypes, i, t)] = (double)types.jobs[t].size();
+
+	model.BeginConstraintBlock("restr1");
+	for (t = 0; t < ntypes; t++)
+	{
+		for (i = 0; i < m; i++)
+			model.AddCoefficient(TypeColumn(ntypes, i, t), 1);
+		model.EndRow((double)types.jobs[t].size(), UFFLP_Equal);
+	}
+
+	model.BeginConstraintBlock("restr2");
+	for (i = 0; i < m; i++)
+	{
+		for (t = 0; t < ntypes; t++)
+			model.AddCoefficient(TypeColumn(ntypes, i, t),
+				types.setup[t] + types.proctime[t]);
+		model.AddCoefficient(CmaxColumn, -1);
+		model.EndRow(0, UFFLP_Less);
+	}
+}
+
+void BuildTimeIndexedModel(ModelBuilder& model, int m,
+	const std::vector<long long>& length,
+	const std::vector<std::pair<int, int> >& arcs,
+	const std::vector<long long>& est, const std::vector<long long>& lst,
+	long long lowerBound, long long horizon, std::vector<int>& first)
+{
+	int n = (int)length.size();
+	int columns = 0;
+
+	first.resize(n);
+	for (int j = 0; j < n; j++)
+	{
+		first[j] = 1 + columns;
+		columns += (int)(lst[j] - est[j] + 1);
+	}
+	model.AddVariable("C_max", (double)lowerBound, (double)horizon, 1.0,
+		UFFLP_Integer);
+	model.AddVariableBlock("x", columns, 0, 0.0, 1.0, 0.0, UFFLP_Binary);
+
+	model.BeginConstraintBlock("start");
+	for (int j = 0; j < n; j++)
+	{
+		for (long long t = est[j]; t <= lst[j]; t++)
+			model.AddCoefficient(first[j] + (int)(t - est[j]), 1);
+		model.EndRow(1, UFFLP_Equal);
+	}
+
+	// x_j_s runs over the periods s .. s + length - 1
+	std::vector<std::pair<long long, int> > terms;
+	for (int j = 0; j < n; j++)
+		for (long long s = est[j]; s <= lst[j]; s++)
+			for (long long t = s; t < s + length[j]; t++)
+				terms.push_back(std::make_pair(t, first[j] + (int)(s - est[j])));
+	std::sort(terms.begin(), terms.end());
+	model.BeginConstraintBlock("cap");
+	for (size_t k = 0; k < terms.size(); )
+	{
+		long long t = terms[k].first;
+		for (; k < terms.size() && terms[k].first == t; k++)
+			model.AddCoefficient(terms[k].second, 1);
+		model.EndRow(m, UFFLP_Less);
+	}
+
+	// S_b - S_a >= length[a], with S_j = sum of t x_j_t
+	std::vector<char> hasSuccessor(n, 0);
+	model.BeginConstraintBlock("prec");
+	for (size_t k = 0; k < arcs.size(); k++)
+	{
+		int a = arcs[k].first, b = arcs[k].second;
+		hasSuccessor[a] = 1;
+		for (long long t = est[b]; t <= lst[b]; t++)
+			model.AddCoefficient(first[b] + (int)(t - est[b]), (double)t);
+		for (long long t = est[a]; t <= lst[a]; t++)
+			model.AddCoefficient(first[a] + (int)(t - est[a]), -(double)t);
+		model.EndRow((double)length[a], UFFLP_Greater);
+	}
+
+	model.BeginConstraintBlock("cmax");
+	for (int j = 0; j < n; j++)
+	{
+		if (hasSuccessor[j])
+			continue;
+		model.AddCoefficient(CmaxColumn, 1);
+		for (long long t = est[j]; t <= lst[j]; t++)
+			model.AddCoefficient(first[j] + (int)(t - est[j]), -(double)t);
+		model.EndRow((double)length[j], UFFLP_Greater);
+	}
+}
+
+void ExpandTypeCounts(const JobTypes& types, int m,
+	const std::vector<int>& count, std::vector<int>& machineOf)
+{
+	int ntypes = (int)types.jobs.size();
+
+	for (int t = 0; t < ntypes; t++)
+	{
+		size_t next = 0;
+		for (int i = 0; i < m; i++)
+			for (int k = 0; k < count[i * ntypes + t] && next < types.jobs[t].size(); k++)
+				machineOf[types.jobs[t][next++]] = i;
+	}
+}
+
+void AddLoadOrdering(ModelBuilder& model, int m,
+	const std::vector<int>& weight)
+{
+	int width = (int)weight.size();
+
+	model.BeginConstraintBlock("sym");
+	for (int i = 0; i + 1 < m; i++)
+	{
+		for (int k = 0; k < width; k++)
+		{
+			model.AddCoefficient(1 + i * width + k, weight[k]);
+			model.AddCoefficient(1 + (i + 1) * width + k, -weight[k]);
+		}
+		model.EndRow(0, UFFLP_Greater);
+	}
+}
+
+void FixJobsToMachines(ModelBuilder& model, int n, int m,
+	const std::vector<int>& order)
+{
+	for (int k = 0; k < n; k++)
+		for (int i = k + 1; i < m; i++)
+			model.ub[AssignColumn(n, i, order[k])] = 0.0;
+}
+
+void RelabelByLoad(const std::vector<int>& size, int m,
+	std::vector<int>& machineOf)
+{
+	std::vector<long long> load(m, 0);
+	std::vector<int> byLoad(m), label(m);
+
+	for (size_t j = 0; j < machineOf.size(); j++)
+		load[machineOf[j]] += size[j];
+	for (int i = 0; i < m; i++)
+		byLoad[i] = i;
+	std::stable_sort(byLoad.begin(), byLoad.end(),
+		[&load](int a, int b) { return load[a] > load[b]; });
+	for (int i = 0; i < m; i++)
+		label[byLoad[i]] = i;
+	for (size_t j = 0; j < machineOf.size(); j++)
+		machineOf[j] = label[machineOf[j]];
+}
+
+void RelabelByFirstJob(const std::vector<int>& order, int m,
+	std::vector<int>& machineOf)
+{
+	std::vector<int> label(m, -1);
+	int next = 0;
+
+	for (size_t k = 0; k < order.size(); k++)
+		if (label[machineOf[order[k]]] < 0)
+			label[machineOf[order[k]]] = next++;
+	for (int i = 0; i < m; i++)
+		if (label[i] < 0)
+			label[i] = next++;
+	for (size_t j = 0; j < machineOf.size(); j++)
+		machineOf[j] = label[machineOf[j]];
+}
@@ -0,0 +1,86 @@
+/****************************************************************************
+* Formulations of the UAV makespan problem
+*****************************************************************************/
+
+#ifndef __MODELS_H__
+#define __MODELS_H__
+
+#include "modelbuilder.h"
+
+#include <utility>
+#include <vector>
+
+// Size of every job on a machine: setup[j] + proctime[j]
+void JobSizes(int n, const int* proctime, const int* setup,
+	std::vector<int>& size);
+
+// Jobs with the same processing and setup times, grouped into types
+struct JobTypes
+{
+	std::vector<int> proctime, setup;   // times of every type
+	std::vector<std::vector<int> > jobs;  // jobs of every type
+};
+
+// Group the n jobs into types, in order of first appearance.
+void GroupJobTypes(int n, const int* proctime, const int* setup,
+	JobTypes& types);
+
+// Column of the makespan variable in the assignment models
+const int CmaxColumn = 0;
+
+// Column of x_i_j (machine i, job j) in the assignment model
+inline int AssignColumn(int n, int i, int j) { return 1 + i * n + j; }
+
+// Build the assignment model: C_max plus one binary x_i_j per machine and
+// job. restr1_j assigns job j to exactly one machine and restr2_i bounds the
+// load of machine i, in which job j takes setup[j] + proctime[j], by C_max.
+void BuildAssignmentModel(ModelBuilder& model, int n, int m,
+	const int* proctime, const int* setup);
+
+// Column of y_i_t (machine i, job type t) in the aggregated model
+inline int TypeColumn(int ntypes, int i, int t) { return 1 + i * ntypes + t; }
+
+// Build the aggregated assignment model: C_max plus one integer y_i_t per
+// machine and job type, counting the jobs of type t on machine i. restr1_t
+// assigns all jobs of type t and restr2_i bounds the load of machine i.
+void BuildAggregatedModel(ModelBuilder& model, const JobTypes& types, int m);
+
+// Build the time-indexed model of a sequencing problem: C_max in
+// [lowerBound, horizon] plus the binaries x_j_t, job j starting at period t,
+// for est[j] <= t <= lst[j], at first[j] + t - est[j]. Rows: every job
+// starts once, at most m jobs run at every period, the start of b is at
+// least length[a] after the start of a for every arc (a, b), and C_max is
+// at least the finish of every job without successors.
+void BuildTimeIndexedModel(ModelBuilder& model, int m,
+	const std::vector<long long>& length,
+	const std::vector<std::pair<int, int> >& arcs,
+	const std::vector<long long>& est, const std::vector<long long>& lst,
+	long long lowerBound, long long horizon, std::vector<int>& first);
+
+// Symmetry breaking for the identical machines. Both assignment models store
+// the columns of machine i at 1 + i * width, one per job or job type.
+
+// Order the machines by load: sym_i is load(i) - load(i+1) >= 0, where the
+// load of machine i is the sum of weight[k] times its k-th column.
+void AddLoadOrdering(ModelBuilder& model, int m,
+	const std::vector<int>& weight);
+
+// Allow the k-th job of order only on machines 0..k, fixing the other x_i_j
+// to zero. Machines are then numbered by the first job of order they take.
+void FixJobsToMachines(ModelBuilder& model, int n, int m,
+	const std::vector<int>& order);
+
+// Renumber the machines of a schedule by non-increasing load.
+void RelabelByLoad(const std::vector<int>& size, int m,
+	std::vector<int>& machineOf);
+
+// Renumber the machines of a schedule by the first job of order they take.
+void RelabelByFirstJob(const std::vector<int>& order, int m,
+	std::vector<int>& machineOf);
+
+// Turn the counts y_i_t into one machine per job.
+// @param count  count[i * ntypes + t] jobs of type t on machine i
+void ExpandTypeCounts(const JobTypes& types, int m,
+	const std::vector<int>& count, std::vector<int>& machineOf);
+
+#endif
@@ -0,0 +1,672 @@
+#include "options.h"
+#include "benchmark.h"
+#include "export.h"
+#include "generator.h"
+#include "portfolio.h"
+#include "solver.h"
+#include "sysutil.h"
+
+#include <algorithm>
+#include <thread>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static void PrintUsage()
+{
+	printf("\nVANT\n");
+	printf("Enter the instance file name, the number of machines and the instance number!\n");
+	printf("Example: wet+(#jobs)-(#machines)m-(#instance)  +  #machines  +  #instance\n");
+	printf("Output File: JIT+(#jobs)-(#machines)m-(#instance)\n");
+	printf("Options:\n");
+	printf("  --solver=native|ufflp   MIP backend (default: %s)\n", DefaultSolverName());
+	printf("  --model=assign|arcflow|colgen|timeindexed  formulation (default:\n");
+	printf("                          assign); instances with precedence, window or\n");
+	printf("                          transition sections always use timeindexed,\n");
+	printf("                          the others never do\n");
+	printf("  --engine=auto|dp|mip|ils|binpack|lagrange|portfolio  exact DP for 2\n");
+	printf("                          to 4 machines, the local search alone,\n");
+	printf("                          bin-packing probes or Lagrangian subgradient\n");
+	printf("                          on --threads cores (0: all), or several\n");
+	printf("                          engines at once (default: auto)\n");
+	printf("  --portfolio=list        engines of the portfolio among mip, arcflow,\n");
+	printf("                          colgen, ils, dp, binpack and lagrange\n");
+	printf("                          (default: mip,arcflow,ils)\n");
+	printf("  --aggregate=auto|on|off count variables per job type (default: auto)\n");
+	printf("  --symmetry=off|loads|fix|priority  machine symmetry breaking (default: off)\n");
+	printf("  --export=lp|mps[.gz|.zst]  write the assignment model in the background\n");
+	printf("  --cache=dir             reuse and record the schedules of solved instances\n");
+	printf("  --cuts=on|off           cardinality and cover cuts on the load rows\n");
+	printf("                          (default: off)\n");
+	printf("  --cut-depth=N           deepest node where cuts are separated (default: 2)\n");
+	printf("  --cut-time=S            seconds of cut separation per solve (default: 10)\n");
+	printf("  --files=on|off          append to Table_wet*.tex and write the solver log\n");
+	printf("                          vant*.log in the working directory (default: on)\n");
+	printf("  --threads=N             threads of the MIP solver, 0 for all cores\n");
+	printf("                          (default: 1)\n");
+	printf("  --time-limit=S          time limit in seconds (default: 10800)\n");
+	printf("  --search-time=S         local search before the MIP, 0 to skip (default: 1)\n");
+	printf("  --lagrange-time=S       Lagrangian bound before the MIP, 0 to skip\n");
+	printf("                          (default: 0)\n");
+	printf("  --seed=N                seed of the local search (default: 1)\n");
+	printf("  --report=file           write a JSON record of the run\n");
+	printf("  --report-csv=file       append a CSV record of the run\n");
+	printf("  --trace=file            CSV progress records during the MIP\n");
+	printf("  --trace-interval=S      seconds between progress records (default: 1)\n");
+	printf("  --schedule=file         CSV with the start and finish of every job\n");
+	printf("  --checkpoint=file       keep the best schedule and bound in the file, also\n");
+	printf("                          on SIGTERM, and resume from it if it exists\n");
+	printf("  --checkpoint-interval=S seconds between two checkpoints (default: 60)\n");
+	printf("  --echo=on|off           print the times of the instance (default: on)\n");
+	printf("Instances are text or binary, see vant --convert; vant --generate makes\n");
+	printf("random ones and vant --bench-suite benchmarks the engines on them.\n");
+	printf("vant --self-test checks that the exact engines agree.\n");
+}
+
+static void PrintBatchUsage()
+{
+	printf("\nvant --batch <manifest|directory> [--option=value ...]\n");
+	printf("Solve many instances on a pool of workers. Every line of a manifest is\n");
+	printf("  <instance> <#machines> [#instance] [time limit]\n");
+	printf("and a directory is read for its *.txt files.\n");
+	printf("Options:\n");
+	printf("  --solver=native|ufflp   MIP backend (default: %s)\n", DefaultSolverName());
+	printf("  --model=assign|arcflow|colgen|timeindexed  formulation (default:\n");
+	printf("                          assign); instances with precedence, window or\n");
+	printf("                          transition sections always use timeindexed,\n");
+	printf("                          the others never do\n");
+	printf("  --engine=auto|dp|mip|ils|binpack|lagrange|portfolio  exact DP for 2\n");
+	printf("                          to 4 machines, the local search alone,\n");
+	printf("                          bin-packing probes or Lagrangian subgradient\n");
+	printf("                          on --threads cores (0: all), or several\n");
+	printf("                          engines at once (default: auto)\n");
+	printf("  --portfolio=list        engines of the portfolio among mip, arcflow,\n");
+	printf("                          colgen, ils, dp, binpack and lagrange\n");
+	printf("                          (default: mip,arcflow,ils)\n");
+	printf("  --aggregate=auto|on|off count variables per job type (default: auto)\n");
+	printf("  --symmetry=off|loads|fix|priority  machine symmetry breaking (default: off)\n");
+	printf("  --export=lp|mps[.gz|.zst]  write the assignment model in the background\n");
+	printf("  --cache=dir             reuse and record the schedules of solved instances\n");
+	printf("  --cuts=on|off           cardinality and cover cuts on the load rows\n");
+	printf("                          (default: off)\n");
+	printf("  --cut-depth=N           deepest node where cuts are separated (default: 2)\n");
+	printf("  --cut-time=S            seconds of cut separation per solve (default: 10)\n");
+	printf("  --files=on|off          append to Table_wet*.tex and write the solver log\n");
+	printf("                          vant*.log in the working directory (default: on)\n");
+	printf("  --budget=N              threads shared by all solves (default: all cores)\n");
+	printf("  --threads=N             solver threads per solve (default: from the budget)\n");
+	printf("  --time-limit=S          time limit per instance in seconds (default: 10800)\n");
+	printf("  --machines=M            machines for the instances of a directory\n");
+	printf("  --results=file          also write the results to a CSV file\n");
+	printf("  --report=file           write a JSON record of every solve, one per line\n");
+	printf("  --search-time=S         local search before the MIP, 0 to skip (default: 1)\n");
+	printf("  --lagrange-time=S       Lagrangian bound before the MIP, 0 to skip\n");
+	printf("                          (default: 0)\n");
+	printf("  --seed=N                seed of the local search (default: 1)\n");
+}
+
+static void PrintSuiteUsage()
+{
+	printf("\nvant --bench-suite[=default] [--option=value ...]\n");
+	printf("Generate the instances of every class and size, solve each one with\n");
+	printf("every engine under every time limit, one process per run, and report\n");
+	printf("the time to optimality, the gap at each limit and the peak memory.\n");
+	printf("The grid is given by the options below; --bench-suite=default runs the\n");
+	printf("whole default grid, which takes hours.\n");
+	printf("Options:\n");
+	printf("  --classes=list          among u100, u1000, n4n, near and huge\n");
+	printf("                          (default: all)\n");
+	printf("  --jobs=list             job counts, up to %d (default: 100,1000)\n",
+		MaxGeneratedJobs);
+	printf("  --machines=list         machine counts (default: 10)\n");
+	printf("  --seeds=N               instances of every class and size (default: 1)\n");
+	printf("  --engines=list          among dp, mip, arcflow, colgen, ils, binpack,\n");
+	printf("                          lagrange and portfolio (default: all)\n");
+	printf("  --limits=list           increasing time limits in seconds (default: 1,10)\n");
+	printf("  --dir=path              directory of the instances (default: .)\n");
+	printf("  --csv=file              write a record of every run\n");
+	printf("  --baseline=file         compare with the records of an earlier suite\n");
+	printf("  --slowdown=R            time or memory ratio over the baseline taken\n");
+	printf("                          as a regression (default: 1.5)\n");
+	printf("Any option of a single run is passed to every run.\n");
+}
+
+static void PrintDaemonUsage()
+{
+	printf("\nvant --daemon <#machines> [--option=value ...]\n");
+	printf("Keep a schedule up to date while jobs arrive and leave. Commands, one\n");
+	printf("per line on the standard input or on the socket:\n");
+	printf("  add <id> <proctime> <setup>   remove <id>   fix <id> <machine>\n");
+	printf("  unfix <id>   load <file>   schedule   stats   quit\n");
+	printf("Every change is answered by \"plan <makespan> <bound> <status> <ms>\".\n");
+	printf("Options:\n");
+	printf("  --solver=native|ufflp   MIP backend (default: %s)\n", DefaultSolverName());
+	printf("  --threads=N             threads of the MIP solver (default: 1)\n");
+	printf("  --seed=N                seed of the local search (default: 1)\n");
+	printf("  --latency-budget=MS     time of every re-plan (default: 200)\n");
+	printf("  --listen=PORT           read the commands from 127.0.0.1:PORT\n");
+}
+
+static void PrintSelfTestUsage()
+{
+	printf("\nvant --self-test [--option=value ...]\n");
+	printf("Solve small generated instances with the DP, MIP, arc-flow, column\n");
+	printf("generation, bin-packing and Lagrangian engines and check that they\n");
+	printf("agree, then round-trip the instance and checkpoint files and check that\n");
+	printf("malformed ones are rejected. The exit code is 1 if a check fails; an\n");
+	printf("exact engine stopped by the time limit is reported, not failed.\n");
+	printf("Options:\n");
+	printf("  --rounds=N              generated instances (default: 20)\n");
+	printf("  --jobs=N                jobs of the largest one (default: 12)\n");
+	printf("  --solver=native|ufflp   MIP backend (default: %s)\n", DefaultSolverName());
+	printf("  --threads=N             threads of the MIP solver (default: 1)\n");
+	printf("  --time-limit=S          time limit of every engine (default: 10)\n");
+}
+
+// Match "--name=value", returning the value or NULL
+static const char* OptionValue(const char* arg, const char* name)
+{
+	size_t len = strlen(name);
+	if (strncmp(arg, name, len) == 0 && arg[len] == '=')
+		return arg + len + 1;
+	return NULL;
+}
+
+static void SetDefaults(VantOptions& opts)
+{
+	opts.instance = NULL;
+	opts.machines = 0;
+	opts.ninst = 0;
+	opts.solver = DefaultSolverName();
+	opts.model = "assign";
+	opts.engine = "auto";
+	opts.portfolio = "mip,arcflow,ils";
+	opts.aggregate = "auto";
+	opts.symmetry = "off";
+	opts.threads = 1;
+	opts.timeLimit = 10800;
+	opts.searchTime = 1;
+	opts.lagrangeTime = 0;
+	opts.seed = 1;
+	opts.exportFormat = "";
+	opts.cache = "";
+	opts.cuts = "off";
+	opts.cutDepth = 2;
+	opts.cutTime = 10;
+	opts.files = "on";
+	opts.verbose = true;
+	opts.report = NULL;
+	opts.reportCsv = NULL;
+	opts.trace = NULL;
+	opts.traceInterval = 1;
+	opts.schedule = NULL;
+	opts.checkpoint = NULL;
+	opts.checkpointInterval = 60;
+	opts.echo = true;
+}
+
+// Options shared by a single run and the batch mode.
+// @return false if arg is not one of them
+static bool ParseSolveOption(const char* arg, VantOptions& opts)
+{
+	const char* v;
+
+	if ((v = OptionValue(arg, "--solver")) != NULL)
+		opts.solver = v;
+	else if ((v = OptionValue(arg, "--model")) != NULL)
+		opts.model = v;
+	else if ((v = OptionValue(arg, "--engine")) != NULL)
+		opts.engine = v;
+	else if ((v = OptionValue(arg, "--portfolio")) != NULL)
+		opts.portfolio = v;
+	else if ((v = OptionValue(arg, "--aggregate")) != NULL)
+		opts.aggregate = v;
+	else if ((v = OptionValue(arg, "--symmetry")) != NULL)
+		opts.symmetry = v;
+	else if ((v = OptionValue(arg, "--threads")) != NULL)
+		opts.threads = atoi(v);
+	else if ((v = OptionValue(arg, "--time-limit")) != NULL)
+		opts.timeLimit = atof(v);
+	else if ((v = OptionValue(arg, "--search-time")) != NULL)
+		opts.searchTime = atof(v);
+	else if ((v = OptionValue(arg, "--lagrange-time")) != NULL)
+		opts.lagrangeTime = atof(v);
+	else if ((v = OptionValue(arg, "--seed")) != NULL)
+		opts.seed = (unsigned)strtoul(v, NULL, 10);
+	else if ((v = OptionValue(arg, "--export")) != NULL)
+		opts.exportFormat = v;
+	else if ((v = OptionValue(arg, "--cache")) != NULL)
+		opts.cache = v;
+	else if ((v = OptionValue(arg, "--cuts")) != NULL)
+		opts.cuts = v;
+	else if ((v = OptionValue(arg, "--cut-depth")) != NULL)
+		opts.cutDepth = atoi(v);
+	else if ((v = OptionValue(arg, "--cut-time")) != NULL)
+		opts.cutTime = atof(v);
+	else if ((v = OptionValue(arg, "--files")) != NULL)
+		opts.files = v;
+	else
+		return false;
+	return true;
+}
+
+static bool ValidateSolveOptions(const VantOptions& opts)
+{
+	if (opts.model != "assign" && opts.model != "arcflow" &&
+		opts.model != "colgen" && opts.model != "timeindexed")
+	{
+		printf("Unknown model: %s\n", opts.model.c_str());
+		return false;
+	}
+	if (opts.engine != "auto" && opts.engine != "dp" && opts.engine != "mip" &&
+		opts.engine != "ils" && opts.engine != "binpack" &&
+		opts.engine != "lagrange" && opts.engine != "portfolio")
+	{
+		printf("Unknown engine: %s\n", opts.engine.c_str());
+		return false;
+	}
+	std::vector<std::string> members;
+	if (!ParsePortfolio(opts.portfolio, members))
+	{
+		printf("Unknown portfolio: %s\n", opts.portfolio.c_str());
+		return false;
+	}
+	if (opts.aggregate != "auto" && opts.aggregate != "on" && opts.aggregate != "off")
+	{
+		printf("Unknown aggregation: %s\n", opts.aggregate.c_str());
+		return false;
+	}
+	if (opts.symmetry != "off" && opts.symmetry != "loads" &&
+		opts.symmetry != "fix" && opts.symmetry != "priority")
+	{
+		printf("Unknown symmetry breaking: %s\n", opts.symmetry.c_str());
+		return false;
+	}
+	if ((opts.cuts != "on" && opts.cuts != "off") || opts.cutDepth < 0 ||
+		opts.cutTime < 0)
+	{
+		printf("Invalid cut separation: --cuts=%s --cut-depth=%d --cut-time=%g\n",
+			opts.cuts.c_str(), opts.cutDepth, opts.cutTime);
+		return false;
+	}
+	if (opts.files != "on" && opts.files != "off")
+	{
+		printf("Unknown output files mode: %s\n", opts.files.c_str());
+		return false;
+	}
+	if (!opts.exportFormat.empty() && !ValidExportFormat(opts.exportFormat))
+	{
+		printf("Unknown export format: %s\n", opts.exportFormat.c_str());
+		return false;
+	}
+	if (!opts.cache.empty() && !IsDirectory(opts.cache.c_str()))
+	{
+		printf("Cache directory not found: %s\n", opts.cache.c_str());
+		return false;
+	}
+	if (opts.symmetry == "fix" && opts.aggregate == "on")
+	{
+		printf("--symmetry=fix needs one variable per job, use --aggregate=off\n");
+		return false;
+	}
+	SolverBackend* solver = CreateSolver(opts.solver.c_str());
+	if (solver == NULL)
+	{
+		printf("Solver backend not available: %s\n", opts.solver.c_str());
+		return false;
+	}
+	delete solver;
+	if (opts.threads < 0 || opts.timeLimit <= 0 || opts.searchTime < 0 ||
+		opts.lagrangeTime < 0)
+	{
+		printf("Invalid number of threads or time limit\n");
+		return false;
+	}
+	return true;
+}
+
+bool ParseOptions(int argc, char* argv[], VantOptions& opts)
+{
+	const char* positional[3];
+	const char* v;
+	int npos = 0;
+
+	SetDefaults(opts);
+
+	for (int k = 1; k < argc; k++)
+	{
+		const char* arg = argv[k];
+		if (strncmp(arg, "--", 2) != 0)
+		{
+			if (npos == 3)
+			{
+				PrintUsage();
+				return false;
+			}
+			positional[npos++] = arg;
+		}
+		else if ((v = OptionValue(arg, "--report")) != NULL)
+			opts.report = v;
+		else if ((v = OptionValue(arg, "--report-csv")) != NULL)
+			opts.reportCsv = v;
+		else if ((v = OptionValue(arg, "--trace")) != NULL)
+			opts.trace = v;
+		else if ((v = OptionValue(arg, "--trace-interval")) != NULL)
+			opts.traceInterval = atof(v);
+		else if ((v = OptionValue(arg, "--schedule")) != NULL)
+			opts.schedule = v;
+		else if ((v = OptionValue(arg, "--checkpoint")) != NULL)
+			opts.checkpoint = v;
+		else if ((v = OptionValue(arg, "--checkpoint-interval")) != NULL)
+			opts.checkpointInterval = atof(v);
+		else if ((v = OptionValue(arg, "--echo")) != NULL)
+		{
+			if (strcmp(v, "on") != 0 && strcmp(v, "off") != 0)
+			{
+				printf("Unknown echo mode: %s\n", v);
+				return false;
+			}
+			opts.echo = strcmp(v, "on") == 0;
+		}
+		else if (!ParseSolveOption(arg, opts))
+		{
+			printf("Unknown option: %s\n", arg);
+			PrintUsage();
+			return false;
+		}
+	}
+
+	if (npos != 3) {
+		PrintUsage();
+		return false;
+	}
+
+	if (!ValidateSolveOptions(opts))
+		return false;
+	// all cores, as a batch does with its budget
+	if (opts.threads == 0)
+		opts.threads = std::max(1, (int)std::thread::hardware_concurrency());
+	if (opts.traceInterval < 0)
+	{
+		printf("Invalid trace interval\n");
+		return false;
+	}
+	if (opts.checkpointInterval <= 0)
+	{
+		printf("Invalid checkpoint interval\n");
+		return false;
+	}
+
+	char* end;
+	long machines = strtol(positional[1], &end, 10);
+	if (end == positional[1] || *end != '\0' || machines <= 0 || machines > INT_MAX)
+	{
+		printf("Invalid number of machines: %s\n", positional[1]);
+		PrintUsage();
+		return false;
+	}
+
+	opts.instance = positional[0];
+	opts.machines = (int)machines;         //keep the number of machines
+	opts.ninst = atoi(positional[2]);      //keep the instance number
+	return true;
+}
+
+bool ParseBatchOptions(int argc, char* argv[], BatchOptions& opts)
+{
+	const char* v;
+
+	opts.input = NULL;
+	opts.budget = 0;
+	opts.machines = 0;
+	opts.results = NULL;
+	opts.report = NULL;
+	SetDefaults(opts.solve);
+	opts.solve.threads = 0;
+	opts.solve.verbose = false;
+
+	for (int k = 2; k < argc; k++)
+	{
+		const char* arg = argv[k];
+		if (strncmp(arg, "--", 2) != 0 && opts.input == NULL)
+			opts.input = arg;
+		else if ((v = OptionValue(arg, "--budget")) != NULL)
+			opts.budget = atoi(v);
+		else if ((v = OptionValue(arg, "--machines")) != NULL)
+			opts.machines = atoi(v);
+		else if ((v = OptionValue(arg, "--results")) != NULL)
+			opts.results = v;
+		else if ((v = OptionValue(arg, "--report")) != NULL)
+			opts.report = v;
+		else if (!ParseSolveOption(arg, opts.solve))
+		{
+			printf("Unknown option: %s\n", arg);
+			PrintBatchUsage();
+			return false;
+		}
+	}
+
+	if (opts.input == NULL)
+	{
+		PrintBatchUsage();
+		return false;
+	}
+	return ValidateSolveOptions(opts.solve) && opts.budget >= 0 && opts.machines >= 0;
+}
+
+// Split a comma separated list, false if an item is empty
+static bool SplitList(const char* list, std::vector<std::string>& items)
+{
+	items.clear();
+	std::string s(list);
+	size_t start = 0;
+	while (start <= s.size())
+	{
+		size_t end = s.find(',', start);
+		if (end == std::string::npos)
+			end = s.size();
+		if (end == start)
+			return false;
+		items.push_back(s.substr(start, end - start));
+		start = end + 1;
+	}
+	return true;
+}
+
+// Split a comma separated list of numbers, false if one is not positive
+static bool SplitNumbers(const char* list, std::vector<double>& values)
+{
+	std::vector<std::string> items;
+	values.clear();
+	if (!SplitList(list, items))
+		return false;
+	for (size_t k = 0; k < items.size(); k++)
+	{
+		values.push_back(atof(items[k].c_str()));
+		if (values.back() <= 0)
+			return false;
+	}
+	return true;
+}
+
+bool ParseSuiteOptions(int argc, char* argv[], SuiteOptions& opts)
+{
+	const char* v;
+	const char* classes = "u100,u1000,n4n,near,huge";
+	const char* jobs = "100,1000";
+	const char* machines = "10";
+	const char* engines = "dp,mip,arcflow,colgen,ils,binpack,lagrange,portfolio";
+	const char* limits = "1,10";
+	VantOptions solve;
+
+	opts.grid = strcmp(argv[1], "--bench-suite=default") == 0;
+	opts.seeds = 1;
+	opts.dir = ".";
+	opts.csv = NULL;
+	opts.baseline = NULL;
+	opts.slowdown = 1.5;
+	opts.forward.clear();
+	SetDefaults(solve);
+
+	for (int k = 2; k < argc; k++)
+	{
+		const char* arg = argv[k];
+		if ((v = OptionValue(arg, "--classes")) != NULL)
+		{
+			classes = v;
+			opts.grid = true;
+		}
+		else if ((v = OptionValue(arg, "--jobs")) != NULL)
+		{
+			jobs = v;
+			opts.grid = true;
+		}
+		else if ((v = OptionValue(arg, "--machines")) != NULL)
+		{
+			machines = v;
+			opts.grid = true;
+		}
+		else if ((v = OptionValue(arg, "--seeds")) != NULL)
+		{
+			opts.seeds = atoi(v);
+			opts.grid = true;
+		}
+		else if ((v = OptionValue(arg, "--engines")) != NULL)
+		{
+			engines = v;
+			opts.grid = true;
+		}
+		else if ((v = OptionValue(arg, "--limits")) != NULL)
+		{
+			limits = v;
+			opts.grid = true;
+		}
+		else if ((v = OptionValue(arg, "--dir")) != NULL)
+			opts.dir = v;
+		else if ((v = OptionValue(arg, "--csv")) != NULL)
+			opts.csv = v;
+		else if ((v = OptionValue(arg, "--baseline")) != NULL)
+			opts.baseline = v;
+		else if ((v = OptionValue(arg, "--slowdown")) != NULL)
+			opts.slowdown = atof(v);
+		else if (ParseSolveOption(arg, solve))
+			opts.forward.push_back(arg);
+		else
+		{
+			printf("Unknown option: %s\n", arg);
+			PrintSuiteUsage();
+			return false;
+		}
+	}
+
+	std::vector<double> counts;
+	bool valid = SplitList(classes, opts.classes) &&
+		SplitList(engines, opts.engines) && SplitNumbers(limits, opts.limits);
+	for (size_t k = 0; valid && k < opts.classes.size(); k++)
+		valid = ValidInstanceClass(opts.classes[k]);
+	for (size_t k = 0; valid && k < opts.engines.size(); k++)
+		valid = ValidSuiteEngine(opts.engines[k]);
+	for (size_t k = 1; valid && k < opts.limits.size(); k++)
+		valid = opts.limits[k] > opts.limits[k - 1];
+	if (!valid)
+	{
+		printf("Invalid list of classes, engines or time limits\n");
+		PrintSuiteUsage();
+		return false;
+	}
+
+	opts.jobs.clear();
+	opts.machines.clear();
+	valid = SplitNumbers(jobs, counts);
+	for (size_t k = 0; valid && k < counts.size(); k++)
+	{
+		opts.jobs.push_back((int)counts[k]);
+		valid = counts[k] <= MaxGeneratedJobs;
+	}
+	valid = valid && SplitNumbers(machines, counts);
+	for (size_t k = 0; valid && k < counts.size(); k++)
+		opts.machines.push_back((int)counts[k]);
+	if (!valid || opts.seeds < 1 || opts.slowdown < 1)
+	{
+		printf("Invalid job or machine counts, seeds or slowdown\n");
+		PrintSuiteUsage();
+		return false;
+	}
+	return ValidateSolveOptions(solve);
+}
+
+bool ParseDaemonOptions(int argc, char* argv[], DaemonOptions& opts)
+{
+	const char* v;
+	const char* machines = NULL;
+
+	opts.budget = 0.2;
+	opts.port = 0;
+	SetDefaults(opts.solve);
+	opts.solve.verbose = false;
+
+	for (int k = 2; k < argc; k++)
+	{
+		const char* arg = argv[k];
+		if (strncmp(arg, "--", 2) != 0 && machines == NULL)
+			machines = arg;
+		else if ((v = OptionValue(arg, "--latency-budget")) != NULL)
+			opts.budget = atof(v) / 1000.0;
+		else if ((v = OptionValue(arg, "--listen")) != NULL)
+			opts.port = atoi(v);
+		else if (!ParseSolveOption(arg, opts.solve))
+		{
+			printf("Unknown option: %s\n", arg);
+			PrintDaemonUsage();
+			return false;
+		}
+	}
+
+	if (machines == NULL || (opts.machines = atoi(machines)) <= 0)
+	{
+		PrintDaemonUsage();
+		return false;
+	}
+	if (opts.budget <= 0 || opts.port < 0 || opts.port > 65535)
+	{
+		printf("Invalid latency budget or port\n");
+		return false;
+	}
+	opts.solve.machines = opts.machines;
+	return ValidateSolveOptions(opts.solve) && opts.solve.threads > 0;
+}
+
+bool ParseSelfTestOptions(int argc, char* argv[], SelfTestOptions& opts)
+{
+	const char* v;
+
+	opts.rounds = 20;
+	opts.maxJobs = 12;
+	SetDefaults(opts.solve);
+	opts.solve.timeLimit = 10;
+	opts.solve.verbose = false;
+	opts.solve.files = "off";
+
+	for (int k = 2; k < argc; k++)
+	{
+		const char* arg = argv[k];
+		if ((v = OptionValue(arg, "--rounds")) != NULL)
+			opts.rounds = atoi(v);
+		else if ((v = OptionValue(arg, "--jobs")) != NULL)
+			opts.maxJobs = atoi(v);
+		else if (!ParseSolveOption(arg, opts.solve))
+		{
+			printf("Unknown option: %s\n", arg);
+			PrintSelfTestUsage();
+			return false;
+		}
+	}
+
+	if (opts.rounds <= 0 || opts.maxJobs <= 0)
+	{
+		printf("Invalid number of rounds or jobs\n");
+		return false;
+	}
+	return ValidateSolveOptions(opts.solve) && opts.solve.threads > 0;
+}
@@ -0,0 +1,123 @@
+/****************************************************************************
+* Command line of vant
+*
+*   vant <instance> <#machines> <#instance> [--option=value ...]
+*   vant --batch <manifest|directory> [--option=value ...]
+*   vant --bench-suite[=default] [--option=value ...]
+*
+*****************************************************************************/
+
+#ifndef __OPTIONS_H__
+#define __OPTIONS_H__
+
+#include <string>
+#include <vector>
+
+struct VantOptions
+{
+	const char* instance;   // instance file name
+	int machines;           // number of machines (UAVs)
+	int ninst;              // instance number, used in the output names
+	std::string solver;     // --solver=native|ufflp
+	std::string model;      // --model=assign|arcflow|colgen|timeindexed
+	std::string engine;     // --engine=auto|dp|mip|ils|binpack|lagrange|portfolio
+	std::string portfolio;  // --portfolio=list, members of the portfolio engine
+	std::string aggregate;  // --aggregate=auto|on|off, job types in the MIP
+	std::string symmetry;   // --symmetry=off|loads|fix|priority
+	int threads;            // --threads=N, threads of the MIP solver
+	double timeLimit;       // --time-limit=S, seconds
+	double searchTime;      // --search-time=S, local search before the MIP
+	double lagrangeTime;    // --lagrange-time=S, Lagrangian bound before the MIP
+	unsigned seed;          // --seed=N, of the local search
+	std::string exportFormat; // --export=lp|mps[.gz|.zst], empty for none
+	std::string cache;      // --cache=dir, solved instances, empty for none
+	std::string cuts;       // --cuts=on|off, separation on the load rows
+	int cutDepth;           // --cut-depth=N, deepest node separated
+	double cutTime;         // --cut-time=S, seconds of separation per solve
+	std::string files;      // --files=on|off, the LaTeX table row and the
+	                        // solver log in the working directory
+	bool verbose;           // progress messages on the standard output
+
+	// single run only
+	const char* report;     // --report=file, JSON record of the run
+	const char* reportCsv;  // --report-csv=file, CSV record appended to it
+	const char* trace;      // --trace=file, progress records during the MIP
+	double traceInterval;   // --trace-interval=S, seconds between records
+	const char* schedule;   // --schedule=file, CSV of the jobs of every machine
+	const char* checkpoint; // --checkpoint=file, best schedule and bound of the
+	                        // run, resumed from if it exists
+	double checkpointInterval; // --checkpoint-interval=S, seconds between writes
+	bool echo;              // --echo=on|off, print the times read
+};
+
+// vant --batch <manifest|directory> [--option=value ...]
+struct BatchOptions
+{
+	const char* input;      // manifest file or directory of instances
+	int budget;             // --budget=N, threads shared by all solves
+	int machines;           // --machines=M for instances of a directory
+	const char* results;    // --results=file, CSV copy of the results
+	const char* report;     // --report=file, JSON record of every solve
+	VantOptions solve;      // settings common to every solve; threads is 0
+	                        // to choose them from the budget
+};
+
+// vant --daemon <#machines> [--option=value ...]
+struct DaemonOptions
+{
+	int machines;
+	double budget;          // --latency-budget=MS, per update, in seconds
+	int port;               // --listen=PORT on the loopback, 0 for stdin
+	VantOptions solve;      // backend, threads and seed of the re-plans
+};
+
+// vant --self-test [--option=value ...]
+struct SelfTestOptions
+{
+	int rounds;             // --rounds=N, generated instances
+	int maxJobs;            // --jobs=N, jobs of the largest one
+	VantOptions solve;      // backend, threads and time limit of the engines
+};
+
+// vant --bench-suite[=default] [--option=value ...]
+struct SuiteOptions
+{
+	bool grid;                          // a grid option was given, or the
+	                                    // default grid asked for
+	std::vector<std::string> classes;   // --classes=list of instance classes
+	std::vector<int> jobs;              // --jobs=list of job counts
+	std::vector<int> machines;          // --machines=list of machine counts
+	int seeds;                          // --seeds=N instances of every size
+	std::vector<std::string> engines;   // --engines=list, run in that order
+	std::vector<double> limits;         // --limits=list of time limits, in
+	                                    // seconds, increasing
+	const char* dir;        // --dir=path of the generated instances
+	const char* csv;        // --csv=file, one record per run
+	const char* baseline;   // --baseline=file, records of an earlier suite
+	double slowdown;        // --slowdown=R, ratio of time or memory over the
+	                        // baseline reported as a regression
+	std::vector<std::string> forward;   // solve options of every run
+};
+
+// Parse the command line into opts, printing the usage on error.
+// @return false if the command line is invalid
+bool ParseOptions(int argc, char* argv[], VantOptions& opts);
+
+// Parse the command line of the batch mode (argv[1] is "--batch").
+// @return false if the command line is invalid
+bool ParseBatchOptions(int argc, char* argv[], BatchOptions& opts);
+
+// Parse the command line of the benchmark suite (argv[1] is "--bench-suite"
+// or "--bench-suite=default").
+// @return false if the command line is invalid
+bool ParseSuiteOptions(int argc, char* argv[], SuiteOptions& opts);
+
+// Parse the command line of the daemon mode (argv[1] is "--daemon").
+// @return false if the command line is invalid
+bool ParseDaemonOptions(int argc, char* argv[], DaemonOptions& opts);
+
+// Parse the command line of the self-test (argv[1] is "--self-test").
+// @return false if the command line is invalid
+bool ParseSelfTestOptions(int argc, char* argv[], SelfTestOptions& opts);
+
+#endif
@@ -0,0 +1,63 @@
+#include "portfolio.h"
+
+SharedSearch::SharedSearch(long long lowerBound) : bound(lowerBound), stop(false),
+	incumbentBy(PresolveMember), boundBy(PresolveMember)
+{
+}
+
+bool SharedSearch::Offer(int member, long long makespan,
+	const std::vector<int>& machineOf)
+{
+	if (!incumbent.Offer(makespan, machineOf))
+		return false;
+	incumbentBy = member;
+	return true;
+}
+
+void SharedSearch::RaiseBound(int member, long long value)
+{
+	long long current = bound.load();
+	while (value > current)
+	{
+		if (bound.compare_exchange_weak(current, value))
+		{
+			boundBy = member;
+			return;
+		}
+	}
+}
+
+bool SharedSearch::Closed() const
+{
+	long long value = incumbent.Value();
+	return value >= 0 && value <= bound.load();
+}
+
+void SharedSearch::Tighten(long long& lo, long long& makespan,
+	std::vector<int>& machineOf) const
+{
+	if (bound.load() > lo)
+		lo = bound.load();
+	long long value = incumbent.Value();
+	if (value >= 0 && value < makespan)
+		makespan = incumbent.Best(machineOf);
+}
+
+bool ParsePortfolio(const std::string& list, std::vector<std::string>& members)
+{
+	members.clear();
+	size_t start = 0;
+	while (start <= list.size())
+	{
+		size_t end = list.find(',', start);
+		if (end == std::string::npos)
+			end = list.size();
+		std::string name = list.substr(start, end - start);
+		if (name != "mip" && name != "arcflow" && name != "colgen" && name != "ils" &&
+			name != "dp" && name != "binpack" && name != "lagrange")
+			return false;
+		members.push_back(name);
+		start = end + 1;
+	}
+	return !members.empty();
+}
@@ -0,0 +1,54 @@
+/****************************************************************************
+* Portfolio of engines solving the same instance concurrently
+*
+* The members share the best schedule and the best proven bound through a
+* SharedSearch: every engine publishes what it finds, reads what the others
+* found to tighten its own search, and stops when the flag is set. The flag
+* is set as soon as a member proves optimality or the shared schedule meets
+* the shared bound.
+*
+*****************************************************************************/
+
+#ifndef __PORTFOLIO_H__
+#define __PORTFOLIO_H__
+
+#include "localsearch.h"
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+// Member id of the schedules and bounds found before the portfolio starts
+const int PresolveMember = -1;
+
+struct SharedSearch
+{
+	SharedSearch(long long lowerBound);
+
+	// Keep a schedule if it is the best one, crediting the member.
+	// @return true if it was kept
+	bool Offer(int member, long long makespan, const std::vector<int>& machineOf);
+
+	// Raise the shared bound, crediting the member if it improves.
+	void RaiseBound(int member, long long value);
+
+	// The best schedule meets the bound
+	bool Closed() const;
+
+	// Narrow the range [lo, makespan] of an engine with the shared bound and
+	// schedule, copying the schedule into machineOf if it is better.
+	void Tighten(long long& lo, long long& makespan,
+		std::vector<int>& machineOf) const;
+
+	SharedSchedule incumbent;
+	std::atomic<long long> bound;
+	std::atomic<bool> stop;
+	std::atomic<int> incumbentBy, boundBy;
+};
+
+// Split a comma separated list of members ("mip", "arcflow", "colgen", "ils",
+// "dp", "binpack" or "lagrange").
+// @return false if a member is unknown or the list is empty
+bool ParsePortfolio(const std::string& list, std::vector<std::string>& members);
+
+#endif
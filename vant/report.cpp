@@ -0,0 +1,151 @@
+#include "report.h"
+#include "runstats.h"
+#include "sysutil.h"
+
+#include <math.h>
+#include <stdio.h>
+
+// Name of the CPU time columns and keys
+static const char* CpuName(bool threadCpu)
+{
+	return threadCpu ? "thread_cpu" : "cpu";
+}
+
+const char* ReportCSVHeader(bool threadCpu)
+{
+	static std::string headers[2];
+	std::string& header = headers[threadCpu ? 1 : 0];
+	if (header.empty())
+	{
+		header = std::string("instance,jobs,machines,ninst,status,makespan,"
+			"lower_bound,seconds,best_bound,gap,nodes,rows,cols,nonzeros,"
+			"peak_rss_kb,") + CpuName(threadCpu) + "_seconds";
+		for (int p = 0; p < NumPhases; p++)
+		{
+			header += std::string(",") + PhaseName((RunPhase)p) + "_wall";
+			header += std::string(",") + PhaseName((RunPhase)p) + "_" +
+				CpuName(threadCpu);
+		}
+		header += "\n";
+	}
+	return header.c_str();
+}
+
+// Relative gap between the makespan and the best bound
+static double Gap(const SolveResult& result)
+{
+	return (result.value - result.bestBound) / fmax(1e-10, fabs(result.value));
+}
+
+std::string FormatReportCSV(const VantOptions& opts, int n,
+	const SolveResult* result)
+{
+	char buf[512];
+	std::string line = opts.instance;
+
+	if (result == NULL)
+	{
+		// the columns after the status are left empty
+		sprintf(buf, ",,%d,%d,unreadable", opts.machines, opts.ninst);
+		line += buf;
+		int columns = 0;
+		for (const char* c = ReportCSVHeader(); *c != '\0'; c++)
+			if (*c == ',')
+				columns++;
+		line += std::string(columns - 4, ',') + "\n";
+		return line;
+	}
+
+	const RunStats& stats = result->stats;
+	sprintf(buf, ",%d,%d,%d,%s,%.0f,%lld,%.3f,%.0f,%.6f,%ld,%d,%d,%lld,%ld,%.3f",
+		n, opts.machines, opts.ninst, StatusName(result->status), result->value,
+		result->lowerBound, stats.totalWall, result->bestBound, Gap(*result),
+		result->nodes, stats.rows, stats.cols, stats.nonzeros, PeakRSSKB(),
+		stats.totalCpu);
+	line += buf;
+	for (int p = 0; p < NumPhases; p++)
+	{
+		sprintf(buf, ",%.4f,%.4f", stats.wall[p], stats.cpu[p]);
+		line += buf;
+	}
+	line += "\n";
+	return line;
+}
+
+// JSON string with quotes, backslashes and control characters escaped
+static std::string JsonString(const char* s)
+{
+	std::string out = "\"";
+	char buf[8];
+	for (; *s != '\0'; s++)
+	{
+		if (*s == '"' || *s == '\\')
+		{
+			out += '\\';
+			out += *s;
+		}
+		else if ((unsigned char)*s < 0x20)
+		{
+			sprintf(buf, "\\u%04x", (unsigned char)*s);
+			out += buf;
+		}
+		else
+			out += *s;
+	}
+	return out + "\"";
+}
+
+std::string FormatReportJSON(const VantOptions& opts, int n,
+	const SolveResult* result)
+{
+	char buf[512];
+	std::string line = "{\"instance\":" + JsonString(opts.instance);
+
+	sprintf(buf, ",\"machines\":%d,\"ninst\":%d", opts.machines, opts.ninst);
+	line += buf;
+	line += ",\"solver\":" + JsonString(opts.solver.c_str());
+	line += ",\"model\":" + JsonString(opts.model.c_str());
+	line += ",\"engine\":" + JsonString(opts.engine.c_str());
+	if (result == NULL)
+		return line + ",\"status\":\"unreadable\"}\n";
+
+	const RunStats& stats = result->stats;
+	sprintf(buf, ",\"jobs\":%d,\"threads\":%d,\"status\":\"%s\",\"makespan\":%.0f"
+		",\"lower_bound\":%lld,\"best_bound\":%.0f,\"gap\":%.6f,\"nodes\":%ld",
+		n, opts.threads, StatusName(result->status), result->value,
+		result->lowerBound, result->bestBound, Gap(*result), result->nodes);
+	line += buf;
+	if (!result->winner.empty())
+		line += ",\"winner\":" + JsonString(result->winner.c_str());
+	if (opts.cuts == "on")
+	{
+		const CutStats& cuts = result->cuts;
+		sprintf(buf, ",\"cuts\":{\"cardinality\":%ld,\"cover\":%ld,\"load\":%ld"
+			",\"seconds\":%.3f,\"rounds\":[", cuts.cardinality, cuts.cover, cuts.load,
+			cuts.seconds);
+		line += buf;
+		for (size_t r = 0; r < cuts.rounds.size(); r++)
+		{
+			sprintf(buf, "%s{\"calls\":%ld,\"cuts\":%ld,\"gain\":%.4f}",
+				r > 0 ? "," : "", cuts.rounds[r].calls, cuts.rounds[r].cuts,
+				cuts.rounds[r].gain);
+			line += buf;
+		}
+		line += "]}";
+	}
+	sprintf(buf, ",\"model_size\":{\"rows\":%d,\"cols\":%d,\"nonzeros\":%lld}"
+		",\"peak_rss_kb\":%ld,\"seconds\":%.3f,\"%s_seconds\":%.3f",
+		stats.rows, stats.cols, stats.nonzeros, PeakRSSKB(), stats.totalWall,
+		CpuName(stats.threadCpu), stats.totalCpu);
+	line += buf;
+
+	line += ",\"phases\":{";
+	for (int p = 0; p < NumPhases; p++)
+	{
+		sprintf(buf, "%s\"%s\":{\"wall\":%.4f,\"%s\":%.4f}", p > 0 ? "," : "",
+			PhaseName((RunPhase)p), stats.wall[p], CpuName(stats.threadCpu),
+			stats.cpu[p]);
+		line += buf;
+	}
+	return line + "}}\n";
+}
@@ -0,0 +1,32 @@
+/****************************************************************************
+* Machine-readable run reports
+*
+* One record per solved instance, either as a CSV line or as a JSON object
+* on a single line, with the result, the model size, the peak memory and
+* the wall and CPU time of every phase. The CPU time is that of the whole
+* process in a single run, and that of the calling thread only in a batch,
+* where the columns and keys are named thread_cpu instead of cpu: the
+* helper threads of a solve and those of the backend are not counted there.
+*
+*****************************************************************************/
+
+#ifndef __REPORT_H__
+#define __REPORT_H__
+
+#include "options.h"
+#include "solve.h"
+
+#include <string>
+
+// Column names of the CSV records, ending with a newline; threadCpu as in
+// RunStats
+const char* ReportCSVHeader(bool threadCpu = false);
+
+// One record of a solve; result is NULL for an instance that could not be
+// read. Both end with a newline.
+std::string FormatReportCSV(const VantOptions& opts, int n,
+	const SolveResult* result);
+std::string FormatReportJSON(const VantOptions& opts, int n,
+	const SolveResult* result);
+
+#endif
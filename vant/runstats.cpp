@@ -0,0 +1,101 @@
+#include "runstats.h"
+#include "modelbuilder.h"
+#include "solver.h"
+#include "sysutil.h"
+
+#include <math.h>
+
+const char* PhaseName(RunPhase phase)
+{
+	switch (phase)
+	{
+	case Phase_Read:
+		return "read";
+	case Phase_Presolve:
+		return "presolve";
+	case Phase_Build:
+		return "build";
+	case Phase_Write:
+		return "write";
+	case Phase_Solve:
+		return "solve";
+	case Phase_Extract:
+		return "extract";
+	default:
+		return "unknown";
+	}
+}
+
+RunStats::RunStats() : threadCpu(false), totalWall(0), totalCpu(0), rows(0),
+	cols(0), nonzeros(0)
+{
+	for (int p = 0; p < NumPhases; p++)
+		wall[p] = cpu[p] = 0.0;
+}
+
+void RunStats::RecordModel(const ModelBuilder& model)
+{
+	if ((long long)model.NumNonzeros() + model.NumVariables() <= nonzeros + cols)
+		return;
+	rows = model.NumConstraints();
+	cols = model.NumVariables();
+	nonzeros = (long long)model.NumNonzeros();
+}
+
+PhaseTimer::PhaseTimer(RunStats* stats, RunPhase phase) : stats(stats),
+	phase(phase), wall(0), cpu(0)
+{
+	if (stats == NULL)
+		return;
+	wall = WallClock();
+	cpu = stats->threadCpu ? ThreadCpuTime() : ProcessCpuTime();
+}
+
+void PhaseTimer::Stop()
+{
+	if (stats == NULL)
+		return;
+	stats->wall[phase] += WallClock() - wall;
+	stats->cpu[phase] += (stats->threadCpu ? ThreadCpuTime() : ProcessCpuTime()) - cpu;
+	stats = NULL;
+}
+
+ProgressTrace::ProgressTrace(FILE* out, double interval) : out(out),
+	interval(interval)
+{
+	start = WallClock();
+	last = start - interval;
+	fprintf(out, "seconds,nodes,depth,incumbent,bound,gap\n");
+	fflush(out);
+}
+
+void ProgressTrace::Tick(SolverBackend* solver)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	double now = WallClock();
+	if (now - last < interval)
+		return;
+	last = now;
+
+	int depth = -1;
+	double incumbent, bound;
+	bool hasIncumbent = solver->GetBestSolutionValue(&incumbent) == UFFLP_Ok;
+	bool hasBound = solver->GetBestBound(&bound) == UFFLP_Ok;
+	solver->GetNodeDepth(&depth);
+
+	// empty fields for the values the backend does not report
+	fprintf(out, "%.3f,", now - start);
+	if (solver->NodeCount() >= 0)
+		fprintf(out, "%ld", solver->NodeCount());
+	fprintf(out, ",%d,", depth);
+	if (hasIncumbent)
+		fprintf(out, "%.10g", incumbent);
+	fputc(',', out);
+	if (hasBound)
+		fprintf(out, "%.10g", bound);
+	fputc(',', out);
+	if (hasIncumbent && hasBound)
+		fprintf(out, "%.6g", (incumbent - bound) / fmax(1e-10, fabs(incumbent)));
+	fputc('\n', out);
+	fflush(out);
+}
@@ -0,0 +1,82 @@
+/****************************************************************************
+* Instrumentation of a solve: wall and CPU time of every phase, size of the
+* largest model and a periodic progress trace written from the solver
+* callbacks
+*****************************************************************************/
+
+#ifndef __RUN_STATS_H__
+#define __RUN_STATS_H__
+
+#include <mutex>
+#include <stdio.h>
+
+class ModelBuilder;
+class SolverBackend;
+
+enum RunPhase
+{
+	Phase_Read,         // instance file
+	Phase_Presolve,     // bounds, heuristics, DP and local search
+	Phase_Build,        // models built and loaded into the backend
+	Phase_Write,        // model export, overlapping with the solve
+	Phase_Solve,        // backend solves
+	Phase_Extract,      // reading the solutions back
+	NumPhases
+};
+
+// Name of a phase in the reports
+const char* PhaseName(RunPhase phase);
+
+struct RunStats
+{
+	RunStats();
+
+	// Keep the size of the model if it is the largest one so far
+	void RecordModel(const ModelBuilder& model);
+
+	double wall[NumPhases];     // seconds
+	double cpu[NumPhases];
+	bool threadCpu;             // CPU time of the calling thread only, for
+	                            // concurrent solves in one process; leaves
+	                            // out the helper and backend threads
+	double totalWall;           // whole run, set by the caller
+	double totalCpu;
+	int rows, cols;             // largest model, 0 if none was built
+	long long nonzeros;
+};
+
+// Adds the wall and CPU time of its scope to a phase; does nothing for a
+// NULL stats.
+class PhaseTimer
+{
+public:
+	PhaseTimer(RunStats* stats, RunPhase phase);
+	~PhaseTimer() { Stop(); }
+
+	// End the measure before the end of the scope
+	void Stop();
+
+private:
+	RunStats* stats;
+	RunPhase phase;
+	double wall, cpu;
+};
+
+// CSV records "seconds,nodes,depth,incumbent,bound,gap" written at most
+// once per interval from a solver callback
+class ProgressTrace
+{
+public:
+	ProgressTrace(FILE* out, double interval);
+
+	// Write a record if the interval elapsed since the last one. Only valid
+	// inside a heuristic callback.
+	void Tick(SolverBackend* solver);
+
+private:
+	FILE* out;
+	double interval, start, last;
+	std::mutex mutex;
+};
+
+#endif
@@ -0,0 +1,82 @@
+#include "schedule.h"
+
+#include <algorithm>
+
+void BuildMachineSchedules(int n, int m, const int* proctime,
+	const int* setup, const std::vector<int>& machineOf,
+	std::vector<MachineSchedule>& machines)
+{
+	machines.assign(m, MachineSchedule());
+	for (int i = 0; i < m; i++)
+		machines[i].load = 0;
+
+	for (int j = 0; j < n; j++)
+	{
+		int i = machineOf[j];
+		if (i < 0 || i >= m)
+			continue;
+		MachineSchedule& mach = machines[i];
+		mach.jobs.push_back(j);
+		mach.start.push_back(mach.load);
+		mach.load += (long long)setup[j] + proctime[j];
+		mach.finish.push_back(mach.load);
+	}
+}
+
+void BuildTimedSchedules(int m, const std::vector<int>& machineOf,
+	const std::vector<long long>& start, const std::vector<long long>& finish,
+	std::vector<MachineSchedule>& machines)
+{
+	std::vector<int> order(machineOf.size());
+	for (size_t j = 0; j < order.size(); j++)
+		order[j] = (int)j;
+	std::stable_sort(order.begin(), order.end(),
+		[&start](int a, int b) { return start[a] < start[b]; });
+
+	machines.assign(m, MachineSchedule());
+	for (int i = 0; i < m; i++)
+		machines[i].load = 0;
+	for (size_t k = 0; k < order.size(); k++)
+	{
+		int j = order[k], i = machineOf[j];
+		if (i < 0 || i >= m)
+			continue;
+		MachineSchedule& mach = machines[i];
+		mach.jobs.push_back(j);
+		mach.start.push_back(start[j]);
+		mach.finish.push_back(finish[j]);
+		mach.load = finish[j];
+	}
+}
+
+void PrintMachineSchedules(FILE* out,
+	const std::vector<MachineSchedule>& machines)
+{
+	for (size_t i = 0; i < machines.size(); i++)
+		for (size_t k = 0; k < machines[i].jobs.size(); k++)
+			fprintf(out, "A maquina %d esta processando a tarefa %d\n", (int)i,
+				machines[i].jobs[k]);
+}
+
+bool WriteScheduleCSV(const char* fname, const int* proctime,
+	const std::vector<MachineSchedule>& machines)
+{
+	FILE* fout = fopen(fname, "w");
+	if (fout == NULL)
+		return false;
+
+	fprintf(fout, "machine,position,job,setup,proctime,start,finish\n");
+	for (size_t i = 0; i < machines.size(); i++)
+	{
+		const MachineSchedule& mach = machines[i];
+		for (size_t k = 0; k < mach.jobs.size(); k++)
+		{
+			int j = mach.jobs[k];
+			fprintf(fout, "%d,%d,%d,%lld,%d,%lld,%lld\n", (int)i, (int)k, j,
+				mach.finish[k] - mach.start[k] - proctime[j], proctime[j],
+				mach.start[k], mach.finish[k]);
+		}
+	}
+	fclose(fout);
+	return true;
+}
@@ -0,0 +1,50 @@
+/****************************************************************************
+* Per-machine view of a schedule
+*
+* The solvers return the machine of every job; the output needs, for every
+* machine, its jobs in processing order with their start and finish times.
+* Both are built from machineOf in a single pass over the jobs, or from the
+* start and finish of every job when the jobs are sequenced with idle times.
+*
+*****************************************************************************/
+
+#ifndef __SCHEDULE_H__
+#define __SCHEDULE_H__
+
+#include <stdio.h>
+#include <vector>
+
+struct MachineSchedule
+{
+	long long load;                 // finish time of the last job
+	std::vector<int> jobs;          // in processing order
+	std::vector<long long> start;   // start of the setup of each job
+	std::vector<long long> finish;  // end of the processing of each job
+};
+
+// Build the schedule of every machine, each job starting with its setup as
+// soon as the previous one finishes, in index order. Jobs whose machine is
+// out of range are skipped.
+void BuildMachineSchedules(int n, int m, const int* proctime,
+	const int* setup, const std::vector<int>& machineOf,
+	std::vector<MachineSchedule>& machines);
+
+// Build the schedule of every machine from the start (of the setup) and the
+// finish of every job, ordering the jobs of a machine by start.
+void BuildTimedSchedules(int m, const std::vector<int>& machineOf,
+	const std::vector<long long>& start, const std::vector<long long>& finish,
+	std::vector<MachineSchedule>& machines);
+
+// Print "A maquina i esta processando a tarefa j" for every job, machine by
+// machine.
+void PrintMachineSchedules(FILE* out,
+	const std::vector<MachineSchedule>& machines);
+
+// Write the schedule as CSV records
+// "machine,position,job,setup,proctime,start,finish", the setup being the
+// time from the start to the processing.
+// @return false if the file could not be opened
+bool WriteScheduleCSV(const char* fname, const int* proctime,
+	const std::vector<MachineSchedule>& machines);
+
+#endif
@@ -0,0 +1,336 @@
+#include "selftest.h"
+#include "arcflow.h"
+#include "binpack.h"
+#include "bounds.h"
+#include "checkpoint.h"
+#include "colgen.h"
+#include "dynprog.h"
+#include "generator.h"
+#include "heuristics.h"
+#include "instance.h"
+#include "lagrange.h"
+#include "options.h"
+#include "solve.h"
+#include "sysutil.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <math.h>
+#include <stdio.h>
+
+static const char* Classes[] = { "u100", "u1000", "n4n", "near", "huge" };
+static const int NumClasses = sizeof(Classes) / sizeof(Classes[0]);
+
+struct CheckCount
+{
+	int checks;
+	int failed;
+	int open;       // exact engines stopped by the time limit
+};
+
+// Count a check, printing it if it failed
+static void Check(CheckCount& count, bool ok, const std::string& what)
+{
+	count.checks++;
+	if (!ok)
+	{
+		count.failed++;
+		printf("FAILED: %s\n", what.c_str());
+		fflush(stdout);
+	}
+}
+
+// Every job is on a machine and the loads give the makespan reported
+static void CheckSchedule(CheckCount& count, const std::string& what,
+	const std::vector<int>& size, int m, long long makespan,
+	const std::vector<int>& machineOf)
+{
+	bool ok = machineOf.size() == size.size();
+	for (size_t j = 0; ok && j < machineOf.size(); j++)
+		ok = machineOf[j] >= 0 && machineOf[j] < m;
+	Check(count, ok && ScheduleMakespan(size, m, machineOf) == makespan,
+		what + ": the schedule does not have the makespan reported");
+}
+
+// An exact engine proves the optimum, unless the time limit stopped it, in
+// which case its schedule must not beat the optimum
+static void CheckExact(CheckCount& count, const std::string& what,
+	UFFLP_StatusType status, long long makespan, long long optimum,
+	double seconds, double timeLimit)
+{
+	if (status != UFFLP_Optimal && seconds >= timeLimit)
+	{
+		count.open++;
+		printf("OPEN: %s\n", what.c_str());
+		Check(count, makespan >= optimum, what);
+	}
+	else
+		Check(count, status == UFFLP_Optimal && makespan == optimum, what);
+}
+
+// Solve a generated instance with every exact engine and the bounding ones
+static void CheckEngines(const SelfTestOptions& opts, const char* name, int n,
+	int m, unsigned seed, CheckCount& count)
+{
+	std::vector<int> proctime, setup;
+	char buf[256];
+
+	sprintf(buf, "%s n=%d m=%d seed=%u", name, n, m, seed);
+	std::string label = buf;
+	if (!GenerateInstance(name, n, seed, proctime, setup))
+	{
+		Check(count, false, label + ": not generated");
+		return;
+	}
+	std::vector<int> size(n);
+	for (int j = 0; j < n; j++)
+		size[j] = proctime[j] + setup[j];
+
+	MakespanBounds bounds;
+	ComputeMakespanBounds(size, m, bounds);
+	std::vector<int> lpt;
+	long long upperBound = LptSchedule(size, m, lpt);
+
+	// the DP engine gives the optimum the others are checked against
+	long long optimum = upperBound;
+	std::vector<int> machineOf = lpt;
+	if (!SolveByDP(size, m, bounds.lower, optimum, machineOf))
+	{
+		Check(count, false, label + ": the DP engine gave up");
+		return;
+	}
+	CheckSchedule(count, label + " dp", size, m, optimum, machineOf);
+	Check(count, bounds.lower <= optimum, label + ": lower bound above the optimum");
+	printf("%-28s optimum %lld\n", label.c_str(), optimum);
+	fflush(stdout);
+
+	// the assignment model on the path of a single run, without the DP
+	VantOptions solve = opts.solve;
+	solve.machines = m;
+	solve.ninst = (int)seed;
+	solve.engine = "mip";
+	solve.model = "assign";
+	solve.searchTime = 0;
+	solve.lagrangeTime = 0;
+	SolveResult result;
+	double start = WallClock();
+	SolveInstance(solve, n, &proctime[0], &setup[0], result);
+	long long value = (long long)floor(result.value + 0.5);
+	sprintf(buf, "%s mip: %s %lld, bound %.0f, optimum %lld", label.c_str(),
+		StatusName(result.status), value, result.bestBound, optimum);
+	CheckExact(count, buf, result.status, value, optimum, WallClock() - start,
+		solve.timeLimit);
+	Check(count, result.bestBound <= optimum + 1e-6, buf);
+	CheckSchedule(count, label + " mip", size, m, value, result.machineOf);
+
+	EngineSettings settings;
+	settings.solver = opts.solve.solver.c_str();
+	settings.threads = opts.solve.threads;
+	settings.timeLimit = opts.solve.timeLimit;
+	settings.log = NULL;
+	settings.stats = NULL;
+	settings.shared = NULL;
+	settings.member = 0;
+
+	// arcflow and binpack close the gap, colgen and lagrange may stop short
+	static const char* engines[] = { "arcflow", "binpack", "colgen", "lagrange" };
+	for (int k = 0; k < 4; k++)
+	{
+		long long makespan = upperBound;
+		long long bound = bounds.lower;
+		UFFLP_StatusType status;
+		machineOf = lpt;
+		start = WallClock();
+		if (k == 0)
+			status = SolveArcFlow(size, m, settings, bounds.lower, makespan, machineOf);
+		else if (k == 1)
+			status = SolveByBinPacking(size, m, settings, bounds.lower, makespan,
+				machineOf);
+		else if (k == 2)
+			status = SolveColumnGeneration(size, m, settings, bounds.lower, makespan,
+				machineOf);
+		else
+			status = SolveLagrangian(size, m, settings, bound, makespan, machineOf);
+
+		sprintf(buf, "%s %s: %s %lld, bound %lld, optimum %lld", label.c_str(),
+			engines[k], StatusName(status), makespan, bound, optimum);
+		if (k < 2)
+			CheckExact(count, buf, status, makespan, optimum, WallClock() - start,
+				settings.timeLimit);
+		else
+			Check(count, makespan >= optimum && bound <= optimum &&
+				(status != UFFLP_Optimal || makespan == optimum), buf);
+		CheckSchedule(count, label + " " + engines[k], size, m, makespan, machineOf);
+	}
+}
+
+// File of this process in the working directory
+static std::string TempName(const char* suffix)
+{
+	char name[64];
+	sprintf(name, "vant-selftest.%d.%s", ProcessId(), suffix);
+	return name;
+}
+
+static bool WriteFile(const std::string& fname, const std::string& data)
+{
+	FILE* fout = fopen(fname.c_str(), "wb");
+	if (fout == NULL)
+		return false;
+	bool ok = fwrite(data.data(), 1, data.size(), fout) == data.size();
+	return fclose(fout) == 0 && ok;
+}
+
+// Binary instance of n jobs holding the given times, which may be fewer
+static std::string BinaryInstance(long long n, const std::vector<int>& times)
+{
+	std::string data("VANTJOB1", 8);
+	data.append((const char*)&n, sizeof(n));
+	if (!times.empty())
+		data.append((const char*)&times[0], times.size() * sizeof(int));
+	return data;
+}
+
+// Write and read back the instances in both formats, read the sections of
+// the text one, and reject the malformed ones
+static void CheckInstanceFiles(CheckCount& count)
+{
+	std::vector<int> proctime, setup, readProctime, readSetup;
+	JobRelations relations;
+	std::string fname = TempName("txt");
+
+	GenerateInstance("u1000", 50, 7, proctime, setup);
+	for (int binary = 0; binary < 2; binary++)
+	{
+		const char* format = binary ? "binary" : "text";
+		bool ok = WriteInstance(fname.c_str(), proctime, setup, binary != 0) &&
+			ReadInstance(fname.c_str(), readProctime, readSetup, &relations);
+		Check(count, ok && readProctime == proctime && readSetup == setup &&
+			relations.Empty(), std::string("round trip of a ") + format + " instance");
+	}
+
+	{
+		const char* text = "4\n5 1\n6 2\n7 3\n8 4\nprecedence 2\n0 1\n1 2\n"
+			"window 1\n3 10 -1\ntransition 1\n2 3 9\n";
+		bool ok = WriteFile(fname, text) &&
+			ReadInstance(fname.c_str(), readProctime, readSetup, &relations);
+		Check(count, ok && readProctime.size() == 4 && readSetup[3] == 4 &&
+			relations.arcs.size() == 2 && relations.arcs[1] == std::make_pair(1, 2) &&
+			relations.release.size() == 4 && relations.release[3] == 10 &&
+			relations.deadline[3] == -1 && relations.transitions.size() == 1 &&
+			relations.transitions[0].from == 2 && relations.transitions[0].to == 3 &&
+			relations.transitions[0].setup == 9, "sections of a text instance");
+	}
+
+	static const char* malformed[] =
+	{
+		"",                                     // empty
+		"3\n1 2\n3 4\n",                        // truncated
+		"2\n1 x\n3 4\n",                        // not a number
+		"-1\n",                                 // negative n
+		"1\n99999999999 0\n",                   // out of the range of an int
+		"2\n1 2\n3 4\nbogus 1\n0 1 2\n",        // unknown section
+		"2\n1 2\n3 4\nprecedence 1\n0 2\n",     // job out of range
+		"2\n1 2\n3 4\nwindow 1\n0 -5 3\n",      // negative release
+		"2\n1 2\n3 4\ntransition 1\n0 1\n",     // truncated section
+	};
+	for (size_t k = 0; k < sizeof(malformed) / sizeof(malformed[0]); k++)
+	{
+		bool read = WriteFile(fname, malformed[k]) &&
+			ReadInstance(fname.c_str(), readProctime, readSetup, &relations);
+		Check(count, !read, std::string("malformed text instance read: \"") +
+			malformed[k] + "\"");
+	}
+
+	std::vector<int> times(4, 1);
+	bool read = WriteFile(fname, BinaryInstance(3, times)) &&
+		ReadInstance(fname.c_str(), readProctime, readSetup);
+	Check(count, !read, "truncated binary instance read");
+	read = WriteFile(fname, BinaryInstance(-1, times)) &&
+		ReadInstance(fname.c_str(), readProctime, readSetup);
+	Check(count, !read, "binary instance with a negative n read");
+	remove(fname.c_str());
+}
+
+// Write a checkpoint and resume from it, and reject those of other
+// instances or malformed ones
+static void CheckCheckpoints(CheckCount& count)
+{
+	std::vector<int> proctime, setup, machineOf;
+	CheckpointState state;
+	std::string fname = TempName("ckpt");
+	const int m = 3;
+
+	GenerateInstance("u100", 20, 3, proctime, setup);
+	std::vector<int> size(proctime.size());
+	for (size_t j = 0; j < size.size(); j++)
+		size[j] = proctime[j] + setup[j];
+	MakespanBounds bounds;
+	ComputeMakespanBounds(size, m, bounds);
+	long long makespan = LptSchedule(size, m, machineOf);
+
+	SharedSearch run(bounds.lower);
+	run.Offer(PresolveMember, makespan, machineOf);
+	CheckpointWriter writer(fname.c_str(), 3600, size, m, 2.5, run);
+	bool ok = writer.Finish() && ReadCheckpoint(fname.c_str(), size, m, state);
+	Check(count, ok && state.makespan == makespan && state.machineOf == machineOf &&
+		state.bound == std::min(bounds.lower, makespan) && state.seconds >= 2.5,
+		"round trip of a checkpoint");
+	Check(count, !ReadCheckpoint(fname.c_str(), size, m + 1, state),
+		"checkpoint read with another number of machines");
+	std::vector<int> other = size;
+	other[0]++;
+	Check(count, !ReadCheckpoint(fname.c_str(), other, m, state),
+		"checkpoint of another instance read");
+
+	// the makespan comes from the loads, and the bound never exceeds it
+	size.assign(2, 0);
+	size[0] = 5;
+	size[1] = 3;
+	ok = WriteFile(fname, "vant-checkpoint 1 2 2 1 99 0\n5 0\n3 0\n") &&
+		ReadCheckpoint(fname.c_str(), size, 2, state);
+	Check(count, ok && state.makespan == 8 && state.bound == 8,
+		"makespan of a checkpoint not recomputed");
+
+	static const char* malformed[] =
+	{
+		"not a checkpoint\n",
+		"vant-checkpoint 2 2 2 5 5 0\n5 0\n3 1\n",  // unknown version
+		"vant-checkpoint 1 2 2 5 5 0\n5 0\n",       // truncated
+		"vant-checkpoint 1 2 2 5 5 0\n5 0\n3 2\n",  // machine out of range
+		"vant-checkpoint 1 2 2 5 5 0\n5 0\n4 1\n",  // other job size
+	};
+	for (size_t k = 0; k < sizeof(malformed) / sizeof(malformed[0]); k++)
+	{
+		bool read = WriteFile(fname, malformed[k]) &&
+			ReadCheckpoint(fname.c_str(), size, 2, state);
+		Check(count, !read, std::string("malformed checkpoint read: \"") +
+			malformed[k] + "\"");
+	}
+	remove(fname.c_str());
+}
+
+int RunSelfTest(int argc, char* argv[])
+{
+	SelfTestOptions opts;
+
+	if (!ParseSelfTestOptions(argc, argv, opts))
+		return 1;
+
+	CheckCount count = { 0, 0, 0 };
+	double start = WallClock();
+	for (int k = 0; k < opts.rounds; k++)
+	{
+		// every class, with 2 machines to the most the DP engine handles
+		int n = 1 + (k * 5) % opts.maxJobs;
+		int m = 2 + k % (MaxDpMachines - 1);
+		CheckEngines(opts, Classes[k % NumClasses], n, m, opts.solve.seed + k, count);
+	}
+	CheckInstanceFiles(count);
+	CheckCheckpoints(count);
+
+	printf("Self-test: %d checks, %d failed, %d left open by the time limit, %.1f s\n",
+		count.checks, count.failed, count.open, WallClock() - start);
+	return count.failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,22 @@
+/****************************************************************************
+* Regression checks of the engines and the file formats
+*
+* The engines are run on small generated instances, where the exact DP
+* engine gives the optimal makespan: the MIP, the arc-flow bisection and the
+* bin-packing search must prove the same value, or else run out of time
+* with a schedule no better, the column generation and the Lagrangian
+* relaxation must never return a schedule below it nor a bound above it,
+* and every schedule must have the makespan reported. The instance files
+* are written and read back in both formats, a checkpoint is written and
+* resumed, and malformed files of each kind must be rejected.
+*
+*****************************************************************************/
+
+#ifndef __SELF_TEST_H__
+#define __SELF_TEST_H__
+
+// Entry point of "vant --self-test [--option=value ...]".
+// @return 0 if every check passed, 1 otherwise
+int RunSelfTest(int argc, char* argv[]);
+
+#endif
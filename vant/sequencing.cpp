@@ -0,0 +1,468 @@
+#include "sequencing.h"
+#include "bounds.h"
+#include "heuristics.h"
+#include "models.h"
+#include "runstats.h"
+#include "solve.h"
+#include "sysutil.h"
+
+#include <algorithm>
+#include <queue>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+
+bool SequencingProblem::Init(int n, const int* proctime, const int* setup,
+	const JobRelations& relations)
+{
+	this->n = n;
+	this->proctime.assign(proctime, proctime + n);
+	this->setup.assign(setup, setup + n);
+	release.assign(n, 0);
+	deadline.assign(n, -1);
+	if (!relations.release.empty())
+	{
+		release = relations.release;
+		deadline = relations.deadline;
+	}
+
+	transition.clear();
+	std::vector<int> smallest(this->setup);
+	for (size_t k = 0; k < relations.transitions.size(); k++)
+	{
+		const Transition& t = relations.transitions[k];
+		transition[(long long)t.from * n + t.to] = t.setup;
+	}
+	for (std::unordered_map<long long, int>::const_iterator it = transition.begin();
+		it != transition.end(); ++it)
+	{
+		int to = (int)(it->first % n);
+		smallest[to] = std::min(smallest[to], it->second);
+	}
+	length.resize(n);
+	for (int j = 0; j < n; j++)
+		length[j] = (long long)proctime[j] + smallest[j];
+
+	arcs = relations.arcs;
+	std::sort(arcs.begin(), arcs.end());
+	arcs.erase(std::unique(arcs.begin(), arcs.end()), arcs.end());
+	givenArcs = (int)arcs.size();
+
+	// topological order, which leaves out the jobs of a cycle
+	std::vector<int> waiting(n, 0);
+	std::vector<std::vector<int> > out(n);
+	for (size_t k = 0; k < arcs.size(); k++)
+	{
+		out[arcs[k].first].push_back(arcs[k].second);
+		waiting[arcs[k].second]++;
+	}
+	topo.clear();
+	for (int j = 0; j < n; j++)
+		if (waiting[j] == 0)
+			topo.push_back(j);
+	for (size_t k = 0; k < topo.size(); k++)
+		for (size_t s = 0; s < out[topo[k]].size(); s++)
+			if (--waiting[out[topo[k]][s]] == 0)
+				topo.push_back(out[topo[k]][s]);
+	if ((int)topo.size() < n)
+		return false;
+	position.resize(n);
+	for (int k = 0; k < n; k++)
+		position[topo[k]] = k;
+
+	if (n <= MaxReductionJobs)
+		Reduce(topo);
+	preds.assign(n, std::vector<int>());
+	succs.assign(n, std::vector<int>());
+	for (size_t k = 0; k < arcs.size(); k++)
+	{
+		succs[arcs[k].first].push_back(arcs[k].second);
+		preds[arcs[k].second].push_back(arcs[k].first);
+	}
+
+	// longest path from the start of every job to the end
+	tail.assign(n, 0);
+	for (int k = n - 1; k >= 0; k--)
+	{
+		int j = topo[k];
+		tail[j] = length[j];
+		for (size_t s = 0; s < succs[j].size(); s++)
+			tail[j] = std::max(tail[j], length[j] + tail[succs[j][s]]);
+	}
+	return true;
+}
+
+void SequencingProblem::Reduce(const std::vector<int>& order)
+{
+	// successors by topological position: a successor reached through an
+	// earlier kept one is implied
+	std::vector<std::vector<int> > out(n);
+	for (size_t k = 0; k < arcs.size(); k++)
+		out[arcs[k].first].push_back(arcs[k].second);
+
+	size_t words = ((size_t)n + 63) / 64;
+	std::vector<uint64_t> reach(words * n, 0);
+	std::vector<std::pair<int, int> > kept;
+	for (int k = n - 1; k >= 0; k--)
+	{
+		int a = order[k];
+		uint64_t* ra = &reach[words * a];
+		std::sort(out[a].begin(), out[a].end(),
+			[this](int x, int y) { return position[x] < position[y]; });
+		for (size_t s = 0; s < out[a].size(); s++)
+		{
+			int b = out[a][s];
+			if (ra[b / 64] & ((uint64_t)1 << (b % 64)))
+				continue;
+			kept.push_back(std::make_pair(a, b));
+			const uint64_t* rb = &reach[words * b];
+			for (size_t w = 0; w < words; w++)
+				ra[w] |= rb[w];
+			ra[b / 64] |= (uint64_t)1 << (b % 64);
+		}
+	}
+	std::sort(kept.begin(), kept.end());
+	arcs.swap(kept);
+}
+
+int SequencingProblem::SetupAfter(int prev, int j) const
+{
+	if (prev >= 0 && !transition.empty())
+	{
+		std::unordered_map<long long, int>::const_iterator it =
+			transition.find((long long)prev * n + j);
+		if (it != transition.end())
+			return it->second;
+	}
+	return setup[j];
+}
+
+bool SequencingProblem::Windows(long long horizon, std::vector<long long>& est,
+	std::vector<long long>& lst) const
+{
+	est.assign(n, 0);
+	lst.assign(n, 0);
+	for (int k = 0; k < n; k++)
+	{
+		int j = topo[k];
+		est[j] = release[j];
+		for (size_t p = 0; p < preds[j].size(); p++)
+			est[j] = std::max(est[j], est[preds[j][p]] + length[preds[j][p]]);
+	}
+	for (int k = n - 1; k >= 0; k--)
+	{
+		int j = topo[k];
+		long long latest = horizon;
+		if (deadline[j] >= 0)
+			latest = std::min(latest, deadline[j]);
+		for (size_t s = 0; s < succs[j].size(); s++)
+			latest = std::min(latest, lst[succs[j][s]]);
+		lst[j] = latest - length[j];
+		if (lst[j] < est[j])
+			return false;
+	}
+	return true;
+}
+
+long long SequencingProblem::LowerBound(int m) const
+{
+	std::vector<long long> est, lst;
+	long long total = 0, path = 0;
+	Windows(0, est, lst);
+	for (int j = 0; j < n; j++)
+	{
+		total += length[j];
+		path = std::max(path, est[j] + tail[j]);
+	}
+	return std::max(path, (total + m - 1) / m);
+}
+
+long long SequencingProblem::Horizon() const
+{
+	std::vector<int> largest(setup);
+	for (std::unordered_map<long long, int>::const_iterator it = transition.begin();
+		it != transition.end(); ++it)
+	{
+		int to = (int)(it->first % n);
+		largest[to] = std::max(largest[to], it->second);
+	}
+	long long horizon = 0;
+	for (int j = 0; j < n; j++)
+		horizon += (long long)proctime[j] + largest[j];
+	return horizon + (n > 0 ? *std::max_element(release.begin(), release.end()) : 0);
+}
+
+long long SequencingProblem::ListSchedule(int m, std::vector<int>& machineOf,
+	std::vector<long long>& start, std::vector<long long>& finish) const
+{
+	std::vector<int> waiting(n), last(m, -1);
+	std::vector<long long> ready(release), free(m, 0);
+	typedef std::pair<long long, int> Entry;   // (tail, -job)
+	std::priority_queue<Entry> queue;
+
+	machineOf.assign(n, -1);
+	start.assign(n, 0);
+	finish.assign(n, 0);
+	for (int j = 0; j < n; j++)
+	{
+		waiting[j] = (int)preds[j].size();
+		if (waiting[j] == 0)
+			queue.push(Entry(tail[j], -j));
+	}
+
+	long long makespan = 0;
+	while (!queue.empty())
+	{
+		int j = -queue.top().second;
+		queue.pop();
+		int best = 0;
+		long long bestFinish = -1;
+		for (int i = 0; i < m; i++)
+		{
+			long long f = std::max(ready[j], free[i]) + SetupAfter(last[i], j) +
+				proctime[j];
+			if (bestFinish < 0 || f < bestFinish)
+			{
+				best = i;
+				bestFinish = f;
+			}
+		}
+		machineOf[j] = best;
+		start[j] = std::max(ready[j], free[best]);
+		finish[j] = bestFinish;
+		free[best] = bestFinish;
+		last[best] = j;
+		makespan = std::max(makespan, bestFinish);
+		for (size_t s = 0; s < succs[j].size(); s++)
+		{
+			int b = succs[j][s];
+			ready[b] = std::max(ready[b], bestFinish);
+			if (--waiting[b] == 0)
+				queue.push(Entry(tail[b], -b));
+		}
+	}
+	return makespan;
+}
+
+long long SequencingProblem::Retime(int m, const std::vector<int>& machineOf,
+	std::vector<long long>& start, std::vector<long long>& finish) const
+{
+	// the starts respect the arcs, so the jobs come after their predecessors
+	std::vector<int> order(n);
+	for (int j = 0; j < n; j++)
+		order[j] = j;
+	std::sort(order.begin(), order.end(), [&](int a, int b)
+	{
+		return start[a] < start[b] || (start[a] == start[b] && position[a] < position[b]);
+	});
+
+	std::vector<int> last(m, -1);
+	std::vector<long long> free(m, 0);
+	long long makespan = 0;
+	finish.assign(n, 0);
+	for (int k = 0; k < n; k++)
+	{
+		int j = order[k], i = machineOf[j];
+		long long s = std::max(release[j], free[i]);
+		for (size_t p = 0; p < preds[j].size(); p++)
+			s = std::max(s, finish[preds[j][p]]);
+		start[j] = s;
+		finish[j] = s + SetupAfter(last[i], j) + proctime[j];
+		free[i] = finish[j];
+		last[i] = j;
+		makespan = std::max(makespan, finish[j]);
+	}
+	return makespan;
+}
+
+bool SequencingProblem::MeetsDeadlines(const std::vector<long long>& finish) const
+{
+	for (int j = 0; j < n; j++)
+		if (deadline[j] >= 0 && finish[j] > deadline[j])
+			return false;
+	return true;
+}
+
+// Solve the time-indexed model within the horizon for a makespan of at most
+// cutoff, and time its schedule with the true setups.
+// @return the status of the MIP
+static UFFLP_StatusType SolveTimeIndexed(const SequencingProblem& problem, int m,
+	const EngineSettings& settings, long long lowerBound, long long horizon,
+	long long cutoff, const std::vector<long long>& est,
+	const std::vector<long long>& lst, double& bound, std::vector<int>& machineOf, std::vector<long long>& start,
+	std::vector<long long>& finish)
+{
+	int n = problem.Jobs();
+	std::vector<long long> length(n);
+	for (int j = 0; j < n; j++)
+		length[j] = problem.Length(j);
+
+	PhaseTimer buildTimer(settings.stats, Phase_Build);
+	ModelBuilder model(UFFLP_Minimize);
+	std::vector<int> first;
+	BuildTimeIndexedModel(model, m, length, problem.Arcs(), est, lst, lowerBound,
+		horizon, first);
+	model.ub[CmaxColumn] = (double)cutoff;
+	if (settings.log != NULL)
+		fprintf(settings.log, "Time-indexed model: %d variables, %d rows, %d nonzeros"
+			" (%d jobs, horizon %lld)\n", model.NumVariables(), model.NumConstraints(),
+			(int)model.NumNonzeros(), n, horizon);
+
+	SolverBackend* solver = CreateSolver(settings.solver);
+	if (solver == NULL)
+		return UFFLP_InternalError;
+	solver->LoadModel(model);
+	if (settings.stats != NULL)
+		settings.stats->RecordModel(model);
+	buildTimer.Stop();
+	solver->SetParameter(UFFLP_TimeLimit, settings.timeLimit);
+	solver->SetSolverParameter(SolverParam_Threads, settings.threads);
+
+	PhaseTimer solveTimer(settings.stats, Phase_Solve);
+	UFFLP_StatusType status = solver->Solve();
+	solveTimer.Stop();
+	if (settings.log != NULL)
+		fprintf(settings.log, "Time-indexed model: %s after %ld nodes\n",
+			StatusName(status), solver->NodeCount());
+	PhaseTimer extractTimer(settings.stats, Phase_Extract);
+	if (status == UFFLP_Optimal)
+		solver->GetObjValue(&bound);
+	else if (solver->GetBestBound(&bound) != UFFLP_Ok)
+		bound = 0;
+	if (status == UFFLP_Optimal || status == UFFLP_Feasible)
+	{
+		std::vector<double> x(model.NumVariables());
+		solver->GetSolutions(0, (int)x.size(), &x[0]);
+		start.resize(n);
+		for (int j = 0; j < n; j++)
+		{
+			start[j] = lst[j];
+			for (long long t = est[j]; t <= lst[j]; t++)
+				if (x[first[j] + (int)(t - est[j])] > 0.5)
+				{
+					start[j] = t;
+					break;
+				}
+		}
+
+		// at most m jobs run at once, so the earliest free machine is free
+		std::vector<int> order(n);
+		for (int j = 0; j < n; j++)
+			order[j] = j;
+		std::sort(order.begin(), order.end(),
+			[&start](int a, int b) { return start[a] < start[b]; });
+		std::vector<long long> free(m, 0);
+		machineOf.assign(n, 0);
+		for (int k = 0; k < n; k++)
+		{
+			int j = order[k];
+			int i = (int)(std::min_element(free.begin(), free.end()) - free.begin());
+			machineOf[j] = i;
+			free[i] = start[j] + length[j];
+		}
+		problem.Retime(m, machineOf, start, finish);
+	}
+	delete solver;
+	return status;
+}
+
+UFFLP_StatusType SolveSequencing(const SequencingProblem& problem, int m,
+	const EngineSettings& settings, bool useMip, long long& lowerBound,
+	long long& makespan, std::vector<int>& machineOf,
+	std::vector<long long>& start, std::vector<long long>& finish)
+{
+	int n = problem.Jobs();
+	makespan = problem.ListSchedule(m, machineOf, start, finish);
+	bool feasible = problem.MeetsDeadlines(finish);
+	lowerBound = problem.LowerBound(m);
+	if (settings.log != NULL)
+		fprintf(settings.log, "List schedule: %lld%s, lower bound %lld\n", makespan,
+			feasible ? "" : " missing deadlines", lowerBound);
+
+	// the presolve of the assignment model on the shortest lengths: its
+	// bounds hold under any arcs, and its schedules, timed with the arcs
+	// and the true setups, may beat the list schedule
+	std::vector<int> size(n);
+	for (int j = 0; j < n; j++)
+		size[j] = (int)problem.Length(j);
+	MakespanBounds bounds;
+	ComputeMakespanBounds(size, m, bounds);
+	lowerBound = std::max(lowerBound, bounds.lower);
+	for (int h = 0; h < 2; h++)
+	{
+		// equal starts: every machine takes its jobs in topological order
+		std::vector<int> schedule;
+		std::vector<long long> s(n, 0), f;
+		if (h == 0)
+			LptSchedule(size, m, schedule);
+		else
+			MultifitSchedule(size, m, schedule);
+		long long value = problem.Retime(m, schedule, s, f);
+		if (!problem.MeetsDeadlines(f) || (feasible && value >= makespan))
+			continue;
+		feasible = true;
+		makespan = value;
+		machineOf = schedule;
+		start = s;
+		finish = f;
+	}
+	if (settings.log != NULL)
+		fprintf(settings.log, "Presolve: %lld%s, lower bound %lld\n", makespan,
+			feasible ? "" : " missing deadlines", lowerBound);
+	if (feasible && makespan <= lowerBound)
+		return UFFLP_Optimal;
+	if (!useMip)
+		return feasible ? UFFLP_Feasible : UFFLP_Aborted;
+
+	// no schedule of the MIP goes past the list schedule or, without one,
+	// past a schedule that leaves no machine idle for nothing; the MIP only
+	// looks for a better one than the list schedule
+	long long horizon = feasible ? makespan : problem.Horizon();
+	long long cutoff = feasible ? makespan - 1 : horizon;
+	std::vector<long long> est, lst;
+	if (!problem.Windows(horizon, est, lst))
+		return feasible ? UFFLP_Feasible : UFFLP_Infeasible;
+	long long columns = 0;
+	for (int j = 0; j < n; j++)
+		columns += lst[j] - est[j] + 1;
+	if (columns > MaxTimeIndexedColumns)
+	{
+		if (settings.log != NULL)
+			fprintf(settings.log, "Time-indexed model too large: %lld variables\n",
+				columns);
+		return feasible ? UFFLP_Feasible : UFFLP_Aborted;
+	}
+
+	double bound = 0;
+	std::vector<int> mipMachineOf;
+	std::vector<long long> mipStart, mipFinish;
+	UFFLP_StatusType status = SolveTimeIndexed(problem, m, settings, lowerBound,
+		horizon, cutoff, est, lst, bound, mipMachineOf, mipStart, mipFinish);
+	if (status == UFFLP_Infeasible)
+	{
+		// even the relaxation has nothing better
+		if (!feasible)
+			return UFFLP_Infeasible;
+		lowerBound = makespan;
+		return UFFLP_Optimal;
+	}
+	lowerBound = std::max(lowerBound, (long long)ceil(bound - 1e-6));
+	if (status == UFFLP_Optimal || status == UFFLP_Feasible)
+	{
+		long long value = *std::max_element(mipFinish.begin(), mipFinish.end());
+		if (settings.log != NULL)
+			fprintf(settings.log, "Time-indexed bound %lld, schedule timed with the"
+				" true setups: %lld\n", lowerBound, value);
+		if (problem.MeetsDeadlines(mipFinish) && (!feasible || value < makespan))
+		{
+			feasible = true;
+			makespan = value;
+			machineOf = mipMachineOf;
+			start = mipStart;
+			finish = mipFinish;
+		}
+	}
+	if (!feasible)
+		return UFFLP_Aborted;
+	return makespan <= lowerBound ? UFFLP_Optimal : UFFLP_Feasible;
+}
@@ -0,0 +1,114 @@
+/****************************************************************************
+* Scheduling with precedence arcs, time windows and sequence-dependent setups
+*
+* A job occupies its machine from its start for its setup and processing
+* time. The setup is setup[j], or s_kj when j directly follows k on the
+* machine and the instance gives that transition. An arc (a, b) starts b
+* once a is finished, every job starts after its release and finishes by
+* its deadline, and the makespan is the largest finish.
+* The arcs are reduced transitively, keeping only those that no other path
+* implies. The windows of the starts follow by longest paths over them with
+* the shortest length of every job, its processing time plus its smallest
+* setup: forward from the releases, backward from the deadlines and a
+* horizon.
+* The MIP is time-indexed over the windows only, in binaries x_j_t for the
+* start of j at t, with the identical machines aggregated into a capacity of
+* m jobs per period and one row per reduced arc on the starts; no row needs
+* a big M. The bounds and the LPT and MULTIFIT schedules of the assignment
+* path, computed on the shortest lengths, seed it with a cutoff.
+* With the shortest lengths the model is a relaxation when setups depend on
+* the sequence: its starts give the machines and the order of the jobs,
+* which are then timed with the true setups.
+*
+*****************************************************************************/
+
+#ifndef __SEQUENCING_H__
+#define __SEQUENCING_H__
+
+#include "UFFLP.h"
+#include "instance.h"
+#include "solver.h"
+
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Largest number of jobs whose arcs are reduced: the reachability sets take
+// n^2 bits
+const int MaxReductionJobs = 20000;
+
+// Largest number of start variables of the time-indexed model
+const long long MaxTimeIndexedColumns = 200000;
+
+class SequencingProblem
+{
+public:
+	// @return false if the arcs form a cycle
+	bool Init(int n, const int* proctime, const int* setup,
+		const JobRelations& relations);
+
+	int Jobs() const { return n; }
+
+	// Setup of j right after prev on a machine, prev = -1 for the first job
+	int SetupAfter(int prev, int j) const;
+
+	// Processing time plus the smallest setup
+	long long Length(int j) const { return length[j]; }
+
+	// Arcs left by the transitive reduction, and the number given
+	const std::vector<std::pair<int, int> >& Arcs() const { return arcs; }
+	int GivenArcs() const { return givenArcs; }
+
+	// Earliest and latest starts of the schedules finishing by the horizon.
+	// @return false if a window is empty
+	bool Windows(long long horizon, std::vector<long long>& est,
+		std::vector<long long>& lst) const;
+
+	// Longest path from the releases, or the total length over m machines
+	long long LowerBound(int m) const;
+
+	// Makespan of any schedule that starts every job as early as its
+	// machine, arcs and release allow
+	long long Horizon() const;
+
+	// Serial list scheduling: the ready job with the longest path to the end
+	// goes to the machine that finishes it first.
+	// @return the makespan
+	long long ListSchedule(int m, std::vector<int>& machineOf,
+		std::vector<long long>& start, std::vector<long long>& finish) const;
+
+	// Order the jobs of every machine by start, then start each one as early
+	// as the true setups, the arcs and its release allow.
+	// @return the makespan
+	long long Retime(int m, const std::vector<int>& machineOf,
+		std::vector<long long>& start, std::vector<long long>& finish) const;
+
+	// Every job finishes by its deadline
+	bool MeetsDeadlines(const std::vector<long long>& finish) const;
+
+private:
+	void Reduce(const std::vector<int>& order);
+
+	int n, givenArcs;
+	std::vector<int> proctime, setup;
+	std::vector<long long> release, deadline, length, tail;
+	std::unordered_map<long long, int> transition;  // from * n + to
+	std::vector<std::pair<int, int> > arcs;
+	std::vector<std::vector<int> > preds, succs;
+	std::vector<int> topo, position;                // topological order
+};
+
+// Solve a sequencing problem: the best of a list schedule and the retimed
+// LPT and MULTIFIT schedules, then the time-indexed MIP if useMip and it
+// fits MaxTimeIndexedColumns.
+// @param lowerBound  the bound proven on return
+// @param makespan    the makespan of the schedule on return
+// @return UFFLP_Optimal if the schedule meets the bound, UFFLP_Feasible if
+//         it meets the deadlines, UFFLP_Infeasible if no schedule does and
+//         UFFLP_Aborted if none was found
+UFFLP_StatusType SolveSequencing(const SequencingProblem& problem, int m,
+	const EngineSettings& settings, bool useMip, long long& lowerBound,
+	long long& makespan, std::vector<int>& machineOf,
+	std::vector<long long>& start, std::vector<long long>& finish);
+
+#endif
@@ -0,0 +1,711 @@
+#include "simplex.h"
+#include "modelbuilder.h"
+
+#include <algorithm>
+#include <math.h>
+
+// Bounds at or beyond this magnitude are infinite
+static const double InfBound = UFFLP_Infinity;
+
+// Value given to a nonbasic variable whose required bound is infinite
+static const double ArtificialBound = 1e9;
+
+static const double PrimalTol = 1e-7;
+static const double DualTol = 1e-9;
+static const double PivotTol = 1e-9;
+
+// Column etas between two reinversions, and the smallest entry an eta keeps
+static const int RefactorPeriod = 100;
+static const double EtaDropTol = 1e-14;
+
+// The steepest edge weights are recomputed exactly at a reinversion while
+// rows times the work of a BTRAN stays below this; otherwise they restart
+// from one
+static const double ExactNormWork = 5e7;
+
+DualSimplex::DualSimplex() : ncols(0), nrows(0), maximize(false),
+	columnsDirty(true), objValue(0), iterations(0), updates(0)
+{
+}
+
+void DualSimplex::Load(const ModelBuilder& model)
+{
+	ncols = model.NumVariables();
+	nrows = model.NumConstraints();
+	maximize = model.sense == UFFLP_Maximize;
+
+	rowStart = model.rowStart;
+	rowCols = model.colIdx;
+	rowVals = model.value;
+	columnsDirty = true;
+
+	int total = ncols + nrows;
+	cost.assign(total, 0.0);
+	lb.resize(total);
+	ub.resize(total);
+	x.assign(total, 0.0);
+	d.assign(total, 0.0);
+	artificial.assign(total, false);
+	status.assign(total, AtLower);
+
+	for (int j = 0; j < ncols; j++)
+	{
+		cost[j] = maximize ? -model.obj[j] : model.obj[j];
+		lb[j] = model.lb[j];
+		ub[j] = model.ub[j];
+	}
+	for (int i = 0; i < nrows; i++)
+	{
+		double rhs = model.rhs[i];
+		lb[ncols + i] = model.sign[i] == UFFLP_Less ? -InfBound : rhs;
+		ub[ncols + i] = model.sign[i] == UFFLP_Greater ? InfBound : rhs;
+	}
+
+	// slack basis: B = -I, y = 0 and d = c
+	SlackBasis();
+	for (int j = 0; j < ncols; j++)
+	{
+		d[j] = cost[j];
+		SetNonbasicValue(j);
+	}
+}
+
+// Make every logical basic in its own row, with an empty eta file. The
+// caller fixes the status of the structurals that leave the basis.
+void DualSimplex::SlackBasis()
+{
+	basis.resize(nrows);
+	for (int i = 0; i < nrows; i++)
+	{
+		basis[i] = ncols + i;
+		status[ncols + i] = Basic;
+	}
+	rowNorm.assign(nrows, 1.0);
+	ClearEtas();
+}
+
+void DualSimplex::ClearEtas()
+{
+	etaRow.clear();
+	etaPivot.clear();
+	etaStart.assign(1, 0);
+	etaIndex.clear();
+	etaValue.clear();
+	updates = 0;
+}
+
+// Append the column eta of a pivot on row r of the transformed column col.
+void DualSimplex::AddEta(int r, const std::vector<double>& col)
+{
+	for (int i = 0; i < nrows; i++)
+	{
+		if (i == r || fabs(col[i]) < EtaDropTol)
+			continue;
+		etaIndex.push_back(i);
+		etaValue.push_back(col[i]);
+	}
+	etaRow.push_back(r);
+	etaPivot.push_back(col[r]);
+	etaStart.push_back((int)etaIndex.size());
+}
+
+// v := B^-1 v
+void DualSimplex::Ftran(std::vector<double>& v) const
+{
+	for (int i = 0; i < nrows; i++)
+		v[i] = -v[i];
+
+	for (size_t k = 0; k < etaRow.size(); k++)
+	{
+		int r = etaRow[k];
+		if (etaPivot[k] == 0.0)
+		{
+			double sum = 0.0;
+			for (int e = etaStart[k]; e < etaStart[k + 1]; e++)
+				sum += etaValue[e] * v[etaIndex[e]];
+			v[r] += sum;
+			continue;
+		}
+		if (v[r] == 0.0)
+			continue;
+		double vr = v[r] / etaPivot[k];
+		v[r] = vr;
+		for (int e = etaStart[k]; e < etaStart[k + 1]; e++)
+			v[etaIndex[e]] -= etaValue[e] * vr;
+	}
+}
+
+// v' := v' B^-1
+void DualSimplex::Btran(std::vector<double>& v) const
+{
+	for (size_t k = etaRow.size(); k-- > 0; )
+	{
+		int r = etaRow[k];
+		if (etaPivot[k] == 0.0)
+		{
+			double vr = v[r];
+			if (vr != 0.0)
+				for (int e = etaStart[k]; e < etaStart[k + 1]; e++)
+					v[etaIndex[e]] += etaValue[e] * vr;
+			continue;
+		}
+		double sum = v[r];
+		for (int e = etaStart[k]; e < etaStart[k + 1]; e++)
+			sum -= etaValue[e] * v[etaIndex[e]];
+		v[r] = sum / etaPivot[k];
+	}
+
+	for (int i = 0; i < nrows; i++)
+		v[i] = -v[i];
+}
+
+// y' = c_B' B^-1
+void DualSimplex::BasicCosts(std::vector<double>& y) const
+{
+	y.resize(nrows);
+	for (int i = 0; i < nrows; i++)
+		y[i] = cost[basis[i]];
+	Btran(y);
+}
+
+void DualSimplex::BuildColumns()
+{
+	colStart.assign(ncols + 1, 0);
+	for (size_t k = 0; k < rowCols.size(); k++)
+		colStart[rowCols[k] + 1]++;
+	for (int j = 0; j < ncols; j++)
+		colStart[j + 1] += colStart[j];
+
+	std::vector<int> fill(colStart.begin(), colStart.end() - 1);
+	colRows.resize(rowCols.size());
+	colVals.resize(rowCols.size());
+	for (int i = 0; i < nrows; i++)
+	{
+		for (int k = rowStart[i]; k < rowStart[i + 1]; k++)
+		{
+			int pos = fill[rowCols[k]]++;
+			colRows[pos] = i;
+			colVals[pos] = rowVals[k];
+		}
+	}
+	columnsDirty = false;
+}
+
+// Place a nonbasic variable at the bound that keeps its reduced cost dual
+// feasible. Infinite bounds are replaced by an artificial one.
+void DualSimplex::SetNonbasicValue(int j)
+{
+	bool lowerFinite = lb[j] > -InfBound;
+	bool upperFinite = ub[j] < InfBound;
+	int want;
+
+	if (d[j] > DualTol)
+		want = AtLower;
+	else if (d[j] < -DualTol)
+		want = AtUpper;
+	else if (status[j] == AtLower && lowerFinite)
+		want = AtLower;
+	else if (status[j] == AtUpper && upperFinite)
+		want = AtUpper;
+	else
+		want = lowerFinite ? AtLower : (upperFinite ? AtUpper : AtZero);
+
+	artificial[j] = false;
+	if (want == AtLower)
+	{
+		x[j] = lowerFinite ? lb[j] : -ArtificialBound;
+		artificial[j] = !lowerFinite;
+	}
+	else if (want == AtUpper)
+	{
+		x[j] = upperFinite ? ub[j] : ArtificialBound;
+		artificial[j] = !upperFinite;
+	}
+	else
+		x[j] = 0.0;
+	status[j] = (char)want;
+}
+
+void DualSimplex::Column(int j, std::vector<double>& col) const
+{
+	col.assign(nrows, 0.0);
+	if (j >= ncols)
+		col[j - ncols] = -1.0;
+	else
+		for (int k = colStart[j]; k < colStart[j + 1]; k++)
+			col[colRows[k]] = colVals[k];
+}
+
+double DualSimplex::RowDot(const double* y, int j) const
+{
+	if (j >= ncols)
+		return -y[j - ncols];
+
+	double sum = 0.0;
+	for (int k = colStart[j]; k < colStart[j + 1]; k++)
+		sum += y[colRows[k]] * colVals[k];
+	return sum;
+}
+
+// x_B = -B^-1 N x_N
+void DualSimplex::ComputePrimal()
+{
+	std::vector<double> t(nrows, 0.0);
+	int total = ncols + nrows;
+
+	for (int j = 0; j < total; j++)
+	{
+		if (status[j] == Basic || x[j] == 0.0)
+			continue;
+		if (j >= ncols)
+			t[j - ncols] -= x[j];
+		else
+			for (int k = colStart[j]; k < colStart[j + 1]; k++)
+				t[colRows[k]] += colVals[k] * x[j];
+	}
+
+	Ftran(t);
+	for (int i = 0; i < nrows; i++)
+		x[basis[i]] = -t[i];
+}
+
+// y' = c_B' B^-1 and d = c - A'y
+void DualSimplex::ComputeDuals()
+{
+	std::vector<double> y;
+	BasicCosts(y);
+
+	int total = ncols + nrows;
+	for (int j = 0; j < total; j++)
+		d[j] = status[j] == Basic ? 0.0 : cost[j] - RowDot(nrows > 0 ? &y[0] : NULL, j);
+}
+
+void DualSimplex::ComputeObjective()
+{
+	double sum = 0.0;
+	for (int j = 0; j < ncols; j++)
+		sum += cost[j] * x[j];
+	objValue = sum;
+}
+
+// Rebuild the eta file from the slack basis, pivoting each basic structural
+// into the row of a nonbasic logical with the largest entry; the basic
+// variables may change rows.
+// @return false if the basis is singular
+bool DualSimplex::Reinvert()
+{
+	std::vector<int> oldBasis(basis);
+	std::vector<char> taken(nrows, 0);
+	std::vector<double> col;
+
+	// the basic logicals keep their own rows
+	ClearEtas();
+	for (int i = 0; i < nrows; i++)
+		if (oldBasis[i] >= ncols)
+		{
+			int r = oldBasis[i] - ncols;
+			taken[r] = 1;
+			basis[r] = oldBasis[i];
+		}
+
+	for (int i = 0; i < nrows; i++)
+	{
+		int v = oldBasis[i];
+		if (v >= ncols)
+			continue;
+		Column(v, col);
+		Ftran(col);
+
+		int r = -1;
+		for (int k = 0; k < nrows; k++)
+			if (!taken[k] && (r < 0 || fabs(col[k]) > fabs(col[r])))
+				r = k;
+		if (r < 0 || fabs(col[r]) < 1e-11)
+		{
+			basis.swap(oldBasis);
+			return false;
+		}
+
+		AddEta(r, col);
+		taken[r] = 1;
+		basis[r] = v;
+	}
+
+	// the updated weights lose accuracy to cancellation
+	ComputeRowNorms();
+	return true;
+}
+
+void DualSimplex::ComputeRowNorms()
+{
+	double work = (double)nrows * (double)(nrows + etaIndex.size() + etaRow.size());
+	if (work > ExactNormWork)
+	{
+		rowNorm.assign(nrows, 1.0);
+		return;
+	}
+
+	std::vector<double> row;
+	rowNorm.resize(nrows);
+	for (int i = 0; i < nrows; i++)
+	{
+		row.assign(nrows, 0.0);
+		row[i] = 1.0;
+		Btran(row);
+		double norm = 0.0;
+		for (int k = 0; k < nrows; k++)
+			norm += row[k] * row[k];
+		rowNorm[i] = norm;
+	}
+}
+
+int DualSimplex::AddRow(int len, const int* cols, const double* vals,
+	double rlo, double rhi)
+{
+	int m = nrows;
+	int logical = ncols + m;
+
+	for (int k = 0; k < len; k++)
+	{
+		rowCols.push_back(cols[k]);
+		rowVals.push_back(vals[k]);
+	}
+	rowStart.push_back((int)rowCols.size());
+	columnsDirty = true;
+
+	// activity of the new row and its coefficients on the basic variables
+	std::vector<double> coef(ncols, 0.0);
+	double activity = 0.0;
+	for (int k = 0; k < len; k++)
+	{
+		coef[cols[k]] += vals[k];
+		activity += vals[k] * x[cols[k]];
+	}
+
+	// new inverse [[B^-1, 0], [a_B' B^-1, -1]]: a row eta adding a_B' times
+	// the other rows to the new one, whose base entry is -1
+	std::vector<double> aB(m);
+	for (int i = 0; i < m; i++)
+	{
+		int v = basis[i];
+		aB[i] = v < ncols ? coef[v] : 0.0;
+		if (aB[i] == 0.0)
+			continue;
+		etaIndex.push_back(i);
+		etaValue.push_back(aB[i]);
+	}
+	etaRow.push_back(m);
+	etaPivot.push_back(0.0);
+	etaStart.push_back((int)etaIndex.size());
+
+	Btran(aB);
+	double norm = 1.0;
+	for (int k = 0; k < m; k++)
+		norm += aB[k] * aB[k];
+	rowNorm.push_back(norm);
+
+	cost.push_back(0.0);
+	lb.push_back(rlo);
+	ub.push_back(rhi);
+	x.push_back(activity);
+	d.push_back(0.0);
+	artificial.push_back(false);
+	status.push_back(Basic);
+	basis.push_back(logical);
+	nrows++;
+	return m;
+}
+
+int DualSimplex::AddColumn(double lower, double upper, double c, int len,
+	const int* rows, const double* vals)
+{
+	int j = ncols;
+
+	// append the coefficients to their rows
+	std::vector<int> extra(nrows + 1, 0);
+	for (int k = 0; k < len; k++)
+		extra[rows[k] + 1]++;
+	for (int i = 0; i < nrows; i++)
+		extra[i + 1] += extra[i];
+
+	std::vector<int> start(nrows + 1), cols(rowCols.size() + len);
+	std::vector<double> coefs(cols.size());
+	for (int i = 0; i < nrows; i++)
+	{
+		start[i] = rowStart[i] + extra[i];
+		std::copy(rowCols.begin() + rowStart[i], rowCols.begin() + rowStart[i + 1],
+			cols.begin() + start[i]);
+		std::copy(rowVals.begin() + rowStart[i], rowVals.begin() + rowStart[i + 1],
+			coefs.begin() + start[i]);
+	}
+	start[nrows] = (int)cols.size();
+	for (int k = 0; k < len; k++)
+	{
+		int pos = rowStart[rows[k] + 1] + extra[rows[k]]++;
+		cols[pos] = j;
+		coefs[pos] = vals[k];
+	}
+	rowStart.swap(start);
+	rowCols.swap(cols);
+	rowVals.swap(coefs);
+
+	// the logicals move up by one position
+	cost.insert(cost.begin() + j, maximize ? -c : c);
+	lb.insert(lb.begin() + j, lower);
+	ub.insert(ub.begin() + j, upper);
+	x.insert(x.begin() + j, 0.0);
+	d.insert(d.begin() + j, 0.0);
+	artificial.insert(artificial.begin() + j, false);
+	status.insert(status.begin() + j, (char)AtLower);
+	for (int i = 0; i < nrows; i++)
+		if (basis[i] >= j)
+			basis[i]++;
+	ncols++;
+	BuildColumns();
+
+	// reduced cost under the current duals
+	std::vector<double> y;
+	BasicCosts(y);
+	d[j] = cost[j] - RowDot(nrows > 0 ? &y[0] : NULL, j);
+	SetNonbasicValue(j);
+	return j;
+}
+
+void DualSimplex::SetBounds(int col, double lower, double upper)
+{
+	lb[col] = lower;
+	ub[col] = upper;
+	if (status[col] != Basic)
+		SetNonbasicValue(col);
+}
+
+void DualSimplex::SetCost(int col, double c)
+{
+	cost[col] = maximize ? -c : c;
+	if (columnsDirty)
+		BuildColumns();
+	ComputeDuals();
+	for (int j = 0; j < ncols + nrows; j++)
+		if (status[j] != Basic)
+			SetNonbasicValue(j);
+}
+
+void DualSimplex::Duals(std::vector<double>& y) const
+{
+	BasicCosts(y);
+	if (maximize)
+		for (int i = 0; i < nrows; i++)
+			y[i] = -y[i];
+}
+
+double DualSimplex::RowViolation(const double* xs) const
+{
+	double worst = 0.0;
+
+	for (int i = 0; i < nrows; i++)
+	{
+		double activity = 0.0;
+		for (int k = rowStart[i]; k < rowStart[i + 1]; k++)
+			activity += rowVals[k] * xs[rowCols[k]];
+		worst = fmax(worst, lb[ncols + i] - activity);
+		worst = fmax(worst, activity - ub[ncols + i]);
+	}
+	return worst;
+}
+
+DualSimplex::Status DualSimplex::Solve(double cutoff, long maxIter)
+{
+	int total = ncols + nrows;
+	int period = RefactorPeriod;
+	bool refreshed = false;
+
+	if (columnsDirty)
+		BuildColumns();
+	ComputePrimal();
+
+	for (long iter = 0; ; iter++)
+	{
+		if (iter >= maxIter)
+		{
+			ComputeObjective();
+			return IterationLimit;
+		}
+
+		// periodic reinversion keeps the eta file short and accurate
+		if (updates >= period)
+		{
+			if (!Reinvert())
+			{
+				// singular basis: restart from the slack basis
+				for (int j = 0; j < total; j++)
+					if (status[j] == Basic)
+						status[j] = AtLower;
+				SlackBasis();
+			}
+			ComputeDuals();
+			for (int j = 0; j < total; j++)
+				if (status[j] != Basic)
+					SetNonbasicValue(j);
+			ComputePrimal();
+		}
+		else if (iter > 0 && iter % 50 == 0)
+			ComputePrimal();
+
+		// leaving variable: dual steepest edge, the bound violation scaled by
+		// the norm of the row of B^-1
+		int r = -1;
+		double worst = 0.0;
+		for (int i = 0; i < nrows; i++)
+		{
+			int v = basis[i];
+			double viol = 0.0;
+			if (x[v] < lb[v] - PrimalTol)
+				viol = lb[v] - x[v];
+			else if (x[v] > ub[v] + PrimalTol)
+				viol = x[v] - ub[v];
+			if (viol > 0.0 && (r < 0 || viol * viol > worst * rowNorm[i]))
+			{
+				worst = viol * viol / rowNorm[i];
+				r = i;
+			}
+		}
+
+		if (r < 0)
+		{
+			// confirm optimality on freshly computed values
+			if (!refreshed && iter > 0)
+			{
+				refreshed = true;
+				ComputePrimal();
+				continue;
+			}
+			ComputeObjective();
+			for (int j = 0; j < total; j++)
+				if (status[j] != Basic && artificial[j])
+					return Unbounded;
+			return Optimal;
+		}
+		refreshed = false;
+
+		int p = basis[r];
+		bool toLower = x[p] < lb[p];
+		double bound = toLower ? lb[p] : ub[p];
+		double sgn = toLower ? -1.0 : 1.0;
+
+		// row r of the tableau
+		rho.assign(nrows, 0.0);
+		rho[r] = 1.0;
+		Btran(rho);
+		alphaRow.assign(total, 0.0);
+		for (int i = 0; i < nrows; i++)
+		{
+			double ri = rho[i];
+			if (ri == 0.0)
+				continue;
+			for (int k = rowStart[i]; k < rowStart[i + 1]; k++)
+				alphaRow[rowCols[k]] += ri * rowVals[k];
+			alphaRow[ncols + i] = -ri;
+		}
+
+		// Harris ratio test on d_j - theta * sgn * alpha_rj
+		double thetaMax = 1e300;
+		for (int j = 0; j < total; j++)
+		{
+			if (status[j] == Basic || lb[j] == ub[j])
+				continue;
+			double a = sgn * alphaRow[j];
+			if (status[j] == AtLower && a > PivotTol)
+				thetaMax = fmin(thetaMax, (d[j] + DualTol) / a);
+			else if (status[j] == AtUpper && a < -PivotTol)
+				thetaMax = fmin(thetaMax, (d[j] - DualTol) / a);
+			else if (status[j] == AtZero && fabs(a) > PivotTol)
+				thetaMax = fmin(thetaMax, (fabs(d[j]) + DualTol) / fabs(a));
+		}
+
+		int q = -1;
+		double best = 0.0;
+		for (int j = 0; j < total; j++)
+		{
+			if (status[j] == Basic || lb[j] == ub[j])
+				continue;
+			double a = sgn * alphaRow[j];
+			double ratio;
+			if (status[j] == AtLower && a > PivotTol)
+				ratio = d[j] / a;
+			else if (status[j] == AtUpper && a < -PivotTol)
+				ratio = d[j] / a;
+			else if (status[j] == AtZero && fabs(a) > PivotTol)
+				ratio = fabs(d[j]) / fabs(a);
+			else
+				continue;
+			if (ratio <= thetaMax && fabs(a) > best)
+			{
+				best = fabs(a);
+				q = j;
+			}
+		}
+
+		if (q < 0)
+		{
+			ComputeObjective();
+			return Infeasible;
+		}
+
+		// column of the entering variable
+		Column(q, alphaCol);
+		Ftran(alphaCol);
+		double pivot = alphaCol[r];
+		if (fabs(pivot) < PivotTol)
+		{
+			// numerical trouble: force a reinversion and retry
+			updates = period;
+			continue;
+		}
+
+		// dual update
+		double t = d[q] / alphaRow[q];
+		for (int j = 0; j < total; j++)
+			if (status[j] != Basic)
+				d[j] -= t * alphaRow[j];
+		d[q] = 0.0;
+		d[p] = -t;
+
+		// primal update
+		double delta = (x[p] - bound) / pivot;
+		for (int i = 0; i < nrows; i++)
+			x[basis[i]] -= alphaCol[i] * delta;
+		x[q] += delta;
+		x[p] = bound;
+
+		// basis change
+		status[q] = Basic;
+		artificial[q] = false;
+		status[p] = (char)(toLower ? AtLower : AtUpper);
+		basis[r] = q;
+
+		// dual steepest edge weights of the new basis from tau = B^-1 rho,
+		// then the eta of the pivot
+		tau = rho;
+		Ftran(tau);
+		double wr = rowNorm[r] / (pivot * pivot);
+		for (int i = 0; i < nrows; i++)
+		{
+			double f = alphaCol[i] / pivot;
+			if (i == r || f == 0.0)
+				continue;
+			double w = rowNorm[i] - 2.0 * f * tau[i] + f * f * rowNorm[r];
+			rowNorm[i] = fmax(w, 1e-12);
+		}
+		rowNorm[r] = wr;
+		AddEta(r, alphaCol);
+		updates++;
+		iterations++;
+
+		if (cutoff < 1e300)
+		{
+			ComputeObjective();
+			if (objValue > cutoff)
+				return CutoffReached;
+		}
+	}
+}
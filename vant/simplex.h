@@ -0,0 +1,138 @@
+/****************************************************************************
+* DualSimplex - bounded-variable dual simplex for the native MIP engine
+*
+* Solves min c'x s.t. rlo <= Ax <= rhi, lb <= x <= ub. Every row i gets a
+* logical variable r_i = a_i'x bounded by [rlo_i, rhi_i], so the starting
+* basis made of logicals is always available. The basis inverse is kept in
+* product form: a file of sparse eta transformations over the slack basis,
+* rebuilt from the basis columns every hundred updates, so memory grows with
+* the nonzeros of the basis instead of the square of the rows. Changing
+* bounds keeps the basis dual feasible, so a child node of the
+* branch-and-bound tree warm starts from its parent's basis.
+*
+*****************************************************************************/
+
+#ifndef __SIMPLEX_H__
+#define __SIMPLEX_H__
+
+#include <vector>
+
+class ModelBuilder;
+
+class DualSimplex
+{
+public:
+	enum Status
+	{
+		Optimal,
+		Infeasible,     // the dual is unbounded
+		Unbounded,      // a variable ended at an artificial bound
+		CutoffReached,  // the objective exceeded the cutoff
+		IterationLimit
+	};
+
+	enum VarStatus
+	{
+		Basic,
+		AtLower,
+		AtUpper,
+		AtZero          // nonbasic free variable
+	};
+
+	DualSimplex();
+
+	// Load the columns, costs and bounds of a model. Maximization problems
+	// are turned into minimization by negating the costs.
+	void Load(const ModelBuilder& model);
+
+	// Append a row rlo <= a'x <= rhi whose logical enters the basis.
+	// @return the index of the new row
+	int AddRow(int len, const int* cols, const double* vals, double rlo,
+		double rhi);
+
+	// Append a structural variable, nonbasic at the bound that keeps the
+	// basis dual feasible.
+	// @return the index of the new column
+	int AddColumn(double lower, double upper, double cost, int len,
+		const int* rows, const double* vals);
+
+	// Change the bounds of a structural variable.
+	void SetBounds(int col, double lb, double ub);
+
+	// Change the cost of a structural variable.
+	void SetCost(int col, double cost);
+
+	// Run the dual simplex from the current basis.
+	// @param cutoff stop as soon as the objective exceeds this value, given
+	//               for the minimization form of the problem
+	// @param maxIter maximum number of iterations for this call
+	Status Solve(double cutoff, long maxIter);
+
+	int NumCols() const { return ncols; }
+	int NumRows() const { return nrows; }
+	double ObjValue() const { return maximize ? -objValue : objValue; }
+	long Iterations() const { return iterations; }
+
+	// Primal values of the structural variables
+	const double* Primal() const { return &x[0]; }
+
+	// Row duals y, with reduced costs d = c - A'y
+	void Duals(std::vector<double>& y) const;
+
+	// Largest violation of a row bound by the given structural values
+	double RowViolation(const double* xs) const;
+
+	// Current bounds of a structural variable
+	double Lower(int col) const { return lb[col]; }
+	double Upper(int col) const { return ub[col]; }
+
+private:
+	void BuildColumns();
+	void SetNonbasicValue(int j);
+	void ComputePrimal();
+	void ComputeDuals();
+	void ComputeObjective();
+	bool Reinvert();
+	void SlackBasis();
+	void ClearEtas();
+	void ComputeRowNorms();
+	void AddEta(int r, const std::vector<double>& col);
+	void Ftran(std::vector<double>& v) const;
+	void Btran(std::vector<double>& v) const;
+	void BasicCosts(std::vector<double>& y) const;
+	void Column(int j, std::vector<double>& col) const;
+	double RowDot(const double* rho, int j) const;
+
+	int ncols;      // structural variables
+	int nrows;      // rows, one logical variable each
+	bool maximize;
+
+	// rows in CSR form, columns in CSC form rebuilt whenever rows are added
+	std::vector<int> rowStart, rowCols;
+	std::vector<double> rowVals;
+	std::vector<int> colStart, colRows;
+	std::vector<double> colVals;
+	bool columnsDirty;
+
+	// structural variables first, then one logical per row
+	std::vector<double> cost, lb, ub, x, d;
+	std::vector<bool> artificial;   // nonbasic at an artificial bound
+	std::vector<char> status;
+	std::vector<int> basis;         // variable basic in each row
+
+	// B^-1 = E_k ... E_1 (-I). A column eta k pivots on row etaRow[k] by
+	// etaPivot[k]; a row eta (etaPivot[k] == 0) adds to row etaRow[k] the
+	// combination of the other rows given by its entries.
+	std::vector<int> etaRow, etaStart, etaIndex;
+	std::vector<double> etaPivot, etaValue;
+	std::vector<double> rowNorm;    // squared norms of the rows of B^-1
+
+	double objValue;
+	long iterations;
+	int updates;                    // column etas since reinversion
+
+	// scratch
+	std::vector<double> rho, alphaRow, alphaCol, tau;
+};
+
+#endif
@@ -0,0 +1,863 @@
+#include "solve.h"
+#include "models.h"
+#include "arcflow.h"
+#include "binpack.h"
+#include "colgen.h"
+#include "cuts.h"
+#include "bounds.h"
+#include "cache.h"
+#include "checkpoint.h"
+#include "dynprog.h"
+#include "export.h"
+#include "heuristics.h"
+#include "lagrange.h"
+#include "localsearch.h"
+#include "portfolio.h"
+#include "sequencing.h"
+#include "solver.h"
+#include "sysutil.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <math.h>
+#include <stdio.h>
+
+// Schedules handed to the solver as incumbents: the starting schedule, then
+// every improvement of the local search running alongside the MIP
+struct WarmStart
+{
+	std::vector<int> cols;
+	std::vector<double> values;
+	long long makespan;         // of the schedule in cols and values
+	bool sent;
+	bool fromSearch;
+
+	// translation of a schedule into columns of the model
+	int n, m;
+	bool aggregate;
+	const JobTypes* types;
+	const std::vector<int>* size;
+	const std::vector<int>* order;
+	std::string symmetry;
+
+	SharedSchedule* search;     // NULL without a local search
+	ProgressTrace* trace;       // NULL without a progress trace
+	SharedSearch* shared;       // of the portfolio or of a checkpointed run,
+	int member;                 // NULL for none; published as this member
+	CutSeparator* cuts;         // NULL without cut separation
+	std::mutex mutex;
+};
+
+// Turn a schedule into values of the model columns, renumbering the machines
+// as the symmetry breaking rows expect.
+static void SetWarmStart(WarmStart& warm, long long makespan,
+	std::vector<int>& machineOf)
+{
+	int n = warm.n, m = warm.m;
+
+	if (warm.symmetry == "loads")
+		RelabelByLoad(*warm.size, m, machineOf);
+	else if (warm.symmetry == "fix" && !warm.aggregate)
+		RelabelByFirstJob(*warm.order, m, machineOf);
+
+	warm.cols.clear();
+	warm.values.clear();
+	warm.cols.push_back(CmaxColumn);
+	warm.values.push_back((double)makespan);
+	if (warm.aggregate)
+	{
+		int ntypes = (int)warm.types->jobs.size();
+		std::vector<int> count(m * ntypes, 0);
+		for (int t = 0; t < ntypes; t++)
+			for (size_t k = 0; k < warm.types->jobs[t].size(); k++)
+				count[machineOf[warm.types->jobs[t][k]] * ntypes + t]++;
+		for (int i = 0; i < m * ntypes; i++)
+		{
+			warm.cols.push_back(1 + i);
+			warm.values.push_back(count[i]);
+		}
+	}
+	else
+	{
+		for (int j = 0; j < n; j++)
+		{
+			warm.cols.push_back(AssignColumn(n, machineOf[j], j));
+			warm.values.push_back(1.0);
+		}
+	}
+	warm.makespan = makespan;
+	warm.sent = false;
+}
+
+// Schedule of the values of the assignment columns from column 1: one per
+// job and machine, or one count per job type and machine when aggregated,
+// rounding away the tolerance of the backend
+static void ScheduleOfColumns(const WarmStart& warm, const std::vector<double>& x,
+	std::vector<int>& machineOf)
+{
+	if (warm.aggregate)
+	{
+		std::vector<int> count(x.size());
+		for (size_t k = 0; k < x.size(); k++)
+			count[k] = (int)floor(x[k] + 0.5);
+		ExpandTypeCounts(*warm.types, warm.m, count, machineOf);
+	}
+	else
+	{
+		for (int i = 0; i < warm.m; i++)
+			for (int j = 0; j < warm.n; j++)
+				if (x[i * warm.n + j] > 0.5)
+					machineOf[j] = i;
+	}
+}
+
+// Publish an integral node below the shared schedule, which the solver is
+// about to take as its incumbent
+static void PublishNode(SolverBackend* solver, WarmStart& warm)
+{
+	double objective;
+	long long current = warm.shared->incumbent.Value();
+	if (solver->GetObjValue(&objective) != UFFLP_Ok ||
+		(current >= 0 && objective > current - 0.5))
+		return;
+
+	int width = warm.aggregate ? (int)warm.types->jobs.size() : warm.n;
+	std::vector<double> x(warm.m * width);
+	std::vector<int> machineOf(warm.n, 0);
+	if (x.empty() || solver->GetSolutions(1, (int)x.size(), &x[0]) != UFFLP_Ok)
+		return;
+	for (size_t k = 0; k < x.size(); k++)
+		if (fabs(x[k] - floor(x[k] + 0.5)) > 1e-5)
+			return;
+	ScheduleOfColumns(warm, x, machineOf);
+	std::vector<long long> load(warm.m, 0);
+	for (int j = 0; j < warm.n; j++)
+		load[machineOf[j]] += (*warm.size)[j];
+	warm.shared->Offer(warm.member, *std::max_element(load.begin(), load.end()),
+		machineOf);
+}
+
+// Heuristic callback: provide the starting schedule once, and later the
+// schedules of the local search that beat it. The bound, the integral nodes
+// and the schedules of the local search are published to the shared search.
+static void WarmStartCallback(SolverBackend* solver, void* data)
+{
+	WarmStart* warm = (WarmStart*)data;
+	std::lock_guard<std::mutex> lock(warm->mutex);
+
+	if (warm->trace != NULL)
+		warm->trace->Tick(solver);
+
+	double bound;
+	if (warm->shared != NULL && solver->GetBestBound(&bound) == UFFLP_Ok)
+		warm->shared->RaiseBound(warm->member, (long long)ceil(bound - 1e-6));
+	if (warm->shared != NULL)
+		PublishNode(solver, *warm);
+
+	// the cuts only keep the schedules better than the incumbent
+	double best;
+	if (warm->cuts != NULL && solver->GetBestSolutionValue(&best) == UFFLP_Ok)
+		warm->cuts->SetIncumbent((long long)floor(best + 0.5));
+
+	long long found = warm->search != NULL ? warm->search->Value() : -1;
+	if (found >= 0 && found < warm->makespan)
+	{
+		std::vector<int> schedule;
+		found = warm->search->Best(schedule);
+		if (warm->shared != NULL)
+			warm->shared->Offer(warm->member, found, schedule);
+		SetWarmStart(*warm, found, schedule);
+		warm->fromSearch = true;
+	}
+
+	if (warm->sent)
+		return;
+	warm->sent = true;
+
+	for (size_t k = 0; k < warm->cols.size(); k++)
+		solver->SetSolution(warm->cols[k], warm->values[k]);
+	solver->PrintToLog(warm->fromSearch ? "Incumbent from the local search\n" :
+		"Warm start from the constructive heuristics\n");
+}
+
+// Solve the assignment model with the selected backend, starting from the
+// schedule in result.machineOf whose makespan is upperBound. Identical jobs
+// share integer count variables unless opts.aggregate is "off". In a
+// portfolio the incumbents come from the shared schedule instead of a local
+// search of its own. Outside one, the search of a checkpointed run gets the
+// schedules and the bound, and its flag stops the solve.
+static UFFLP_StatusType SolveAssignmentModel(const VantOptions& opts, int n,
+	int m, const int* proctime, const int* setup, long long lowerBound,
+	long long upperBound, SolveResult& result, ProgressTrace* trace,
+	SharedSearch* shared = NULL, int member = 0, SharedSearch* run = NULL)
+{
+	int i, t;
+	WarmStart warm;
+	JobTypes types;
+	std::vector<int> size, order, weight;
+	double& value = result.value;
+	std::vector<int>& machineOf = result.machineOf;
+	PhaseTimer buildTimer(&result.stats, Phase_Build);
+	// building and loading the model count against the time limit
+	double start = WallClock();
+
+	GroupJobTypes(n, proctime, setup, types);
+	int ntypes = (int)types.jobs.size();
+	// fixing jobs to machines needs one column per job
+	bool aggregate = opts.aggregate == "on" ||
+		(opts.aggregate == "auto" && ntypes < n && opts.symmetry != "fix");
+	JobSizes(n, proctime, setup, size);
+	SortBySize(size, order);
+
+	// build the model by index and hand it to the solver in a single pass
+	if (opts.verbose)
+		puts("Fill the objective function...");
+	ModelBuilder model(UFFLP_Minimize);
+	if (aggregate)
+	{
+		BuildAggregatedModel(model, types, m);
+		if (opts.verbose)
+			printf("Aggregated %d jobs into %d types: %d variables instead of %d\n",
+				n, ntypes, model.NumVariables(), 1 + n * m);
+	}
+	else
+		BuildAssignmentModel(model, n, m, proctime, setup);
+
+	// symmetry breaking; the warm start schedules are renumbered to satisfy it
+	if (aggregate)
+		for (t = 0; t < ntypes; t++)
+			weight.push_back(types.setup[t] + types.proctime[t]);
+	else
+		weight = size;
+	if (opts.symmetry == "loads")
+		AddLoadOrdering(model, m, weight);
+	else if (opts.symmetry == "fix" && !aggregate)
+		FixJobsToMachines(model, n, m, order);
+
+	SolverBackend* solver = CreateSolver(opts.solver.c_str());
+	if (solver == NULL)
+	{
+		printf("Solver backend not available: %s\n", opts.solver.c_str());
+		return UFFLP_InternalError;
+	}
+	solver->LoadModel(model);
+	if (shared != NULL)
+		solver->SetStopFlag(&shared->stop);
+	else if (run != NULL)
+		solver->SetStopFlag(&run->stop);
+	result.stats.RecordModel(model);
+
+	// branch first on the largest jobs
+	if (opts.symmetry == "priority")
+		for (i = 0; i < m; i++)
+			for (size_t k = 0; k < weight.size(); k++)
+				solver->SetPriority(1 + i * (int)weight.size() + (int)k, weight[k]);
+
+	buildTimer.Stop();
+
+	// Write the problem for debug, overlapping with the solve
+	char base[64];
+	sprintf(base, "vant%d-%dm-%d", n, m, opts.ninst);
+	ModelExport modelExport;
+	if (!opts.exportFormat.empty())
+		modelExport.Start(model, std::string(base) + "." + opts.exportFormat);
+
+	// Configure the log file and the log level = 3
+	if (opts.files == "on")
+		solver->SetLogInfo((std::string(base) + ".log").c_str(), 2);
+
+	// start from the heuristic schedule
+	warm.n = n;
+	warm.m = m;
+	warm.aggregate = aggregate;
+	warm.types = &types;
+	warm.size = &size;
+	warm.order = &order;
+	warm.symmetry = opts.symmetry;
+	warm.fromSearch = false;
+	warm.trace = trace;
+	warm.shared = shared != NULL ? shared : run;
+	warm.member = member;
+	SetWarmStart(warm, upperBound, machineOf);
+
+	double timeLeft = std::max(0.0, opts.timeLimit - (WallClock() - start));
+
+	// keep the local search running on one thread, feeding the callback
+	SharedSchedule search;
+	std::atomic<bool> stopSearch(false);
+	LocalSearchSettings settings;
+	std::thread searchThread;
+	warm.search = NULL;
+	if (shared != NULL)
+		warm.search = &shared->incumbent;
+	else if (opts.searchTime > 0)
+	{
+		search.Offer(upperBound, machineOf);
+		settings.threads = 1;
+		settings.timeLimit = timeLeft;
+		settings.seed = opts.seed;
+		settings.lowerBound = lowerBound;
+		settings.stop = &stopSearch;
+		warm.search = &search;
+		searchThread = std::thread(IteratedLocalSearch, std::cref(size), m,
+			std::cref(settings), std::ref(search));
+	}
+	solver->SetHeurCallBack(WarmStartCallback, &warm);
+
+	// cuts on the load rows near the root
+	std::unique_ptr<CutSeparator> separator;
+	warm.cuts = NULL;
+	if (opts.cuts == "on")
+	{
+		std::vector<int> count;
+		for (size_t k = 0; k < weight.size(); k++)
+			count.push_back(aggregate ? (int)types.jobs[k].size() : 1);
+		CutSettings cutSettings;
+		cutSettings.maxDepth = opts.cutDepth;
+		cutSettings.timeLimit = opts.cutTime;
+		separator.reset(new CutSeparator(weight, count, m, upperBound, cutSettings));
+		warm.cuts = separator.get();
+		solver->SetCutCallBack(CutSeparator::Callback, separator.get());
+	}
+
+	// solve the problem
+	solver->SetParameter(UFFLP_CutoffValue, (double)upperBound); // Cutoff value for the objective function
+	solver->SetParameter(UFFLP_TimeLimit, timeLeft); // Maximum number of seconds to run the B&B
+	solver->SetSolverParameter(SolverParam_RelativeGap, 1e-8);
+	solver->SetSolverParameter(SolverParam_StrongBranching, 1);
+	solver->SetSolverParameter(SolverParam_Threads, opts.threads);
+	PhaseTimer solveTimer(&result.stats, Phase_Solve);
+	UFFLP_StatusType status = solver->Solve();
+	solveTimer.Stop();
+
+	if (searchThread.joinable())
+	{
+		stopSearch = true;
+		searchThread.join();
+	}
+
+	PhaseTimer extractTimer(&result.stats, Phase_Extract);
+	double bound;
+	if (solver->GetBestBound(&bound) == UFFLP_Ok)
+		result.bestBound = fmax(result.bestBound, ceil(bound - 1e-6));
+
+	// read all the assignment columns at once, rounding away the tolerance
+	// of the backend
+	bool extracted = false;
+	double objective;
+	if ((status == UFFLP_Optimal || status == UFFLP_Feasible) &&
+		solver->GetObjValue(&objective) == UFFLP_Ok)
+	{
+		int width = aggregate ? ntypes : n;
+		std::vector<double> x(m * width);
+		extracted = solver->GetSolutions(1, m * width, &x[0]) == UFFLP_Ok;
+		if (extracted)
+			ScheduleOfColumns(warm, x, machineOf);
+	}
+
+	// stopped early with an incumbent: the local search may have a better one
+	if (extracted)
+	{
+		value = objective;
+		if (status == UFFLP_Feasible && warm.search != NULL &&
+			warm.search->Value() >= 0 && warm.search->Value() < value)
+			value = (double)warm.search->Best(machineOf);
+	}
+	// nothing below the cutoff: the heuristic schedule was already optimal
+	else if (status == UFFLP_Infeasible)
+	{
+		value = (double)upperBound;
+		status = UFFLP_Optimal;
+	}
+	// stopped early: keep the best schedule of the local search
+	else if (warm.search != NULL && warm.search->Value() >= 0 &&
+		warm.search->Value() < upperBound)
+	{
+		value = (double)warm.search->Best(machineOf);
+		status = UFFLP_Feasible;
+	}
+
+	result.nodes = solver->NodeCount();
+	if (separator)
+	{
+		result.cuts = separator->stats;
+		if (opts.verbose)
+			separator->PrintStats(stdout);
+	}
+
+	// destroy the problem instance
+	delete solver;
+
+	// the export only holds the run if it is still writing
+	extractTimer.Stop();
+	if (!opts.exportFormat.empty())
+	{
+		modelExport.Wait();
+		result.stats.wall[Phase_Write] += modelExport.Seconds();
+		result.stats.cpu[Phase_Write] += modelExport.CpuSeconds();
+	}
+	return status;
+}
+
+// Name of a portfolio member in the log
+static const char* MemberName(const std::vector<std::string>& members, int member)
+{
+	return member == PresolveMember ? "presolve" : members[member].c_str();
+}
+
+// Run the engines of opts.portfolio side by side, each on one thread. They
+// share the best schedule and the best bound, and all of them stop once a
+// member proves optimality, the shared schedule meets the shared bound or
+// the time limit is reached. The engines run with their own time limit and
+// stop on the shared flag; the DP member runs only when it is cheap, and a
+// UFFLP solve cannot be stopped early. The search of a checkpointed run, if
+// not NULL, is the one shared.
+static UFFLP_StatusType SolvePortfolio(const VantOptions& opts, int n, int m,
+	const int* proctime, const int* setup, const std::vector<int>& size,
+	long long lowerBound, long long upperBound, SolveResult& result,
+	SharedSearch* run)
+{
+	std::vector<std::string> members;
+	ParsePortfolio(opts.portfolio, members);
+	int count = (int)members.size();
+	double start = WallClock();
+
+	SharedSearch local(lowerBound);
+	SharedSearch& shared = run != NULL ? *run : local;
+	shared.Offer(PresolveMember, upperBound, result.machineOf);
+	std::atomic<int> winner(PresolveMember);
+
+	// the local search keeps its own schedule, merged into the shared one
+	// below with the credit of its member
+	std::vector<SharedSchedule> searches(count);
+	std::vector<SolveResult> sub(count);
+	auto runMember = [&](int k)
+	{
+		const std::string& name = members[k];
+		std::vector<int> machineOf = result.machineOf;
+		long long value = upperBound;
+		UFFLP_StatusType status = UFFLP_Aborted;
+
+		if (name == "mip")
+		{
+			sub[k].machineOf = machineOf;
+			sub[k].bestBound = (double)lowerBound;
+			sub[k].value = (double)upperBound;
+			status = SolveAssignmentModel(opts, n, m, proctime, setup, lowerBound,
+				upperBound, sub[k], NULL, &shared, k);
+			value = (long long)floor(sub[k].value + 0.5);
+			machineOf = sub[k].machineOf;
+			shared.RaiseBound(k, (long long)ceil(sub[k].bestBound - 1e-6));
+		}
+		else if (name == "arcflow" || name == "colgen" || name == "binpack" ||
+			name == "lagrange")
+		{
+			EngineSettings settings;
+			settings.solver = opts.solver.c_str();
+			settings.threads = 1;
+			settings.timeLimit = opts.timeLimit;
+			settings.log = NULL;
+			settings.stats = NULL;
+			settings.shared = &shared;
+			settings.member = k;
+			if (name == "arcflow")
+				status = SolveArcFlow(size, m, settings, lowerBound, value, machineOf);
+			else if (name == "colgen")
+				status = SolveColumnGeneration(size, m, settings, lowerBound, value,
+					machineOf);
+			else if (name == "binpack")
+				status = SolveByBinPacking(size, m, settings, lowerBound, value,
+					machineOf);
+			else
+			{
+				long long bound = lowerBound;
+				status = SolveLagrangian(size, m, settings, bound, value, machineOf);
+			}
+		}
+		else if (name == "ils")
+		{
+			LocalSearchSettings settings;
+			settings.threads = 1;
+			settings.timeLimit = opts.timeLimit;
+			settings.seed = opts.seed + k;
+			settings.lowerBound = lowerBound;
+			settings.stop = &shared.stop;
+			searches[k].Offer(value, machineOf);
+			value = IteratedLocalSearch(size, m, settings, searches[k]);
+			searches[k].Best(machineOf);
+			status = UFFLP_Feasible;
+		}
+		else if (m <= MaxDpMachines && DpIsCheap(size, m, value) &&
+			SolveByDP(size, m, lowerBound, value, machineOf))
+			status = UFFLP_Optimal;
+
+		if (status == UFFLP_Optimal || status == UFFLP_Feasible)
+			shared.Offer(k, value, machineOf);
+		if (status == UFFLP_Optimal)
+		{
+			shared.RaiseBound(k, value);
+			int none = PresolveMember;
+			winner.compare_exchange_strong(none, k);
+			shared.stop = true;
+		}
+	};
+	std::vector<std::thread> threads;
+	for (int k = 0; k < count; k++)
+		threads.push_back(std::thread(runMember, k));
+
+	// merge the local searches, and stop everything once the gap is closed
+	std::vector<int> schedule;
+	while (!shared.stop)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(5));
+		for (int k = 0; k < count; k++)
+		{
+			long long found = searches[k].Value();
+			if (found >= 0 && found < shared.incumbent.Value())
+				shared.Offer(k, searches[k].Best(schedule), schedule);
+		}
+		if (shared.Closed() || WallClock() - start >= opts.timeLimit)
+			shared.stop = true;
+	}
+	for (int k = 0; k < count; k++)
+		threads[k].join();
+
+	for (int k = 0; k < count; k++)
+		if (members[k] == "mip")
+		{
+			result.nodes = sub[k].nodes;
+			result.stats.rows = std::max(result.stats.rows, sub[k].stats.rows);
+			result.stats.cols = std::max(result.stats.cols, sub[k].stats.cols);
+			result.stats.nonzeros = std::max(result.stats.nonzeros,
+				sub[k].stats.nonzeros);
+		}
+
+	result.value = (double)shared.incumbent.Best(result.machineOf);
+	result.bestBound = fmax(result.bestBound, (double)shared.bound.load());
+	bool closed = shared.Closed();
+	if (winner != PresolveMember)
+		result.winner = members[winner];
+	else if (shared.incumbentBy == shared.boundBy)
+		result.winner = MemberName(members, shared.incumbentBy);
+	else
+		result.winner = std::string(MemberName(members, shared.incumbentBy)) + "+" +
+			MemberName(members, shared.boundBy);
+	if (opts.verbose)
+	{
+		if (winner != PresolveMember)
+			printf("Portfolio: %s proved optimality\n", result.winner.c_str());
+		else
+			printf("Portfolio: schedule from %s, bound from %s\n",
+				MemberName(members, shared.incumbentBy),
+				MemberName(members, shared.boundBy));
+	}
+	return closed ? UFFLP_Optimal : UFFLP_Feasible;
+}
+
+// Precedence arcs, windows and transitions: a list schedule, then the
+// time-indexed model unless the local search alone was asked for
+static void SolveSequencingInstance(const VantOptions& opts, int n,
+	const int* proctime, const int* setup, const JobRelations& relations,
+	SolveResult& result)
+{
+	SequencingProblem problem;
+	PhaseTimer presolveTimer(&result.stats, Phase_Presolve);
+	result.nodes = -1;
+	result.value = 0;
+	result.lowerBound = 0;
+	result.bestBound = 0;
+	if (!problem.Init(n, proctime, setup, relations))
+	{
+		printf("The precedence arcs form a cycle\n");
+		result.status = UFFLP_Infeasible;
+		return;
+	}
+	if (opts.verbose)
+		printf("\nPrecedence: %d arcs, %d after the transitive reduction\n",
+			problem.GivenArcs(), (int)problem.Arcs().size());
+	if (opts.checkpoint != NULL && opts.verbose)
+		printf("No checkpoint is kept with precedence, windows or transitions\n");
+	presolveTimer.Stop();
+
+	EngineSettings settings;
+	settings.solver = opts.solver.c_str();
+	settings.threads = opts.threads;
+	settings.timeLimit = opts.timeLimit;
+	settings.log = opts.verbose ? stdout : NULL;
+	settings.stats = &result.stats;
+	settings.shared = NULL;
+	settings.member = 0;
+	long long bound = 0, makespan = 0;
+	result.status = SolveSequencing(problem, opts.machines, settings,
+		opts.engine != "ils", bound, makespan, result.machineOf, result.start,
+		result.finish);
+	result.lowerBound = bound;
+	result.bestBound = (double)bound;
+	result.value = (double)makespan;
+	if (result.status == UFFLP_Optimal)
+		result.bestBound = result.value;
+}
+
+void SolveInstance(const VantOptions& opts, int n, const int* proctime,
+	const int* setup, SolveResult& result, ProgressTrace* trace,
+	const JobRelations* relations)
+{
+	int m = opts.machines;
+	if (relations != NULL && !relations->Empty())
+	{
+		SolveSequencingInstance(opts, n, proctime, setup, *relations, result);
+		return;
+	}
+	// without relations the order on a machine is free, and the assignment
+	// path with its presolve, DP and local search does better
+	if (opts.model == "timeindexed" && opts.verbose)
+		printf("No precedence, window or transition: using the assignment model\n");
+	PhaseTimer presolveTimer(&result.stats, Phase_Presolve);
+
+	// pre-solve: trivial lower bounds, then a schedule of this instance or
+	// of a close one solved before, then the best constructive schedule
+	std::vector<int> size;
+	MakespanBounds bounds;
+	JobSizes(n, proctime, setup, size);
+	ComputeMakespanBounds(size, m, bounds);
+	if (opts.verbose)
+		printf("\nLower bounds: max job %lld, average %lld, pair %lld\n",
+			bounds.maxJob, bounds.average, bounds.pair);
+
+	long long makespan = -1;
+	CachedSolution cached;
+	if (!opts.cache.empty() && LookupCache(opts.cache, size, m, cached))
+	{
+		if (opts.verbose)
+			printf("Cached %s: makespan %lld, bound %lld\n",
+				cached.exact ? "schedule" : "schedule without one job",
+				cached.makespan, cached.bound);
+		makespan = cached.makespan;
+		result.machineOf = cached.machineOf;
+		bounds.lower = std::max(bounds.lower, cached.bound);
+	}
+
+	// the heuristics only replace a cached schedule they improve on, and are
+	// not needed once it meets the bound
+	if (makespan < 0 || makespan > bounds.lower)
+	{
+		std::vector<int> lpt, multifit;
+		long long lptMakespan = LptSchedule(size, m, lpt);
+		long long multifitMakespan = MultifitSchedule(size, m, multifit);
+		if (opts.verbose)
+			printf("Heuristics: LPT %lld, MULTIFIT %lld\n", lptMakespan, multifitMakespan);
+		if (multifitMakespan < lptMakespan)
+		{
+			lptMakespan = multifitMakespan;
+			lpt = multifit;
+		}
+		if (makespan < 0 || lptMakespan < makespan)
+		{
+			makespan = lptMakespan;
+			result.machineOf = lpt;
+		}
+	}
+
+	// the schedule and the bound of an earlier run stopped on this instance
+	CheckpointState resumed;
+	resumed.seconds = 0;
+	if (opts.checkpoint != NULL && ReadCheckpoint(opts.checkpoint, size, m, resumed))
+	{
+		if (opts.verbose)
+			printf("Resumed from %s: makespan %lld, bound %lld after %.0f s\n",
+				opts.checkpoint, resumed.makespan, resumed.bound, resumed.seconds);
+		if (resumed.makespan < makespan)
+		{
+			makespan = resumed.makespan;
+			result.machineOf = resumed.machineOf;
+		}
+		bounds.lower = std::max(bounds.lower, resumed.bound);
+	}
+
+	// every engine below publishes to the search of a checkpointed run and
+	// stops on its flag
+	std::unique_ptr<SharedSearch> run;
+	std::unique_ptr<CheckpointWriter> checkpoint;
+	if (opts.checkpoint != NULL)
+	{
+		run.reset(new SharedSearch(bounds.lower));
+		run->Offer(PresolveMember, makespan, result.machineOf);
+		checkpoint.reset(new CheckpointWriter(opts.checkpoint, opts.checkpointInterval,
+			size, m, resumed.seconds, *run));
+	}
+	result.lowerBound = bounds.lower;
+	result.bestBound = (double)bounds.lower;
+	result.value = (double)makespan;
+	result.nodes = -1;
+	result.status = UFFLP_Feasible;
+
+	if (makespan <= bounds.lower)
+	{
+		if (opts.verbose)
+			printf("The starting schedule meets the lower bound, skipping the MIP\n");
+		result.status = UFFLP_Optimal;
+	}
+	else if ((opts.engine == "auto" || opts.engine == "dp") && m <= MaxDpMachines &&
+		(opts.engine == "dp" || DpIsCheap(size, m, makespan)) &&
+		SolveByDP(size, m, bounds.lower, makespan, result.machineOf))
+	{
+		if (opts.verbose)
+			printf("Solved by the exact DP engine\n");
+		result.value = (double)makespan;
+		result.status = UFFLP_Optimal;
+	}
+	else if (opts.engine == "ils" || (opts.engine != "portfolio" && opts.searchTime > 0))
+	{
+		// a short local search improves the starting schedule
+		SharedSchedule local;
+		SharedSchedule& best = run ? run->incumbent : local;
+		LocalSearchSettings settings;
+		settings.threads = opts.threads;
+		settings.timeLimit = opts.searchTime;
+		settings.seed = opts.seed;
+		settings.lowerBound = bounds.lower;
+		settings.stop = run ? &run->stop : NULL;
+		best.Offer(makespan, result.machineOf);
+		makespan = IteratedLocalSearch(size, m, settings, best);
+		best.Best(result.machineOf);
+		result.value = (double)makespan;
+		if (opts.verbose)
+			printf("Local search: %lld\n", makespan);
+	}
+
+	if (result.status != UFFLP_Optimal && makespan <= bounds.lower)
+	{
+		if (opts.verbose)
+			printf("The local search meets the lower bound, skipping the MIP\n");
+		result.status = UFFLP_Optimal;
+	}
+	else if (result.status != UFFLP_Optimal && opts.lagrangeTime > 0 &&
+		opts.engine != "lagrange" && opts.engine != "portfolio")
+	{
+		// the Lagrangian bound and its schedules tighten the range of the MIP
+		EngineSettings settings;
+		settings.solver = opts.solver.c_str();
+		settings.threads = opts.threads;
+		settings.timeLimit = opts.lagrangeTime;
+		settings.log = opts.verbose ? stdout : NULL;
+		settings.stats = NULL;
+		settings.shared = run.get();
+		settings.member = 0;
+		result.status = SolveLagrangian(size, m, settings, bounds.lower, makespan,
+			result.machineOf);
+		result.lowerBound = bounds.lower;
+		result.bestBound = (double)bounds.lower;
+		result.value = (double)makespan;
+		if (result.status == UFFLP_Optimal && opts.verbose)
+			printf("The Lagrangian bound meets the schedule, skipping the MIP\n");
+	}
+	presolveTimer.Stop();
+
+	if (result.status != UFFLP_Optimal)
+	{
+		if (opts.engine == "ils")
+			result.status = UFFLP_Feasible;
+		else if (opts.engine == "binpack" || opts.engine == "lagrange")
+		{
+			EngineSettings settings;
+			settings.solver = opts.solver.c_str();
+			settings.threads = opts.threads;
+			settings.timeLimit = opts.timeLimit;
+			settings.log = opts.verbose ? stdout : NULL;
+			settings.stats = &result.stats;
+			settings.shared = run.get();
+			settings.member = 0;
+			if (opts.engine == "binpack")
+				result.status = SolveByBinPacking(size, m, settings, bounds.lower,
+					makespan, result.machineOf);
+			else
+			{
+				result.status = SolveLagrangian(size, m, settings, bounds.lower,
+					makespan, result.machineOf);
+				result.lowerBound = bounds.lower;
+				result.bestBound = (double)bounds.lower;
+			}
+			result.value = (double)makespan;
+		}
+		else if (opts.engine == "portfolio")
+		{
+			PhaseTimer solveTimer(&result.stats, Phase_Solve);
+			result.status = SolvePortfolio(opts, n, m, proctime, setup, size,
+				bounds.lower, makespan, result, run.get());
+		}
+		else if (opts.model == "arcflow" || opts.model == "colgen")
+		{
+			EngineSettings settings;
+			settings.solver = opts.solver.c_str();
+			settings.threads = opts.threads;
+			settings.timeLimit = opts.timeLimit;
+			settings.log = opts.verbose ? stdout : NULL;
+			settings.stats = &result.stats;
+			settings.shared = run.get();
+			settings.member = 0;
+			if (opts.model == "arcflow")
+				result.status = SolveArcFlow(size, m, settings, bounds.lower, makespan,
+					result.machineOf);
+			else
+				result.status = SolveColumnGeneration(size, m, settings, bounds.lower,
+					makespan, result.machineOf);
+			result.value = (double)makespan;
+		}
+		else
+			result.status = SolveAssignmentModel(opts, n, m, proctime, setup,
+				bounds.lower, makespan, result, trace, NULL, 0, run.get());
+	}
+
+	// stopped early without a schedule of the engine: the starting one stands
+	if (result.status == UFFLP_Aborted && (int)result.machineOf.size() == n)
+		result.status = UFFLP_Feasible;
+
+	// an engine may stop before it returns what it published
+	if (run)
+	{
+		long long published = run->incumbent.Value();
+		if (published >= 0 && published < (long long)floor(result.value + 0.5))
+			result.value = (double)run->incumbent.Best(result.machineOf);
+		result.bestBound = fmax(result.bestBound, (double)run->bound.load());
+		if (result.status == UFFLP_Feasible && result.bestBound >= result.value)
+			result.status = UFFLP_Optimal;
+		run->Offer(PresolveMember, (long long)floor(result.value + 0.5),
+			result.machineOf);
+		run->RaiseBound(PresolveMember, (long long)ceil(result.bestBound - 1e-6));
+		bool written = checkpoint->Finish();
+		if (opts.verbose || !written)
+			printf("%s the checkpoint %s\n", written ? "Wrote" : "Could not write",
+				opts.checkpoint);
+	}
+
+	if (result.status == UFFLP_Optimal)
+		result.bestBound = result.value;
+
+	if (!opts.cache.empty() && (result.status == UFFLP_Optimal ||
+		result.status == UFFLP_Feasible) && !StoreCache(opts.cache, size, m,
+		(long long)result.value, (long long)ceil(result.bestBound - 1e-6),
+		result.machineOf) && opts.verbose)
+		printf("Could not write to the cache %s\n", opts.cache.c_str());
+}
+
+const char* StatusName(UFFLP_StatusType status)
+{
+	switch (status)
+	{
+	case UFFLP_Optimal:
+		return "optimal";
+	case UFFLP_Infeasible:
+		return "infeasible";
+	case UFFLP_Aborted:
+		return "aborted";
+	case UFFLP_Feasible:
+		return "feasible";
+	case UFFLP_InternalError:
+		return "error";
+	}
+	return "unknown";
+}
@@ -0,0 +1,51 @@
+/****************************************************************************
+* Solving one instance of the UAV makespan problem
+*
+* The pre-solve stage computes the combinatorial lower bounds and the best
+* constructive schedule. The exact DP engine closes the gap when it is cheap
+* enough for the number of machines and the job sizes, and the formulation
+* selected in the options otherwise. Shared by the single run in main() and
+* the batch workers.
+*
+*****************************************************************************/
+
+#ifndef __SOLVE_H__
+#define __SOLVE_H__
+
+#include "UFFLP.h"
+#include "cuts.h"
+#include "instance.h"
+#include "options.h"
+#include "runstats.h"
+
+#include <vector>
+
+struct SolveResult
+{
+	UFFLP_StatusType status;
+	double value;               // makespan of the schedule
+	long long lowerBound;       // combinatorial lower bound
+	double bestBound;           // best proven bound, at least lowerBound
+	long nodes;                 // nodes of the MIP, -1 if unknown or not run
+	std::vector<int> machineOf; // machine of every job
+	std::string winner;         // portfolio member that closed the gap, or
+	                            // "schedule+bound" members, empty outside one
+	RunStats stats;             // the caller times Phase_Read and the totals
+	CutStats cuts;              // separation in the assignment model
+	std::vector<long long> start, finish;   // of every job with relations or
+	                                        // the time-indexed model, empty
+	                                        // when jobs run back to back
+};
+
+// Solve an instance with opts.machines machines. The progress trace, if
+// not NULL, gets records from the callbacks of the assignment model. With
+// precedence arcs, windows or transitions in the relations, or with the
+// time-indexed model, the sequencing engine solves it.
+void SolveInstance(const VantOptions& opts, int n, const int* proctime,
+	const int* setup, SolveResult& result, ProgressTrace* trace = NULL,
+	const JobRelations* relations = NULL);
+
+// Printable name of a solver status
+const char* StatusName(UFFLP_StatusType status);
+
+#endif
@@ -0,0 +1,28 @@
+#include "solver.h"
+
+#include <string.h>
+
+SolverBackend* CreateNativeSolver();
+#ifdef VANT_WITH_UFFLP
+SolverBackend* CreateUfflpSolver();
+#endif
+
+SolverBackend* CreateSolver(const char* name)
+{
+	if (strcmp(name, "native") == 0)
+		return CreateNativeSolver();
+#ifdef VANT_WITH_UFFLP
+	if (strcmp(name, "ufflp") == 0)
+		return CreateUfflpSolver();
+#endif
+	return NULL;
+}
+
+const char* DefaultSolverName()
+{
+#ifdef VANT_WITH_UFFLP
+	return "ufflp";
+#else
+	return "native";
+#endif
+}
@@ -0,0 +1,149 @@
+/****************************************************************************
+* SolverBackend - solver-independent counterpart of the UFFLP_* API
+*
+* Mirrors the UFFLP surface (problem setup, solve, solution queries and the
+* cut and heuristic callbacks) but addresses variables and constraints by
+* their index in the ModelBuilder the problem was loaded from. Backends:
+*
+*   native  in-process branch-and-bound over a bounded dual simplex
+*   ufflp   UFFLP3/CPLEX, available when built with VANT_WITH_UFFLP
+*
+*****************************************************************************/
+
+#ifndef __SOLVER_H__
+#define __SOLVER_H__
+
+#include "UFFLP.h"
+
+#include <atomic>
+#include <stdio.h>
+
+class ModelBuilder;
+class SolverBackend;
+struct RunStats;
+struct SharedSearch;
+
+// Callback invoked by the solver during the branch-and-bound
+typedef void (*SolverCallback)(SolverBackend* solver, void* data);
+
+// Solver settings that used to be raw CPLEX parameters
+enum SolverParameter
+{
+	SolverParam_Threads,         // number of threads used by the solver
+	SolverParam_RelativeGap,     // relative MIP gap tolerance
+	SolverParam_StrongBranching  // nonzero to select variables by strong branching
+};
+
+// Settings of the engines that solve a sequence of models with a backend
+struct EngineSettings
+{
+	const char* solver;     // backend name, as accepted by CreateSolver
+	int threads;            // threads of every solve
+	double timeLimit;       // overall limit in seconds
+	FILE* log;              // progress of the engine, NULL for none
+	RunStats* stats;        // phase times and model sizes, NULL for none
+	SharedSearch* shared;   // portfolio the engine belongs to, NULL for none:
+	int member;             // bounds and schedules are published as this
+	                        // member and the engine stops with the portfolio
+};
+
+class SolverBackend
+{
+public:
+	virtual ~SolverBackend() {}
+
+	// Name of the backend, as accepted by CreateSolver
+	virtual const char* Name() const = 0;
+
+	// Load the variables and constraints of a model. Must be called once,
+	// before any other operation.
+	virtual UFFLP_ErrorType LoadModel(const ModelBuilder& model) = 0;
+
+	// Insert a constraint. Inside a cut callback it is inserted as a cut.
+	virtual UFFLP_ErrorType AddConstraint(int len, const int* cols,
+		const double* vals, double rhs, UFFLP_ConsType type) = 0;
+
+	// Insert a variable with its coefficients in existing constraints, as in
+	// column generation. Not allowed inside a callback. The new variable
+	// takes the next column index.
+	virtual UFFLP_ErrorType AddColumn(double lb, double ub, double obj,
+		UFFLP_VarType type, int len, const int* rows, const double* vals) = 0;
+
+	virtual UFFLP_StatusType Solve() = 0;
+
+	// Objective value of the best solution, or of the current LP relaxation
+	// inside a callback.
+	virtual UFFLP_ErrorType GetObjValue(double* value) = 0;
+
+	// Value of a variable in the best solution, or in the current LP
+	// relaxation inside a callback.
+	virtual UFFLP_ErrorType GetSolution(int col, double* value) = 0;
+
+	// Values of the variables first .. first + count - 1 in one call, as
+	// GetSolution.
+	virtual UFFLP_ErrorType GetSolutions(int first, int count,
+		double* values) = 0;
+
+	// Dual value of a constraint, the change of the objective per unit of
+	// its right-hand side: non-negative for a >= row of a minimization.
+	// Only available for continuous problems.
+	virtual UFFLP_ErrorType GetDualSolution(int row, double* value) = 0;
+
+	// Log file name ("" for the standard output) and level of information
+	virtual UFFLP_ErrorType SetLogInfo(const char* fname, int level) = 0;
+
+	virtual UFFLP_ErrorType SetParameter(UFFLP_ParameterType param,
+		double value) = 0;
+	virtual UFFLP_ErrorType SetSolverParameter(SolverParameter param,
+		double value) = 0;
+
+	virtual UFFLP_ErrorType SetCutCallBack(SolverCallback func,
+		void* data) = 0;
+	virtual UFFLP_ErrorType SetHeurCallBack(SolverCallback func,
+		void* data) = 0;
+
+	// Message to the log file (only allowed in a callback)
+	virtual UFFLP_ErrorType PrintToLog(const char* message) = 0;
+
+	// Value of the best integer solution (only allowed in a heuristic
+	// callback)
+	virtual UFFLP_ErrorType GetBestSolutionValue(double* value) = 0;
+
+	// Value of a variable in the solution provided by a heuristic callback.
+	// Non-provided values are considered as zeroes.
+	virtual UFFLP_ErrorType SetSolution(int col, double value) = 0;
+
+	// Depth of the current node (only allowed in a callback)
+	virtual UFFLP_ErrorType GetNodeDepth(int* value) = 0;
+
+	// Branch-and-bound nodes explored by the last Solve, or -1 if the
+	// backend does not report them
+	virtual long NodeCount() const = 0;
+
+	// Best bound of the last Solve, or of the search so far inside a
+	// callback. UFFLP does not report it (UFFLP_NoSolExists).
+	virtual UFFLP_ErrorType GetBestBound(double* value) = 0;
+
+	// Branching priority of a variable; higher priorities are preferred
+	virtual UFFLP_ErrorType SetPriority(int col, int prior) = 0;
+
+	// Abandon the current and later solves once *flag is set, as if the time
+	// limit was reached. UFFLP cannot stop a solve from outside and returns
+	// UFFLP_InvalidParameter: its solves only end at their time limit.
+	virtual UFFLP_ErrorType SetStopFlag(const std::atomic<bool>* flag) = 0;
+
+	// Changes to the model between two calls to Solve
+	virtual UFFLP_ErrorType ChangeBounds(int col, double lb, double ub) = 0;
+	virtual UFFLP_ErrorType ChangeObjCoeff(int col, double value) = 0;
+	virtual UFFLP_ErrorType ChangeVariableType(int col,
+		UFFLP_VarType type) = 0;
+};
+
+// Create a backend by name ("native" or "ufflp").
+// @return NULL if the backend is unknown or not compiled in
+SolverBackend* CreateSolver(const char* name);
+
+// Backend used when none is requested: UFFLP if available, native otherwise
+const char* DefaultSolverName();
+
+#endif
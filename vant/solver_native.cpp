@@ -0,0 +1,732 @@
+#include "solver.h"
+#include "simplex.h"
+#include "modelbuilder.h"
+#include "sysutil.h"
+
+#include <math.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <queue>
+#include <vector>
+
+static const double IntTol = 1e-6;
+static const double FeasTol = 1e-6;
+
+// Rounds of cut separation per node
+static const int MaxCutRounds = 20;
+
+// Iterations per call to the LP between two time limit checks
+static const long IterChunk = 200;
+
+// Branch-and-bound over the bounded dual simplex. Nodes are explored in
+// best-bound order; after branching, the child in the rounding direction is
+// processed right away (plunging), reusing the basis of its parent, and the
+// other child goes to the queue.
+class NativeSolver : public SolverBackend
+{
+public:
+	NativeSolver();
+	~NativeSolver();
+
+	const char* Name() const { return "native"; }
+
+	UFFLP_ErrorType LoadModel(const ModelBuilder& model);
+	UFFLP_ErrorType AddConstraint(int len, const int* cols,
+		const double* vals, double rhs, UFFLP_ConsType type);
+	UFFLP_ErrorType AddColumn(double lb, double ub, double obj,
+		UFFLP_VarType type, int len, const int* rows, const double* vals);
+	UFFLP_StatusType Solve();
+	UFFLP_ErrorType GetObjValue(double* value);
+	UFFLP_ErrorType GetSolution(int col, double* value);
+	UFFLP_ErrorType GetSolutions(int first, int count, double* values);
+	UFFLP_ErrorType GetDualSolution(int row, double* value);
+	UFFLP_ErrorType SetLogInfo(const char* fname, int level);
+	UFFLP_ErrorType SetParameter(UFFLP_ParameterType param, double value);
+	UFFLP_ErrorType SetSolverParameter(SolverParameter param, double value);
+	UFFLP_ErrorType SetCutCallBack(SolverCallback func, void* data);
+	UFFLP_ErrorType SetHeurCallBack(SolverCallback func, void* data);
+	UFFLP_ErrorType PrintToLog(const char* message);
+	UFFLP_ErrorType GetBestSolutionValue(double* value);
+	UFFLP_ErrorType SetSolution(int col, double value);
+	UFFLP_ErrorType GetNodeDepth(int* value);
+	long NodeCount() const { return nodes; }
+	UFFLP_ErrorType GetBestBound(double* value);
+	UFFLP_ErrorType SetPriority(int col, int prior);
+	UFFLP_ErrorType SetStopFlag(const std::atomic<bool>* flag)
+	{
+		stopFlag = flag;
+		return UFFLP_Ok;
+	}
+	UFFLP_ErrorType ChangeBounds(int col, double lb, double ub);
+	UFFLP_ErrorType ChangeObjCoeff(int col, double value);
+	UFFLP_ErrorType ChangeVariableType(int col, UFFLP_VarType type);
+
+private:
+	struct BoundChange
+	{
+		int col;
+		double lb, ub;
+	};
+
+	struct Node
+	{
+		double bound;   // LP bound of the parent, minimization form
+		int depth;
+		std::vector<BoundChange> changes;
+
+		bool operator<(const Node& other) const { return bound > other.bound; }
+	};
+
+	enum NodeResult { NodePruned, NodeIntegral, NodeBranch, NodeAborted };
+
+	void ApplyChanges(const std::vector<BoundChange>& changes);
+	NodeResult SolveNode(int depth, double& bound);
+	int SelectBranchVar() const;
+	double PruneLevel() const;
+	bool TryIncumbent(const double* sol);
+	bool TimeUp() const;
+	void Log(const char* fmt, ...);
+
+	DualSimplex lp;
+	int ncols;
+	bool maximize;
+	bool loaded;
+	bool objIntegral;   // integral solutions have integral objective values
+	std::vector<double> obj, rootLb, rootUb;
+	std::vector<UFFLP_VarType> type;
+	std::vector<int> priority;
+	std::vector<int> applied;   // columns whose bounds differ from the root
+
+	std::vector<double> incumbent;
+	double incumbentObj;        // minimization form
+	bool hasIncumbent;
+
+	// callbacks
+	SolverCallback cutFunc, heurFunc;
+	void *cutData, *heurData;
+	bool inCut, inHeuristic;
+	int curDepth;
+	std::vector<double> heurSol;
+	bool heurProvided;
+	int cutsAdded;
+
+	// parameters
+	double cutoff, timeLimit, relGap;
+	long nodesLimit;
+	const std::atomic<bool>* stopFlag;
+
+	double startTime;
+	long nodes;
+	double bestBound;           // minimization form, -1e300 while unknown
+	std::vector<double> duals;
+	bool hasDuals;
+
+	FILE* logFile;
+	int logLevel;
+};
+
+NativeSolver::NativeSolver() : ncols(0), maximize(false), loaded(false),
+	objIntegral(false), incumbentObj(0), hasIncumbent(false), cutFunc(NULL),
+	heurFunc(NULL), cutData(NULL), heurData(NULL), inCut(false),
+	inHeuristic(false), curDepth(0), heurProvided(false), cutsAdded(0),
+	cutoff(UFFLP_Infinity), timeLimit(UFFLP_Infinity), relGap(1e-4),
+	nodesLimit(-1), stopFlag(NULL), startTime(0), nodes(0), bestBound(-1e300), hasDuals(false), logFile(stdout),
+	logLevel(0)
+{
+}
+
+NativeSolver::~NativeSolver()
+{
+	if (logFile != stdout && logFile != NULL)
+		fclose(logFile);
+}
+
+UFFLP_ErrorType NativeSolver::LoadModel(const ModelBuilder& model)
+{
+	for (int j = 0; j < model.NumVariables(); j++)
+		if (model.type[j] == UFFLP_SemiContinuous)
+			return UFFLP_UnknownVarType;
+
+	lp.Load(model);
+	ncols = model.NumVariables();
+	maximize = model.sense == UFFLP_Maximize;
+	obj = model.obj;
+	rootLb = model.lb;
+	rootUb = model.ub;
+	type = model.type;
+	priority.assign(ncols, 0);
+	loaded = true;
+	return UFFLP_Ok;
+}
+
+UFFLP_ErrorType NativeSolver::AddConstraint(int len, const int* cols,
+	const double* vals, double rhs, UFFLP_ConsType type)
+{
+	if (inHeuristic)
+		return UFFLP_InNonCutCallback;
+
+	lp.AddRow(len, cols, vals, type == UFFLP_Less ? -UFFLP_Infinity : rhs,
+		type == UFFLP_Greater ? UFFLP_Infinity : rhs);
+	if (inCut)
+		cutsAdded++;
+	return UFFLP_Ok;
+}
+
+UFFLP_ErrorType NativeSolver::AddColumn(double lb, double ub, double value,
+	UFFLP_VarType vtype, int len, const int* rows, const double* vals)
+{
+	if (inCut || inHeuristic)
+		return UFFLP_InCallback;
+	if (vtype == UFFLP_SemiContinuous)
+		return UFFLP_UnknownVarType;
+	for (int k = 0; k < len; k++)
+		if (rows[k] < 0 || rows[k] >= lp.NumRows())
+			return UFFLP_ConsNameNotFound;
+
+	lp.AddColumn(lb, ub, value, len, rows, vals);
+	obj.push_back(value);
+	rootLb.push_back(lb);
+	rootUb.push_back(ub);
+	type.push_back(vtype);
+	priority.push_back(0);
+	if (hasIncumbent)
+		incumbent.push_back(0.0);
+	ncols++;
+	return UFFLP_Ok;
+}
+
+void NativeSolver::Log(const char* fmt, ...)
+{
+	if (logLevel <= 0 || logFile == NULL)
+		return;
+
+	va_list args;
+	va_start(args, fmt);
+	vfprintf(logFile, fmt, args);
+	va_end(args);
+	fflush(logFile);
+}
+
+bool NativeSolver::TimeUp() const
+{
+	if (stopFlag != NULL && stopFlag->load())
+		return true;
+	return timeLimit < UFFLP_Infinity && WallClock() - startTime > timeLimit;
+}
+
+// Nodes whose bound exceeds this level cannot lead to a better solution
+double NativeSolver::PruneLevel() const
+{
+	double level = 1e300;
+
+	if (hasIncumbent)
+	{
+		if (objIntegral)
+			level = incumbentObj - 1.0 + IntTol;
+		else
+			level = incumbentObj - fmax(1e-9, relGap * fabs(incumbentObj));
+	}
+	if (cutoff < UFFLP_Infinity)
+	{
+		double c = maximize ? -cutoff : cutoff;
+		level = fmin(level, c + 1e-9);
+	}
+	return level;
+}
+
+// Accept a solution as the new incumbent if it is feasible and improves
+bool NativeSolver::TryIncumbent(const double* sol)
+{
+	double value = 0.0;
+
+	for (int j = 0; j < ncols; j++)
+	{
+		if (sol[j] < rootLb[j] - FeasTol || sol[j] > rootUb[j] + FeasTol)
+			return false;
+		if (type[j] != UFFLP_Continuous && fabs(sol[j] - floor(sol[j] + 0.5)) > IntTol)
+			return false;
+		value += obj[j] * sol[j];
+	}
+	if (lp.RowViolation(sol) > FeasTol)
+		return false;
+
+	if (maximize)
+		value = -value;
+	if (hasIncumbent && value >= incumbentObj - 1e-9)
+		return false;
+	if (cutoff < UFFLP_Infinity && value > (maximize ? -cutoff : cutoff) + 1e-9)
+		return false;
+
+	incumbent.assign(sol, sol + ncols);
+	for (int j = 0; j < ncols; j++)
+		if (type[j] != UFFLP_Continuous)
+			incumbent[j] = floor(incumbent[j] + 0.5);
+	incumbentObj = value;
+	hasIncumbent = true;
+	Log("Node %8ld: new incumbent %.10g\n", nodes,
+		maximize ? -incumbentObj : incumbentObj);
+	return true;
+}
+
+void NativeSolver::ApplyChanges(const std::vector<BoundChange>& changes)
+{
+	for (size_t k = 0; k < applied.size(); k++)
+		lp.SetBounds(applied[k], rootLb[applied[k]], rootUb[applied[k]]);
+	applied.clear();
+
+	for (size_t k = 0; k < changes.size(); k++)
+	{
+		const BoundChange& c = changes[k];
+		lp.SetBounds(c.col, c.lb, c.ub);
+		applied.push_back(c.col);
+	}
+}
+
+// Most fractional variable among those of the highest priority
+int NativeSolver::SelectBranchVar() const
+{
+	const double* x = lp.Primal();
+	int best = -1;
+	double bestScore = 0.0;
+
+	for (int j = 0; j < ncols; j++)
+	{
+		if (type[j] == UFFLP_Continuous)
+			continue;
+		double f = x[j] - floor(x[j]);
+		if (f < IntTol || f > 1.0 - IntTol)
+			continue;
+		double score = f < 0.5 ? f : 1.0 - f;
+		if (best < 0 || priority[j] > priority[best]
+			|| (priority[j] == priority[best] && score > bestScore))
+		{
+			best = j;
+			bestScore = score;
+		}
+	}
+	return best;
+}
+
+NativeSolver::NodeResult NativeSolver::SolveNode(int depth, double& bound)
+{
+	for (int round = 0; ; round++)
+	{
+		DualSimplex::Status st;
+		do {
+			if (TimeUp())
+				return NodeAborted;
+			st = lp.Solve(PruneLevel(), IterChunk);
+		} while (st == DualSimplex::IterationLimit);
+
+		if (st != DualSimplex::Optimal)
+			return NodePruned;
+
+		bound = maximize ? -lp.ObjValue() : lp.ObjValue();
+		if (objIntegral)
+			bound = ceil(bound - IntTol);
+		if (bound > PruneLevel())
+			return NodePruned;
+
+		if (cutFunc == NULL || round >= MaxCutRounds)
+			break;
+
+		// separate cuts until the callback finds none
+		inCut = true;
+		curDepth = depth;
+		cutsAdded = 0;
+		cutFunc(this, cutData);
+		inCut = false;
+		if (cutsAdded == 0)
+			break;
+	}
+
+	if (heurFunc != NULL)
+	{
+		inHeuristic = true;
+		curDepth = depth;
+		heurProvided = false;
+		heurSol.assign(ncols, 0.0);
+		heurFunc(this, heurData);
+		inHeuristic = false;
+		if (heurProvided)
+			TryIncumbent(&heurSol[0]);
+		if (bound > PruneLevel())
+			return NodePruned;
+	}
+
+	if (SelectBranchVar() < 0)
+	{
+		TryIncumbent(lp.Primal());
+		return NodeIntegral;
+	}
+	return NodeBranch;
+}
+
+UFFLP_StatusType NativeSolver::Solve()
+{
+	if (!loaded)
+		return UFFLP_InternalError;
+
+	startTime = WallClock();
+	nodes = 0;
+	hasDuals = false;
+
+	bool integer = false;
+	objIntegral = true;
+	for (int j = 0; j < ncols; j++)
+	{
+		if (type[j] != UFFLP_Continuous)
+			integer = true;
+		if (obj[j] != 0.0 && (type[j] == UFFLP_Continuous || obj[j] != floor(obj[j])))
+			objIntegral = false;
+	}
+
+	// keep a previous incumbent only if it survived the model changes; a
+	// pure LP is solved afresh, since an incumbent would prune its optimum
+	// within the relative gap
+	if (!integer)
+		hasIncumbent = false;
+	else if (hasIncumbent)
+	{
+		std::vector<double> prev(incumbent);
+		hasIncumbent = false;
+		TryIncumbent(&prev[0]);
+	}
+
+	std::priority_queue<Node> open;
+	Node root;
+	root.bound = -1e300;
+	root.depth = 0;
+	open.push(root);
+
+	bool aborted = false;
+	bestBound = -1e300;
+
+	while (!open.empty())
+	{
+		if (TimeUp() || (nodesLimit >= 0 && nodes >= nodesLimit))
+		{
+			aborted = true;
+			break;
+		}
+
+		Node node = open.top();
+		open.pop();
+		if (node.bound > PruneLevel())
+			continue;
+
+		// plunge from the selected node
+		for (;;)
+		{
+			ApplyChanges(node.changes);
+			nodes++;
+
+			double bound;
+			NodeResult res = SolveNode(node.depth, bound);
+			if (res == NodeAborted)
+			{
+				open.push(node);
+				aborted = true;
+				break;
+			}
+			if (res != NodeBranch)
+				break;
+
+			int col = SelectBranchVar();
+			double v = lp.Primal()[col];
+
+			Node down, up;
+			down.bound = up.bound = bound;
+			down.depth = up.depth = node.depth + 1;
+			down.changes = node.changes;
+			up.changes = node.changes;
+
+			BoundChange c;
+			c.col = col;
+			c.lb = lp.Lower(col);
+			c.ub = floor(v);
+			down.changes.push_back(c);
+			c.lb = ceil(v);
+			c.ub = lp.Upper(col);
+			up.changes.push_back(c);
+
+			bool goUp = v - floor(v) >= 0.5;
+			Node& next = goUp ? up : down;
+			open.push(goUp ? down : up);
+
+			// keep plunging while the child is still a best-bound node
+			if (hasIncumbent && !open.empty() && open.top().bound < bound)
+			{
+				open.push(next);
+				break;
+			}
+			node = next;
+		}
+
+		if (logLevel > 1 && nodes % 1000 == 0)
+			Log("Node %8ld: open %8ld, best bound %.10g\n", nodes,
+				(long)open.size(), open.empty() ? 0.0 : open.top().bound);
+
+		// global bound and gap
+		if (open.empty())
+			break;
+		bestBound = open.top().bound;
+		if (hasIncumbent)
+		{
+			double gap = (incumbentObj - bestBound) / fmax(1e-10, fabs(incumbentObj));
+			if (gap <= relGap || bestBound > PruneLevel())
+				break;
+		}
+	}
+
+	if (!integer && hasIncumbent)
+	{
+		lp.Duals(duals);
+		hasDuals = true;
+	}
+
+	// restore the root bounds for later calls
+	ApplyChanges(std::vector<BoundChange>());
+
+	Log("Explored %ld nodes in %.2f s (%ld simplex iterations)\n", nodes,
+		WallClock() - startTime, lp.Iterations());
+
+	if (aborted)
+	{
+		if (!open.empty())
+			bestBound = open.top().bound;
+		if (hasIncumbent)
+			bestBound = fmin(bestBound, incumbentObj);
+		return hasIncumbent ? UFFLP_Feasible : UFFLP_Aborted;
+	}
+	bestBound = hasIncumbent ? incumbentObj : UFFLP_Infinity;
+	return hasIncumbent ? UFFLP_Optimal : UFFLP_Infeasible;
+}
+
+UFFLP_ErrorType NativeSolver::GetObjValue(double* value)
+{
+	if (inCut || inHeuristic)
+	{
+		*value = lp.ObjValue();
+		return UFFLP_Ok;
+	}
+	if (!hasIncumbent)
+		return UFFLP_NoSolExists;
+	*value = maximize ? -incumbentObj : incumbentObj;
+	return UFFLP_Ok;
+}
+
+UFFLP_ErrorType NativeSolver::GetBestBound(double* value)
+{
+	if (bestBound <= -1e300)
+		return UFFLP_NoSolExists;
+	*value = maximize ? -bestBound : bestBound;
+	return UFFLP_Ok;
+}
+
+UFFLP_ErrorType NativeSolver::GetSolution(int col, double* value)
+{
+	if (col < 0 || col >= ncols)
+		return UFFLP_VarNameNotFound;
+	if (inCut || inHeuristic)
+	{
+		*value = lp.Primal()[col];
+		return UFFLP_Ok;
+	}
+	if (!hasIncumbent)
+		return UFFLP_NoSolExists;
+	*value = incumbent[col];
+	return UFFLP_Ok;
+}
+
+UFFLP_ErrorType NativeSolver::GetSolutions(int first, int count,
+	double* values)
+{
+	if (first < 0 || count < 0 || first + count > ncols)
+		return UFFLP_VarNameNotFound;
+	const double* x;
+	if (inCut || inHeuristic)
+		x = lp.Primal();
+	else if (hasIncumbent)
+		x = &incumbent[0];
+	else
+		return UFFLP_NoSolExists;
+	std::copy(x + first, x + first + count, values);
+	return UFFLP_Ok;
+}
+
+UFFLP_ErrorType NativeSolver::GetDualSolution(int row, double* value)
+{
+	if (inCut || inHeuristic)
+		return UFFLP_InCallback;
+	if (!hasDuals)
+		return UFFLP_NoDualVariables;
+	if (row < 0 || row >= (int)duals.size())
+		return UFFLP_ConsNameNotFound;
+	*value = duals[row];
+	return UFFLP_Ok;
+}
+
+UFFLP_ErrorType NativeSolver::SetLogInfo(const char* fname, int level)
+{
+	FILE* f = stdout;
+	if (fname != NULL && fname[0] != '\0')
+	{
+		f = fopen(fname, "w");
+		if (f == NULL)
+			return UFFLP_UnableOpenFile;
+	}
+	if (logFile != stdout && logFile != NULL)
+		fclose(logFile);
+	logFile = f;
+	logLevel = level;
+	Log("vant native MIP engine (bounded dual simplex, best-bound B&B)\n");
+	return UFFLP_Ok;
+}
+
+UFFLP_ErrorType NativeSolver::SetParameter(UFFLP_ParameterType param,
+	double value)
+{
+	switch (param)
+	{
+	case UFFLP_CutoffValue:
+		cutoff = value;
+		break;
+	case UFFLP_NodesLimit:
+		nodesLimit = (long)value;
+		break;
+	case UFFLP_TimeLimit:
+		timeLimit = value;
+		break;
+	case UFFLP_ModelType:
+		if ((int)value != UFFLP_CompleteModel)
+			return UFFLP_InvalidParameter;
+		break;
+	default:
+		return UFFLP_InvalidParameter;
+	}
+	return UFFLP_Ok;
+}
+
+UFFLP_ErrorType NativeSolver::SetSolverParameter(SolverParameter param,
+	double value)
+{
+	switch (param)
+	{
+	case SolverParam_RelativeGap:
+		if (value < 0)
+			return UFFLP_InvalidParameter;
+		relGap = value;
+		break;
+	case SolverParam_Threads:
+	case SolverParam_StrongBranching:
+		// single-threaded, most fractional branching
+		break;
+	default:
+		return UFFLP_InvalidParameter;
+	}
+	return UFFLP_Ok;
+}
+
+UFFLP_ErrorType NativeSolver::SetCutCallBack(SolverCallback func, void* data)
+{
+	cutFunc = func;
+	cutData = data;
+	return UFFLP_Ok;
+}
+
+UFFLP_ErrorType NativeSolver::SetHeurCallBack(SolverCallback func, void* data)
+{
+	heurFunc = func;
+	heurData = data;
+	return UFFLP_Ok;
+}
+
+UFFLP_ErrorType NativeSolver::PrintToLog(const char* message)
+{
+	if (!inCut && !inHeuristic)
+		return UFFLP_NotInCallback;
+	Log("%s", message);
+	return UFFLP_Ok;
+}
+
+UFFLP_ErrorType NativeSolver::GetBestSolutionValue(double* value)
+{
+	if (!inHeuristic)
+		return UFFLP_NotInHeuristic;
+	if (!hasIncumbent)
+		return UFFLP_NoSolExists;
+	*value = maximize ? -incumbentObj : incumbentObj;
+	return UFFLP_Ok;
+}
+
+UFFLP_ErrorType NativeSolver::SetSolution(int col, double value)
+{
+	if (!inHeuristic)
+		return UFFLP_NotInHeuristic;
+	if (col < 0 || col >= ncols)
+		return UFFLP_VarNameNotFound;
+	heurSol[col] = value;
+	heurProvided = true;
+	return UFFLP_Ok;
+}
+
+UFFLP_ErrorType NativeSolver::GetNodeDepth(int* value)
+{
+	if (!inCut && !inHeuristic)
+		return UFFLP_NotInCallback;
+	*value = curDepth;
+	return UFFLP_Ok;
+}
+
+UFFLP_ErrorType NativeSolver::SetPriority(int col, int prior)
+{
+	if (col < 0 || col >= ncols)
+		return UFFLP_VarNameNotFound;
+	if (prior < 0 || type[col] == UFFLP_Continuous)
+		return UFFLP_InvalidPriority;
+	priority[col] = prior;
+	return UFFLP_Ok;
+}
+
+UFFLP_ErrorType NativeSolver::ChangeBounds(int col, double lb, double ub)
+{
+	if (inCut || inHeuristic)
+		return UFFLP_InCallback;
+	if (col < 0 || col >= ncols)
+		return UFFLP_VarNameNotFound;
+	rootLb[col] = lb;
+	rootUb[col] = ub;
+	lp.SetBounds(col, lb, ub);
+	return UFFLP_Ok;
+}
+
+UFFLP_ErrorType NativeSolver::ChangeObjCoeff(int col, double value)
+{
+	if (inCut || inHeuristic)
+		return UFFLP_InCallback;
+	if (col < 0 || col >= ncols)
+		return UFFLP_VarNameNotFound;
+	obj[col] = value;
+	lp.SetCost(col, value);
+	return UFFLP_Ok;
+}
+
+UFFLP_ErrorType NativeSolver::ChangeVariableType(int col, UFFLP_VarType type)
+{
+	if (inCut || inHeuristic)
+		return UFFLP_InCallback;
+	if (col < 0 || col >= ncols)
+		return UFFLP_VarNameNotFound;
+	if (type == UFFLP_SemiContinuous)
+		return UFFLP_UnknownVarType;
+	this->type[col] = type;
+	return UFFLP_Ok;
+}
+
+SolverBackend* CreateNativeSolver()
+{
+	return new NativeSolver();
+}
@@ -0,0 +1,431 @@
+#include "solver.h"
+
+#ifdef VANT_WITH_UFFLP
+
+#include "modelbuilder.h"
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <stdio.h>
+#include <string.h>
+
+// CPLEX definitions
+#define CPX_PARAM_THREADS  1067
+#define CPX_PARAM_EPGAP    2009
+#define CPX_PARAM_VARSEL   2028
+#define CPX_VARSEL_DEFAULT 0
+#define CPX_VARSEL_STRONG  3
+
+// Backend over the UFFLP3 library. UFFLP addresses every entity by name, so
+// the names of the loaded model are formatted once and kept for the index
+// based queries. UFFLP cannot add a coefficient to an existing constraint,
+// so a copy of the model is kept: AddColumn extends the copy and the next
+// Solve rebuilds the problem from it, replaying the settings.
+class UfflpSolver : public SolverBackend
+{
+public:
+	UfflpSolver();
+	~UfflpSolver();
+
+	const char* Name() const { return "ufflp"; }
+
+	UFFLP_ErrorType LoadModel(const ModelBuilder& model);
+	UFFLP_ErrorType AddConstraint(int len, const int* cols,
+		const double* vals, double rhs, UFFLP_ConsType type);
+	UFFLP_ErrorType AddColumn(double lb, double ub, double obj,
+		UFFLP_VarType type, int len, const int* rows, const double* vals);
+	UFFLP_StatusType Solve();
+	UFFLP_ErrorType GetObjValue(double* value);
+	UFFLP_ErrorType GetSolution(int col, double* value);
+	UFFLP_ErrorType GetSolutions(int first, int count, double* values);
+	UFFLP_ErrorType GetDualSolution(int row, double* value);
+	UFFLP_ErrorType SetLogInfo(const char* fname, int level);
+	UFFLP_ErrorType SetParameter(UFFLP_ParameterType param, double value);
+	UFFLP_ErrorType SetSolverParameter(SolverParameter param, double value);
+	UFFLP_ErrorType SetCutCallBack(SolverCallback func, void* data);
+	UFFLP_ErrorType SetHeurCallBack(SolverCallback func, void* data);
+	UFFLP_ErrorType PrintToLog(const char* message);
+	UFFLP_ErrorType GetBestSolutionValue(double* value);
+	UFFLP_ErrorType SetSolution(int col, double value);
+	UFFLP_ErrorType GetNodeDepth(int* value);
+	long NodeCount() const { return -1; }
+	UFFLP_ErrorType GetBestBound(double*) { return UFFLP_NoSolExists; }
+	UFFLP_ErrorType SetPriority(int col, int prior);
+	UFFLP_ErrorType SetStopFlag(const std::atomic<bool>*) { return UFFLP_InvalidParameter; }
+	UFFLP_ErrorType ChangeBounds(int col, double lb, double ub);
+	UFFLP_ErrorType ChangeObjCoeff(int col, double value);
+	UFFLP_ErrorType ChangeVariableType(int col, UFFLP_VarType type);
+
+private:
+	char* VarName(int col) { return &varPool[varOffset[col]]; }
+	bool ValidCol(int col) const { return col >= 0 && col < (int)varOffset.size(); }
+
+	UFFLP_ErrorType Rebuild();
+	static UfflpSolver* Lookup(UFFProblem* prob);
+	static void STDCALL CutTrampoline(UFFProblem* prob);
+	static void STDCALL HeurTrampoline(UFFProblem* prob);
+
+	UFFProblem* prob;
+	std::vector<char> varPool, consPool;
+	std::vector<size_t> varOffset, consOffset;
+	int extraRows;      // cuts added inside callbacks
+	bool rowBlock;      // the copy has a block for rows added outside them
+
+	SolverCallback cutFunc, heurFunc;
+	void *cutData, *heurData;
+	bool inCallback;
+
+	// copy of the model and settings to replay when it is rebuilt
+	ModelBuilder model;
+	bool rebuild;
+	int addedCols;
+	std::string logName;
+	int logLevel;
+	std::map<UFFLP_ParameterType, double> params;
+	std::map<SolverParameter, double> solverParams;
+	std::map<int, int> priorities;
+
+	// UFFLP callbacks only receive the problem, so map it back to its backend
+	static std::map<UFFProblem*, UfflpSolver*> registry;
+	static std::mutex registryMutex;
+};
+
+std::map<UFFProblem*, UfflpSolver*> UfflpSolver::registry;
+std::mutex UfflpSolver::registryMutex;
+
+UfflpSolver::UfflpSolver() : prob(NULL), extraRows(0), rowBlock(false),
+	cutFunc(NULL), heurFunc(NULL), cutData(NULL), heurData(NULL),
+	inCallback(false), rebuild(false), addedCols(0), logLevel(-1)
+{
+}
+
+UfflpSolver::~UfflpSolver()
+{
+	if (prob != NULL)
+	{
+		std::lock_guard<std::mutex> lock(registryMutex);
+		registry.erase(prob);
+		UFFLP_DestroyProblem(prob);
+	}
+}
+
+UfflpSolver* UfflpSolver::Lookup(UFFProblem* prob)
+{
+	std::lock_guard<std::mutex> lock(registryMutex);
+	std::map<UFFProblem*, UfflpSolver*>::iterator it = registry.find(prob);
+	return it == registry.end() ? NULL : it->second;
+}
+
+void STDCALL UfflpSolver::CutTrampoline(UFFProblem* prob)
+{
+	UfflpSolver* s = Lookup(prob);
+	if (s != NULL && s->cutFunc != NULL)
+	{
+		s->inCallback = true;
+		s->cutFunc(s, s->cutData);
+		s->inCallback = false;
+	}
+}
+
+void STDCALL UfflpSolver::HeurTrampoline(UFFProblem* prob)
+{
+	UfflpSolver* s = Lookup(prob);
+	if (s != NULL && s->heurFunc != NULL)
+	{
+		s->inCallback = true;
+		s->heurFunc(s, s->heurData);
+		s->inCallback = false;
+	}
+}
+
+UFFLP_ErrorType UfflpSolver::LoadModel(const ModelBuilder& model)
+{
+	if (prob != NULL)
+		return UFFLP_InvalidProblem;
+
+	this->model = model;
+	return Rebuild();
+}
+
+// (Re)create the UFFLP problem from the copy of the model
+UFFLP_ErrorType UfflpSolver::Rebuild()
+{
+	if (prob != NULL)
+	{
+		std::lock_guard<std::mutex> lock(registryMutex);
+		registry.erase(prob);
+		UFFLP_DestroyProblem(prob);
+	}
+	prob = UFFLP_CreateProblem(model.sense);
+	{
+		std::lock_guard<std::mutex> lock(registryMutex);
+		registry[prob] = this;
+	}
+	rebuild = false;
+
+	model.VarNamePool(varPool, varOffset);
+	model.ConsNamePool(consPool, consOffset);
+	UFFLP_ErrorType err = model.LoadInto(prob, varPool, varOffset);
+	if (err != UFFLP_Ok)
+		return err;
+
+	if (logLevel >= 0)
+		UFFLP_SetLogInfo(prob, (char*)logName.c_str(), logLevel);
+	for (std::map<UFFLP_ParameterType, double>::iterator it = params.begin();
+		it != params.end(); ++it)
+		UFFLP_SetParameter(prob, it->first, it->second);
+	for (std::map<SolverParameter, double>::iterator it = solverParams.begin();
+		it != solverParams.end(); ++it)
+		SetSolverParameter(it->first, it->second);
+	if (cutFunc != NULL)
+		UFFLP_SetCutCallBack(prob, CutTrampoline);
+	if (heurFunc != NULL)
+		UFFLP_SetHeurCallBack(prob, HeurTrampoline);
+	for (std::map<int, int>::iterator it = priorities.begin();
+		it != priorities.end(); ++it)
+		UFFLP_SetPriority(prob, VarName(it->first), it->second);
+	return UFFLP_Ok;
+}
+
+UFFLP_ErrorType UfflpSolver::AddConstraint(int len, const int* cols,
+	const double* vals, double rhs, UFFLP_ConsType type)
+{
+	UFFLP_ErrorType err;
+	char name[ModelBuilder::MaxNameLen];
+
+	for (int k = 0; k < len; k++)
+		if (!ValidCol(cols[k]))
+			return UFFLP_VarNameNotFound;
+
+	if (inCallback)
+		sprintf(name, "cut_%d", extraRows++);
+	else
+	{
+		// a permanent row, also kept in the copy of the model
+		if (!rowBlock)
+			model.BeginConstraintBlock("row");
+		rowBlock = true;
+		for (int k = 0; k < len; k++)
+			model.AddCoefficient(cols[k], vals[k]);
+		int row = model.EndRow(rhs, type);
+		int chars = model.ConsName(row, name);
+		consOffset.push_back(consPool.size());
+		consPool.insert(consPool.end(), name, name + chars + 1);
+		if (rebuild)
+			return UFFLP_Ok;
+	}
+
+	for (int k = 0; k < len; k++)
+	{
+		err = UFFLP_SetCoefficient(prob, name, VarName(cols[k]), vals[k]);
+		if (err != UFFLP_Ok)
+			return err;
+	}
+	return UFFLP_AddConstraint(prob, name, rhs, type);
+}
+
+UFFLP_ErrorType UfflpSolver::AddColumn(double lb, double ub, double obj,
+	UFFLP_VarType type, int len, const int* rows, const double* vals)
+{
+	if (inCallback)
+		return UFFLP_InCallback;
+	for (int k = 0; k < len; k++)
+		if (rows[k] < 0 || rows[k] >= model.NumConstraints())
+			return UFFLP_ConsNameNotFound;
+
+	// insert the coefficients into the rows of the copy
+	char name[ModelBuilder::MaxNameLen];
+	sprintf(name, "col_%d", addedCols++);
+	int col = model.AddVariable(name, lb, ub, obj, type);
+	varOffset.push_back(varPool.size());
+	varPool.insert(varPool.end(), name, name + strlen(name) + 1);
+	std::vector<int> extra(model.NumConstraints() + 1, 0);
+	for (int k = 0; k < len; k++)
+		extra[rows[k] + 1]++;
+	for (int i = 0; i < model.NumConstraints(); i++)
+		extra[i + 1] += extra[i];
+
+	std::vector<int> start(model.rowStart), cols(model.colIdx);
+	std::vector<double> coefs(model.value);
+	model.colIdx.resize(cols.size() + len);
+	model.value.resize(cols.size() + len);
+	for (int i = 0; i < model.NumConstraints(); i++)
+	{
+		int to = start[i] + extra[i];
+		model.rowStart[i] = to;
+		for (int k = start[i]; k < start[i + 1]; k++, to++)
+		{
+			model.colIdx[to] = cols[k];
+			model.value[to] = coefs[k];
+		}
+	}
+	model.rowStart[model.NumConstraints()] = (int)model.colIdx.size();
+	for (int k = 0; k < len; k++)
+	{
+		int pos = start[rows[k] + 1] + extra[rows[k]]++;
+		model.colIdx[pos] = col;
+		model.value[pos] = vals[k];
+	}
+	rebuild = true;
+	return UFFLP_Ok;
+}
+
+UFFLP_StatusType UfflpSolver::Solve()
+{
+	if (rebuild && Rebuild() != UFFLP_Ok)
+		return UFFLP_InternalError;
+	return UFFLP_Solve(prob);
+}
+
+UFFLP_ErrorType UfflpSolver::GetObjValue(double* value)
+{
+	return UFFLP_GetObjValue(prob, value);
+}
+
+UFFLP_ErrorType UfflpSolver::GetSolution(int col, double* value)
+{
+	if (!ValidCol(col))
+		return UFFLP_VarNameNotFound;
+	return UFFLP_GetSolution(prob, VarName(col), value);
+}
+
+// UFFLP has no bulk query; the names come from the pool, so there is no
+// formatting per variable
+UFFLP_ErrorType UfflpSolver::GetSolutions(int first, int count,
+	double* values)
+{
+	if (first < 0 || count < 0 || !ValidCol(first + count - 1))
+		return count == 0 ? UFFLP_Ok : UFFLP_VarNameNotFound;
+	for (int k = 0; k < count; k++)
+	{
+		UFFLP_ErrorType err = UFFLP_GetSolution(prob, VarName(first + k), &values[k]);
+		if (err != UFFLP_Ok)
+			return err;
+	}
+	return UFFLP_Ok;
+}
+
+UFFLP_ErrorType UfflpSolver::GetDualSolution(int row, double* value)
+{
+	if (row < 0 || row >= (int)consOffset.size())
+		return UFFLP_ConsNameNotFound;
+	return UFFLP_GetDualSolution(prob, &consPool[consOffset[row]], value);
+}
+
+UFFLP_ErrorType UfflpSolver::SetLogInfo(const char* fname, int level)
+{
+	logName = fname;
+	logLevel = level;
+	return UFFLP_SetLogInfo(prob, (char*)fname, level);
+}
+
+UFFLP_ErrorType UfflpSolver::SetParameter(UFFLP_ParameterType param,
+	double value)
+{
+	params[param] = value;
+	return UFFLP_SetParameter(prob, param, value);
+}
+
+UFFLP_ErrorType UfflpSolver::SetSolverParameter(SolverParameter param,
+	double value)
+{
+	solverParams[param] = value;
+	switch (param)
+	{
+	case SolverParam_Threads:
+		return UFFLP_SetCplexParameter(prob, CPX_PARAM_THREADS, UFFLP_IntegerParam, value);
+	case SolverParam_RelativeGap:
+		return UFFLP_SetCplexParameter(prob, CPX_PARAM_EPGAP, UFFLP_FloatParam, value);
+	case SolverParam_StrongBranching:
+		return UFFLP_SetCplexParameter(prob, CPX_PARAM_VARSEL, UFFLP_IntegerParam,
+			value != 0 ? CPX_VARSEL_STRONG : CPX_VARSEL_DEFAULT);
+	default:
+		return UFFLP_InvalidParameter;
+	}
+}
+
+UFFLP_ErrorType UfflpSolver::SetCutCallBack(SolverCallback func, void* data)
+{
+	cutFunc = func;
+	cutData = data;
+	return UFFLP_SetCutCallBack(prob, func != NULL ? CutTrampoline : NULL);
+}
+
+UFFLP_ErrorType UfflpSolver::SetHeurCallBack(SolverCallback func, void* data)
+{
+	heurFunc = func;
+	heurData = data;
+	return UFFLP_SetHeurCallBack(prob, func != NULL ? HeurTrampoline : NULL);
+}
+
+UFFLP_ErrorType UfflpSolver::PrintToLog(const char* message)
+{
+	return UFFLP_PrintToLog(prob, (char*)message);
+}
+
+UFFLP_ErrorType UfflpSolver::GetBestSolutionValue(double* value)
+{
+	return UFFLP_GetBestSolutionValue(prob, value);
+}
+
+UFFLP_ErrorType UfflpSolver::SetSolution(int col, double value)
+{
+	if (!ValidCol(col))
+		return UFFLP_VarNameNotFound;
+	return UFFLP_SetSolution(prob, VarName(col), value);
+}
+
+UFFLP_ErrorType UfflpSolver::GetNodeDepth(int* value)
+{
+	return UFFLP_GetNodeDepth(prob, value);
+}
+
+UFFLP_ErrorType UfflpSolver::SetPriority(int col, int prior)
+{
+	if (!ValidCol(col))
+		return UFFLP_VarNameNotFound;
+	priorities[col] = prior;
+	if (rebuild)
+		return UFFLP_Ok;     // applied by the rebuild
+	return UFFLP_SetPriority(prob, VarName(col), prior);
+}
+
+UFFLP_ErrorType UfflpSolver::ChangeBounds(int col, double lb, double ub)
+{
+	if (!ValidCol(col))
+		return UFFLP_VarNameNotFound;
+	model.lb[col] = lb;
+	model.ub[col] = ub;
+	if (rebuild)
+		return UFFLP_Ok;     // applied by the rebuild
+	return UFFLP_ChangeBounds(prob, VarName(col), lb, ub);
+}
+
+UFFLP_ErrorType UfflpSolver::ChangeObjCoeff(int col, double value)
+{
+	if (!ValidCol(col))
+		return UFFLP_VarNameNotFound;
+	model.obj[col] = value;
+	if (rebuild)
+		return UFFLP_Ok;     // applied by the rebuild
+	return UFFLP_ChangeObjCoeff(prob, VarName(col), value);
+}
+
+UFFLP_ErrorType UfflpSolver::ChangeVariableType(int col, UFFLP_VarType type)
+{
+	if (!ValidCol(col))
+		return UFFLP_VarNameNotFound;
+	model.type[col] = type;
+	if (rebuild)
+		return UFFLP_Ok;     // applied by the rebuild
+	return UFFLP_ChangeVariableType(prob, VarName(col), type);
+}
+
+SolverBackend* CreateUfflpSolver()
+{
+	return new UfflpSolver();
+}
+
+#endif // VANT_WITH_UFFLP
@@ -0,0 +1,229 @@
+#include "sysutil.h"
+
+#include <algorithm>
+#include <chrono>
+#include <stdio.h>
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#else
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+double WallClock()
+{
+	using namespace std::chrono;
+	return duration_cast<duration<double> >(
+		steady_clock::now().time_since_epoch()).count();
+}
+
+#ifdef _WIN32
+static double FileTimeSeconds(const FILETIME& kernel, const FILETIME& user)
+{
+	ULARGE_INTEGER k, u;
+	k.LowPart = kernel.dwLowDateTime;
+	k.HighPart = kernel.dwHighDateTime;
+	u.LowPart = user.dwLowDateTime;
+	u.HighPart = user.dwHighDateTime;
+	return (double)(k.QuadPart + u.QuadPart) * 1e-7;   // 100 ns units
+}
+#endif
+
+double ProcessCpuTime()
+{
+#ifdef _WIN32
+	FILETIME creation, exit, kernel, user;
+	if (GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user))
+		return FileTimeSeconds(kernel, user);
+	return 0.0;
+#else
+	struct timespec ts;
+	if (clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts) == 0)
+		return ts.tv_sec + ts.tv_nsec * 1e-9;
+	return 0.0;
+#endif
+}
+
+double ThreadCpuTime()
+{
+#ifdef _WIN32
+	FILETIME creation, exit, kernel, user;
+	if (GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user))
+		return FileTimeSeconds(kernel, user);
+	return 0.0;
+#else
+	struct timespec ts;
+	if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) == 0)
+		return ts.tv_sec + ts.tv_nsec * 1e-9;
+	return 0.0;
+#endif
+}
+
+long PeakRSSKB()
+{
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS pmc;
+	if (GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc)))
+		return (long)(pmc.PeakWorkingSetSize / 1024);
+	return 0;
+#else
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) == 0)
+		return usage.ru_maxrss;
+	return 0;
+#endif
+}
+
+bool IsDirectory(const char* path)
+{
+	struct stat st;
+	return stat(path, &st) == 0 && (st.st_mode & S_IFMT) == S_IFDIR;
+}
+
+bool ListFiles(const char* dir, std::vector<std::string>& names)
+{
+	names.clear();
+#ifdef _WIN32
+	WIN32_FIND_DATAA data;
+	std::string pattern = std::string(dir) + "\\*";
+	HANDLE h = FindFirstFileA(pattern.c_str(), &data);
+	if (h == INVALID_HANDLE_VALUE)
+		return false;
+	do
+	{
+		if (!(data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY))
+			names.push_back(data.cFileName);
+	} while (FindNextFileA(h, &data));
+	FindClose(h);
+#else
+	DIR* d = opendir(dir);
+	if (d == NULL)
+		return false;
+	struct dirent* entry;
+	while ((entry = readdir(d)) != NULL)
+	{
+		std::string path = std::string(dir) + "/" + entry->d_name;
+		struct stat st;
+		if (stat(path.c_str(), &st) == 0 && (st.st_mode & S_IFMT) == S_IFREG)
+			names.push_back(entry->d_name);
+	}
+	closedir(d);
+#endif
+	std::sort(names.begin(), names.end());
+	return true;
+}
+
+int ProcessId()
+{
+#ifdef _WIN32
+	return (int)GetCurrentProcessId();
+#else
+	return (int)getpid();
+#endif
+}
+
+bool RenameReplacing(const char* from, const char* to)
+{
+#ifdef _WIN32
+	return MoveFileExA(from, to, MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+	return rename(from, to) == 0;
+#endif
+}
+
+#ifdef _WIN32
+MappedFile::MappedFile() : data(NULL), size(0), file(INVALID_HANDLE_VALUE),
+	mapping(NULL)
+{
+}
+#else
+MappedFile::MappedFile() : data(NULL), size(0)
+{
+}
+#endif
+
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+// Empty files are not mapped: Data() stays NULL with a size of 0
+bool MappedFile::Open(const char* fname)
+{
+	Close();
+#ifdef _WIN32
+	file = CreateFileA(fname, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+		FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+	LARGE_INTEGER length;
+	if (!GetFileSizeEx(file, &length))
+	{
+		Close();
+		return false;
+	}
+	size = (size_t)length.QuadPart;
+	if (size == 0)
+		return true;
+	mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (mapping != NULL)
+		data = (const char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (data == NULL)
+	{
+		Close();
+		return false;
+	}
+#else
+	int fd = open(fname, O_RDONLY);
+	if (fd < 0)
+		return false;
+	struct stat st;
+	if (fstat(fd, &st) != 0 || (st.st_mode & S_IFMT) != S_IFREG)
+	{
+		close(fd);
+		return false;
+	}
+	size = (size_t)st.st_size;
+	if (size > 0)
+	{
+		void* p = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (p == MAP_FAILED)
+		{
+			close(fd);
+			size = 0;
+			return false;
+		}
+		madvise(p, size, MADV_SEQUENTIAL);
+		data = (const char*)p;
+	}
+	close(fd);
+#endif
+	return true;
+}
+
+void MappedFile::Close()
+{
+#ifdef _WIN32
+	if (data != NULL)
+		UnmapViewOfFile(data);
+	if (mapping != NULL)
+		CloseHandle(mapping);
+	if (file != INVALID_HANDLE_VALUE)
+		CloseHandle(file);
+	mapping = NULL;
+	file = INVALID_HANDLE_VALUE;
+#else
+	if (data != NULL)
+		munmap((void*)data, size);
+#endif
+	data = NULL;
+	size = 0;
+}
@@ -0,0 +1,63 @@
+/****************************************************************************
+* Portable process measurements and file system queries used by the
+* benchmarks, the batch mode and the run reports
+*****************************************************************************/
+
+#ifndef __SYS_UTIL_H__
+#define __SYS_UTIL_H__
+
+#include <string>
+#include <vector>
+
+// Wall-clock time in seconds since an arbitrary fixed point
+double WallClock();
+
+// CPU time in seconds used by the whole process, or by the calling thread
+double ProcessCpuTime();
+double ThreadCpuTime();
+
+// Peak resident set size of the current process, in kilobytes
+long PeakRSSKB();
+
+// True if path names an existing directory
+bool IsDirectory(const char* path);
+
+// Names of the regular files in a directory, sorted.
+// @return false if the directory could not be read
+bool ListFiles(const char* dir, std::vector<std::string>& names);
+
+// Identifier of the current process
+int ProcessId();
+
+// Rename a file, replacing the destination if it exists
+// @return false if the file could not be moved
+bool RenameReplacing(const char* from, const char* to);
+
+// Read-only memory mapping of a whole file, released by the destructor
+class MappedFile
+{
+public:
+	MappedFile();
+	~MappedFile();
+
+	// Map a file, dropping the previous mapping.
+	// @return false if the file could not be opened or mapped
+	bool Open(const char* fname);
+	void Close();
+
+	const char* Data() const { return data; }
+	size_t Size() const { return size; }
+
+private:
+	MappedFile(const MappedFile&);
+	MappedFile& operator=(const MappedFile&);
+
+	const char* data;
+	size_t size;
+#ifdef _WIN32
+	void* file;
+	void* mapping;
+#endif
+};
+
+#endif
@@ -1,224 +1,209 @@
 #include "UFFLP.h"
+#include "solve.h"
+#include "instance.h"
+#include "options.h"
+#include "batch.h"
+#include "benchmark.h"
+#include "daemon.h"
+#include "generator.h"
+#include "report.h"
+#include "runstats.h"
+#include "schedule.h"
+#include "selftest.h"
+#include "sysutil.h"
 
 #include <string>
-#include <sstream>
+#include <vector>
 #include <iostream>
 #include <stdlib.h>
 #include <time.h>
 #include <stdio.h>
-
-// CPLEX definitions
-#define CPX_PARAM_THREADS  1067
-#define CPX_PARAM_EPGAP    2009
-#define CPX_PARAM_VARSEL   2028
-#define CPX_VARSEL_STRONG  3
+#include <string.h>
 
 int main(int argc, char *argv[])
 {
-	int ninst, valor;
-	int i, j;
-	int *ptr_p, *ptr_st;
-	FILE *fin, *fout;
-	int *proctime, *setup;
+	int ninst;
+	FILE *fout;
+	std::vector<int> proctime, setup;
+	JobRelations relations;
 	int n, m;
-	float start, end;
-	double resultado;
-
-	if (argc != 4) {
-		printf("\nVANT\n");
-		printf("Enter the instance file name, the number of machines and the instance number!\n");
-		printf("Example: wet+(#jobs)-(#machines)m-(#instance)  +  #machines  +  #instance\n");
-		printf("Output File: JIT+(#jobs)-(#machines)m-(#instance)\n");
-		exit(1);
-	}
-	else if ((fin = fopen(argv[1], "r")) == NULL) {
-		printf("SSETBH: unable to open input file! %s\n", argv[1]);
+	double start, cpuStart, elapsed;
+	VantOptions opts;
+	SolveResult result;
+
+	if (argc > 1 && strcmp(argv[1], "--bench-build") == 0)
+		return RunBuildBenchmark(argc, argv);
+	if (argc > 1 && strcmp(argv[1], "--bench-symmetry") == 0)
+		return RunSymmetryBenchmark(argc, argv);
+	if (argc > 1 && (strcmp(argv[1], "--bench-suite") == 0 ||
+		strcmp(argv[1], "--bench-suite=default") == 0))
+		return RunBenchmarkSuite(argc, argv);
+	if (argc > 1 && strcmp(argv[1], "--generate") == 0)
+		return RunGenerate(argc, argv);
+	if (argc > 1 && strcmp(argv[1], "--batch") == 0)
+		return RunBatch(argc, argv);
+	if (argc > 1 && strcmp(argv[1], "--convert") == 0)
+		return RunConvert(argc, argv);
+	if (argc > 1 && strcmp(argv[1], "--daemon") == 0)
+		return RunDaemon(argc, argv);
+	if (argc > 1 && strcmp(argv[1], "--self-test") == 0)
+		return RunSelfTest(argc, argv);
+
+	if (!ParseOptions(argc, argv, opts))
 		exit(1);
-	}
 
-	m = atoi(argv[2]);      //keep the number of machines
-	ninst = atoi(argv[3]);  //keep the instance number
+	m = opts.machines;
+	ninst = opts.ninst;
 
-	fscanf(fin, "%d", &n);  //get the number of jobs
+	start = WallClock(); //init the execution time
+	cpuStart = ProcessCpuTime();
 
-	proctime = new int[n];
-	setup = new int[n];
-
-	if (proctime == NULL || setup == NULL)
-	{
-		printf("Scheduling arrays:  Not enough memory\n");
+	printf("Reading instances...\n");
+	PhaseTimer readTimer(&result.stats, Phase_Read);
+	bool read = ReadInstance(opts.instance, proctime, setup, &relations);
+	readTimer.Stop();
+	if (!read) {
+		printf("SSETBH: unable to open input file! %s\n", opts.instance);
 		exit(1);
 	}
-
-	printf("Reading instances...\n");
-	for (i = 0, ptr_p = proctime, ptr_st = setup; i<n; i++, ptr_p++, ptr_st++)
-		fscanf(fin, "%d" "%d", ptr_p, ptr_st);
-
-	fclose(fin);
+	n = (int)proctime.size();
 	printf("Finished reading!\n");
 
-	printf("Processing Times:\n");
-	for (i = 0; i<n; i++)
-		printf("%d	", proctime[i]);
-
-	printf("\nSetups:\n");
-	for (i = 0; i<n; i++)
-		printf("%d	", setup[i]);
-
-	start = clock(); //init the execution time
-
-	// create an empty problem instance
-	UFFProblem* prob = UFFLP_CreateProblem(UFFLP_Minimize);
-
-	std::string varName;
-
-	puts("Fill the objective function...");
+	if (opts.echo)
+		EchoInstance(stdout, proctime, setup);
 
-	std::stringstream s;
-	s << "C_max";
-	s >> varName;
-	UFFLP_AddVariable(prob, (char*)varName.c_str(), 0.0, UFFLP_Infinity, 1.0, UFFLP_Integer);
-
-	for (i = 0; i < m; i++)
+	FILE* ftrace = NULL;
+	ProgressTrace* trace = NULL;
+	if (opts.trace != NULL)
 	{
-		for (j = 0; j < n; j++)
-		{
-			std::stringstream s;
-			s << "x_" << i << "_" << j;
-			s >> varName;
-			UFFLP_AddVariable(prob, (char*)varName.c_str(), 0.0, 1.0, 0.0, UFFLP_Binary);
-		}
+		ftrace = fopen(opts.trace, "w");
+		if (ftrace == NULL)
+			printf("\nCould not open the trace file %s\n", opts.trace);
+		else
+			trace = new ProgressTrace(ftrace, opts.traceInterval);
 	}
 
-	std::string consName;
-	for (i = 0; i < m; i++)
-	{
-		// assembly the constraint name "restr1_i"
-		std::stringstream s;
-		s << "restr1_" << i;
-		s >> consName;
-
-		// set the coefficients for the constraint
-		for (j = 0; j < n; j++)
-		{
-			std::stringstream s;
-			s << "x_" << i << "_" << j;
-			s >> varName;
-			UFFLP_SetCoefficient(prob, (char*)consName.c_str(), (char*)varName.c_str(), 1);
-		}
+	SolveInstance(opts, n, proctime.empty() ? NULL : &proctime[0],
+		setup.empty() ? NULL : &setup[0], result, trace, &relations);
+	double value = result.value;
+	const std::vector<int>& machineOf = result.machineOf;
+	UFFLP_StatusType status = result.status;
 
-		// create the constraint
-		UFFLP_AddConstraint(prob, (char*)consName.c_str(), 1, UFFLP_Equal);
+	elapsed = WallClock() - start;
+	result.stats.totalWall = elapsed;
+	result.stats.totalCpu = ProcessCpuTime() - cpuStart;
+	if (trace != NULL)
+	{
+		delete trace;
+		fclose(ftrace);
 	}
 
-
-	for (i = 0; i < m; i++)
+	// jobs of every machine with their start and finish times
+	std::vector<MachineSchedule> machines;
+	if (status == UFFLP_Optimal || status == UFFLP_Feasible)
 	{
-		// assembly the constraint name "restr2_i"
-		std::stringstream s;
-		s << "restr2_" << i;
-		s >> consName;
-
-		// set the coefficients for the constraint
-		for (j = 0; j < n; j++)
-		{
-			// add the variable "x_i_j" to the constraint
-			std::stringstream s1;
-			s1 << "x_" << i << "_" << j;
-			s1 >> varName;
-			UFFLP_SetCoefficient(prob, (char*)consName.c_str(), (char*)varName.c_str(), setup[i] + proctime[j]);
-		}
-
-		std::stringstream s2;
-		s2 << "C_max";
-		s2 >> varName;
-		UFFLP_SetCoefficient(prob, (char*)consName.c_str(), (char*)varName.c_str(), -1);
-
-		// create the constraint
-		UFFLP_AddConstraint(prob, (char*)consName.c_str(), 0, UFFLP_Less);
+		const int* p = proctime.empty() ? NULL : &proctime[0];
+		const int* s = setup.empty() ? NULL : &setup[0];
+		if (result.start.empty())
+			BuildMachineSchedules(n, m, p, s, machineOf, machines);
+		else
+			BuildTimedSchedules(m, machineOf, result.start, result.finish, machines);
+		if (opts.schedule != NULL && !WriteScheduleCSV(opts.schedule, p,
+			machines))
+			printf("Could not write the schedule to %s\n", opts.schedule);
 	}
-	//precedencia
-
-	// Write the problem in LP format for debug
-	char fname[50];
-	sprintf(fname, "vant%d-%dm-%d.lp", n, m, ninst);
-	UFFLP_WriteLP(prob, fname);
-
-	// Configure the log file and the log level = 3
-	sprintf(fname, "vant%d-%dm-%d.log", n, m, ninst);
-	UFFLP_SetLogInfo(prob, fname, 2);
-
-	// solve the problem
-	// UFFLP_SetParameter( prob, UFFLP_CutoffValue, bestCost ); // Cutoff value for the objective function
-	UFFLP_SetParameter(prob, UFFLP_TimeLimit, 10800); // Maximum number of seconds to run the B&B
-	UFFLP_SetCplexParameter(prob, CPX_PARAM_EPGAP, UFFLP_FloatParam, 1e-8);
-	UFFLP_SetCplexParameter(prob, CPX_PARAM_VARSEL, UFFLP_IntegerParam, CPX_VARSEL_STRONG);
-	UFFLP_SetCplexParameter(prob, CPX_PARAM_THREADS, UFFLP_IntegerParam, 1);
-	UFFLP_StatusType status = UFFLP_Solve(prob);
-
-	end = clock();
 
 	// check if an optimal solution has been found
 	if (status == UFFLP_Optimal)
 	{
-		double value;
 		std::cout << "Optimal solution found!" << std::endl << std::endl;
 		std::cout << "Solution:" << std::endl;
 
-		// get the value of the objective function
-		UFFLP_GetObjValue(prob, &value);
 		std::cout << "Objective function value = " << value << std::endl;
 
 		// print the total time
-		std::cout << "Total Time = " << (end - start) / CLOCKS_PER_SEC << std::endl;
-
-		
-		char cname[50];
-		for (i = 0; i < m; i++){
-			for (j = 0; j < n; j++){
-				sprintf(cname, "x_%d_%d", i, j);
-				valor = UFFLP_GetSolution(prob, cname, &resultado);
-				if (resultado == 1){
-					printf("A maquina %ld esta processando a tarefa %ld\n", i, j);
-				}
-			}
-		}
+		std::cout << "Total Time = " << elapsed << std::endl;
 
+		PrintMachineSchedules(stdout, machines);
 
-		printf("Saving statistics...\n");
-		char fname[50];
-		sprintf(fname, "Table_wet%d-%dm.tex", n, m);
-		fout = fopen(fname, "at");
-		if (fout != NULL){
-			fprintf(fout, "% 3d & %8.1lf & %7.1lf \\\\\n",
-				ninst,
-				value,
-				(end - start) / CLOCKS_PER_SEC);
-			fclose(fout);
+		if (opts.files == "on")
+		{
+			printf("Saving statistics...\n");
+			char fname[50];
+			sprintf(fname, "Table_wet%d-%dm.tex", n, m);
+			fout = fopen(fname, "at");
+			if (fout != NULL){
+				fprintf(fout, "% 3d & %8.1lf & %7.1lf \\\\\n",
+					ninst,
+					value,
+					elapsed);
+				fclose(fout);
+			}
+			else
+				printf("Could not write to the Latex table file!\n");
 		}
-		else
-			printf("Could not write to the Latex table file!\n");
 
 	}
 
+	// a schedule without a proof of optimality (local search, time limit,
+	// stopped by a signal)
+	else if (status == UFFLP_Feasible)
+	{
+		std::cout << "Feasible solution found, optimality not proven" << std::endl;
+		std::cout << "Objective function value = " << value << std::endl;
+		std::cout << "Lower bound = " << result.bestBound << std::endl;
+		// a zero makespan has nothing left to close
+		double gap = value > 0 ? 100.0 * (value - result.bestBound) / value : 0.0;
+		printf("Gap = %.2f%%\n", gap);
+		if (opts.checkpoint != NULL)
+			printf("Resume from the checkpoint with --checkpoint=%s\n", opts.checkpoint);
+
+		PrintMachineSchedules(stdout, machines);
+	}
+
 	// check if the problem is infeasible
 	else if (status == UFFLP_Infeasible)
 	{
 		std::cout << "The problem is infeasible!" << std::endl;
 	}
 
-	// check the other case
+	// stopped without any schedule, or failed
 	else
 	{
-		std::cout << "It seems that the solver did not finish its job...";
-		std::cout << std::endl;
+		std::cout << "It seems that the solver did not finish its job... (" <<
+			StatusName(status) << ")" << std::endl;
 	}
 
-	// destroy the problem instance
-	UFFLP_DestroyProblem(prob);
-
-	delete proctime;
-	delete setup;
+	// machine-readable records of the run
+	if (opts.report != NULL)
+	{
+		fout = fopen(opts.report, "w");
+		if (fout != NULL)
+		{
+			fputs(FormatReportJSON(opts, n, &result).c_str(), fout);
+			fclose(fout);
+		}
+		else
+			printf("Could not write the report %s\n", opts.report);
+	}
+	if (opts.reportCsv != NULL)
+	{
+		// header only for a new file
+		fout = fopen(opts.reportCsv, "r");
+		bool exists = fout != NULL;
+		if (exists)
+			fclose(fout);
+		fout = fopen(opts.reportCsv, "a");
+		if (fout != NULL)
+		{
+			if (!exists)
+				fputs(ReportCSVHeader(), fout);
+			fputs(FormatReportCSV(opts, n, &result).c_str(), fout);
+			fclose(fout);
+		}
+		else
+			printf("Could not write the report %s\n", opts.reportCsv);
+	}
 
 	return 0;
 }